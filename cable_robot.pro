@@ -3,6 +3,8 @@ HEADERS = \
     $$PWD/inc/robot/components/actuator.h \
     $$PWD/inc/robot/components/winch.h \
     $$PWD/inc/robot/components/pulleys_system.h \
+    $$PWD/inc/robot/workspace_grid.h \
+    $$PWD/inc/robot/trajectory_checker.h \
     $$PWD/inc/gui/main_gui.h \
     $$PWD/inc/gui/login_window.h \
     $$PWD/inc/gui/calib/calibration_dialog.h \
@@ -20,16 +22,35 @@ HEADERS = \
     $$PWD/inc/homing/homing_proprioceptive.h \
     $$PWD/inc/homing/matlab_thread.h \
     $$PWD/inc/apps/joints_pvt_app.h \
+    $$PWD/inc/apps/trajectory_cache.h \
+    $$PWD/inc/apps/trajectory_loader.h \
     $$PWD/inc/apps/manual_control_app.h \
     $$PWD/inc/ctrl/controller_base.h \
     $$PWD/inc/ctrl/controller_singledrive.h \
+    $$PWD/inc/ctrl/controller_multidrive.h \
+    $$PWD/inc/ctrl/poly5_profile.h \
+    $$PWD/inc/ctrl/jog_profile.h \
     $$PWD/inc/ctrl/controller_joints_pvt.h \
+    $$PWD/inc/ctrl/trajectory_feedforward.h \
+    $$PWD/inc/ctrl/excitation_generator.h \
+    $$PWD/inc/ctrl/controller_excitation.h \
     $$PWD/inc/ctrl/winch_torque_controller.h \
+    $$PWD/inc/ctrl/control_pipeline.h \
+    $$PWD/inc/ctrl/control_stages.h \
+    $$PWD/inc/ctrl/controller_budget.h \
 #    $$PWD/inc/state_estimation/ext_kalman_filter.h \
     $$PWD/inc/utils/types.h \
     $$PWD/inc/utils/macros.h \
+    $$PWD/inc/utils/background_workers.h \
+    $$PWD/inc/utils/binary_log.h \
+    $$PWD/inc/utils/linear_system.h \
     $$PWD/inc/utils/msgs.h \
+    $$PWD/inc/utils/spsc_ring_buffer.h \
     $$PWD/inc/utils/easylog_wrapper.h \
+    $$PWD/inc/utils/flight_recorder.h \
+    $$PWD/inc/utils/tracer.h \
+    $$PWD/inc/utils/trajectory_compression.h \
+    $$PWD/inc/utils/trajectory_validation.h \
     $$PWD/inc/debug/debug_routine.h \
     $$PWD/libs/easyloggingpp/src/easylogging++.h \
     $$PWD/libs/grab_common/grabcommon.h \
@@ -41,6 +62,8 @@ SOURCES = \
     $$PWD/src/robot/components/actuator.cpp \
     $$PWD/src/robot/components/winch.cpp \
     $$PWD/src/robot/components/pulleys_system.cpp \
+    $$PWD/src/robot/workspace_grid.cpp \
+    $$PWD/src/robot/trajectory_checker.cpp \
     $$PWD/src/gui/main_gui.cpp \
     $$PWD/src/gui/login_window.cpp \
     $$PWD/src/gui/calib/calibration_dialog.cpp \
@@ -58,14 +81,31 @@ SOURCES = \
     $$PWD/src/homing/homing_proprioceptive.cpp \
     $$PWD/src/homing/matlab_thread.cpp \
     $$PWD/src/apps/joints_pvt_app.cpp \
+    $$PWD/src/apps/trajectory_cache.cpp \
+    $$PWD/src/apps/trajectory_loader.cpp \
     $$PWD/src/apps/manual_control_app.cpp \
     $$PWD/src/ctrl/controller_base.cpp \
     $$PWD/src/ctrl/controller_singledrive.cpp \
+    $$PWD/src/ctrl/controller_multidrive.cpp \
+    $$PWD/src/ctrl/poly5_profile.cpp \
+    $$PWD/src/ctrl/jog_profile.cpp \
     $$PWD/src/ctrl/controller_joints_pvt.cpp \
+    $$PWD/src/ctrl/trajectory_feedforward.cpp \
+    $$PWD/src/ctrl/excitation_generator.cpp \
+    $$PWD/src/ctrl/controller_excitation.cpp \
     $$PWD/src/ctrl/winch_torque_controller.cpp \
+    $$PWD/src/ctrl/control_stages.cpp \
+    $$PWD/src/ctrl/controller_budget.cpp \
 #    $$PWD/src/state_estimation/ext_kalman_filter.cpp \
+    $$PWD/src/utils/background_workers.cpp \
+    $$PWD/src/utils/binary_log.cpp \
+    $$PWD/src/utils/linear_system.cpp \
     $$PWD/src/utils/msgs.cpp \
     $$PWD/src/utils/easylog_wrapper.cpp \
+    $$PWD/src/utils/flight_recorder.cpp \
+    $$PWD/src/utils/tracer.cpp \
+    $$PWD/src/utils/trajectory_compression.cpp \
+    $$PWD/src/utils/trajectory_validation.cpp \
     $$PWD/src/debug/debug_routine.cpp \
     $$PWD/libs/easyloggingpp/src/easylogging++.cc \
     $$PWD/libs/grab_common/grabcommon.cpp \
@@ -110,6 +150,8 @@ DEFINES += ELPP_QT_LOGGING    \
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
 DEFINES += USE_QT=1
 DEFINES += DEBUG_GUI=0
+# Set to 1 to record Chrome trace spans, exported to /tmp/cable-robot-logs/trace.json
+DEFINES += ENABLE_TRACING=0
 
 # GRAB Ethercat lib
 unix:!macx: LIBS += -L$$PWD/libs/grab_common/libgrabec/lib/ -lgrabec
@@ -14,17 +14,25 @@
 #include "StateMachine.h"
 #include "easylogging++.h"
 
+#include "apps/trajectory_cache.h"
 #include "ctrl/controller_joints_pvt.h"
 #include "robot/cablerobot.h"
+#include "robot/trajectory_checker.h"
+#include "utils/tracer.h"
+#include "utils/trajectory_validation.h"
+
+class TrajectoryLoader;
 
 // clang-format off
 ENUM_CLASS(TrajectoryType,
-           CABLE_LENGTH   = 0,
-           CABLE_SPEED    = 5,
-           MOTOR_POSITION = 1,
-           MOTOR_SPEED    = 2,
-           MOTOR_TORQUE   = 3,
-           NONE           = 4)
+           CABLE_LENGTH       = 0,
+           CABLE_SPEED        = 5,
+           MOTOR_POSITION     = 1,
+           MOTOR_SPEED        = 2,
+           MOTOR_TORQUE       = 3,
+           NONE               = 4,
+           CABLE_LENGTH_PVT   = 6,
+           MOTOR_POSITION_PVT = 7)
 // clang-format on
 
 /**
@@ -43,6 +51,18 @@ struct TrajectorySet
   vect<TrajectoryS> traj_motors_torque; /**< Motor torques trajectories, one per motor. */
 };
 
+/**
+ * @brief A convenient structure to include the feasibility limits of each joint
+ * trajectory type of a single actuator.
+ */
+struct JointLimits
+{
+  TrajectoryLimits cable_len;    /**< Limits of cable length trajectories [m]. */
+  TrajectoryLimits motor_pos;    /**< Limits of motor position trajectories [counts]. */
+  TrajectoryLimits motor_vel;    /**< Limits of motor speed trajectories [counts/s]. */
+  TrajectoryLimits motor_torque; /**< Limits of motor torque trajectories [points]. */
+};
+
 
 /**
  * @brief The EventData derived class for JointsPVTApp state machine.
@@ -104,6 +124,57 @@ class JointsPVTApp: public QObject, public StateMachine
    */
   const TrajectorySet& getTrajectorySet(const int traj_idx) const;
 
+  /**
+   * @brief Set the tolerances used to compress dense trajectories when they are read.
+   *
+   * Cable lengths and motor positions trajectories are compressed into a subset of their
+   * waypoints, with velocities, which interpolate all original samples within given
+   * tolerance by cubic Hermite splines. A null tolerance disables compression, which is
+   * the default, since it is lossy.
+   * Files being read already keep the tolerances they were started with.
+   * @param[in] cable_len_tol [m] Tolerance on cable lengths.
+   * @param[in] motor_pos_tol [counts] Tolerance on motor positions.
+   */
+  void setCompressionTolerances(const double cable_len_tol, const double motor_pos_tol);
+  /**
+   * @brief Remove all cached trajectories, so that next files read are parsed again.
+   */
+  void clearTrajectoryCache() const;
+
+  /**
+   * @brief Start reading new trajectories from multiple files concurrently, appending
+   * them to the list as a whole once all are read, in given order.
+   *
+   * Files are read on a pool of worker threads, as in readTrajectories(). Progress is
+   * notified by trajectoriesReadProgress() and completion by trajectoriesReadComplete().
+   * If any file is not valid, or reading is canceled, no trajectory is appended.
+   * Trajectories are valid only if they are feasible within the limits of the control
+   * pipeline, which are taken once when reading starts.
+   * @param ifilepaths The locations of the text files containing the trajectories.
+   * @return _False_ if a previous reading is still running, _True_ otherwise.
+   */
+  bool startReadingTrajectories(const QVector<QString>& ifilepaths);
+  /**
+   * @brief Cancel ongoing reading of trajectories, if any.
+   */
+  void cancelReadingTrajectories();
+  /**
+   * @brief Check if trajectories are being read.
+   * @return _True_ if trajectories are being read, _False_ otherwise.
+   */
+  bool isReadingTrajectories() const;
+  /**
+   * @brief Start checking all stored trajectories for cable tensions and interferences.
+   *
+   * Each trajectory set is checked in background on its platform trajectory, if any, or
+   * on its cable lengths trajectories otherwise, while other sets are not checked.
+   * Completion is notified by trajectoriesCheckComplete(). A previous check still
+   * running is aborted, since it refers to outdated trajectories.
+   * @return _False_ if there are no trajectories, _True_ otherwise.
+   * @see TrajectoryChecker
+   */
+  bool startCheckingTrajectories();
+
  public:
   //--------- External events -------------------------------------------------------//
 
@@ -117,6 +188,15 @@ class JointsPVTApp: public QObject, public StateMachine
   /**
    * @brief Read new trajectories from a file and append it to the list.
    *
+   * Parsed trajectories are cached on disk, addressed by file content, robot
+   * configuration and conversion parameters, so that reading the same file again skips
+   * parsing altogether. Relative trajectories are cached as such and offset by current
+   * robot state at every reading.
+   *
+   * Files of type CABLE_LENGTH_PVT or MOTOR_POSITION_PVT hold sparse waypoints, where
+   * each line is formatted as _t p1 v1 p2 v2 ..._, i.e. every position is followed by
+   * its velocity per second. These are interpolated by cubic Hermite splines.
+   *
    * This triggers following state transition:
    * any --> ST_READY
    * @param ifilepath The location of the text file containing the trajectory.
@@ -167,6 +247,21 @@ class JointsPVTApp: public QObject, public StateMachine
    * @brief Signal carrying trajectory/transition progress status.
    */
   void trajectoryProgress(const int, const double) const;
+  /**
+   * @brief Signal carrying the number of trajectory files read so far, out of the total.
+   */
+  void trajectoriesReadProgress(const int, const int) const;
+  /**
+   * @brief Signal notifying that reading of trajectory files is over, successfully or
+   * not, together with the path of the first file which is not valid, if any, and the
+   * reason why it is not.
+   */
+  void trajectoriesReadComplete(const bool, const QString&, const QString&) const;
+  /**
+   * @brief Signal notifying that checking of trajectories is over, telling whether all
+   * of them are safe, together with the summary of those which are not.
+   */
+  void trajectoriesCheckComplete(const bool, const QString&) const;
   /**
    * @brief Stop waiting command.
    */
@@ -176,25 +271,52 @@ class JointsPVTApp: public QObject, public StateMachine
   // For signals emitted by controller
   void handleTrajectoryCompleted();
   void progressUpdate(const int progress_value, const double timestamp);
+  // For signals emitted by trajectory loader
+  void handleTrajectoriesLoaded(const bool success);
+  // For signals emitted by trajectory check analyzer
+  void handleTrajectoriesChecked();
 
   void logInfo(const QString& text) const;
 
  private:
   CableRobot* robot_ptr_;
   ControllerJointsPVT controller_;
+  double cable_len_tol_ = 0.0; // [m]
+  double motor_pos_tol_ = 0.0; // [counts]
+  TrajectoryCache cache_;
+  TrajectoryLoader* loader_;
+  TrajectoryChecker checker_;
+  TrajectoryCheckAnalyzer* check_analyzer_ = nullptr;
 
   QVector<TrajectorySet> traj_sets_;
 
-  void setCablesLenTraj(const bool relative, const vect<id_t>& motors_id, QTextStream& s,
-                        TrajectorySet& traj_set);
-  void setCablesVelTraj(const vect<id_t>& motors_id, QTextStream& s,
-                        TrajectorySet& traj_set);
-  void setMotorsPosTraj(const bool relative, const vect<id_t>& motors_id, QTextStream& s,
-                       TrajectorySet& traj_set);
+  bool loadTrajectorySet(const QString& ifilepath, const QByteArray& context,
+                         const vect<JointLimits>& limits, const vectD& ratios,
+                         const double cable_len_tol, const double motor_pos_tol,
+                         TrajectorySet& traj_set, bool& relative, QString& error) const;
+  bool parseTrajectories(const QByteArray& content, const vectD& ratios,
+                         TrajectorySet& traj_set, bool& relative, QString& error) const;
+  void setCablesLenTraj(const vect<id_t>& motors_id, QTextStream& s,
+                        TrajectorySet& traj_set,
+                        const bool with_velocities = false) const;
+  void setCablesVelTraj(const vect<id_t>& motors_id, const vectD& ratios,
+                        QTextStream& s, TrajectorySet& traj_set) const;
+  void setMotorsPosTraj(const vect<id_t>& motors_id, QTextStream& s,
+                        TrajectorySet& traj_set,
+                        const bool with_velocities = false) const;
   void setMotorsVelTraj(const vect<id_t>& motors_id, QTextStream& s,
-                       TrajectorySet& traj_set);
-  void setMotorsTorqueTraj(const bool relative, const vect<id_t>& motors_id,
-                          QTextStream& s, TrajectorySet& traj_set);
+                        TrajectorySet& traj_set) const;
+  void setMotorsTorqueTraj(const vect<id_t>& motors_id, QTextStream& s,
+                           TrajectorySet& traj_set) const;
+  bool compressTrajectories(TrajectorySet& traj_set, const double cable_len_tol,
+                            const double motor_pos_tol) const;
+  void applyRelativeOffsets(TrajectorySet& traj_set) const;
+  QByteArray cacheContext(const vect<JointLimits>& limits, const vectD& ratios) const;
+  vectD transmissionRatios() const;
+  vect<JointLimits> jointsLimits() const;
+  bool validateTrajectorySet(const TrajectorySet& traj_set,
+                             const vect<JointLimits>& limits, const bool with_bounds,
+                             const bool with_derivatives, QString& error) const;
 
  public:
   //--------- State machine ---------------------------------------------------------//
@@ -221,6 +343,7 @@ class JointsPVTApp: public QObject, public StateMachine
   // clang-format on
 
   States prev_state_;
+  TraceTrack trace_track_{"JointsPVTApp"};
 
   STATE_DECLARE(JointsPVTApp, Idle, NoEventData)
   STATE_DECLARE(JointsPVTApp, Ready, NoEventData)
@@ -53,13 +53,25 @@ class ManualControlApp: public QObject
    * @return The actual platform 3D global position in meters.
    */
   const grabnum::Vector3d& getActualPos() const;
+  /**
+   * @brief Get platform 3D global position target.
+   * @return The platform 3D global position target in meters.
+   */
+  const grabnum::Vector3d& getTargetPos() const { return target_pos_; }
 
   /**
    * @brief Set platform new global position target.
+   *
+   * The new target is checked against the precomputed wrench-feasible workspace of the
+   * robot. If unfeasible, it is clamped to the farthest feasible position along the way
+   * from current target. If workspace is not available, e.g. because its analysis is
+   * still running or failed, the new target alone is checked and rejected if unfeasible.
    * @param coord The coordinate to be updated.
    * @param value The new value of the specified coordinate to be updated.
+   * @return _True_ if target was accepted as is, _false_ if it was clamped or rejected.
+   * @see getTargetPos()
    */
-  void setTarget(const Coordinates coord, const double value);
+  bool setTarget(const Coordinates coord, const double value);
   /**
    * @brief Set target global position of the platform to its current value.
    */
@@ -75,6 +87,8 @@ class ManualControlApp: public QObject
   CableRobot* robot_ptr_ = nullptr;
   grabnum::Vector3d target_pos_;
   grabnum::Vector3d actual_pos_;
+
+  bool isPoseFeasible(const grabnum::Vector3d& position) const;
 };
 
 #endif // CABLE_ROBOT_MANUAL_CONTROL_APP_H
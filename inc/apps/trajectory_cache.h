@@ -0,0 +1,76 @@
+/**
+ * @file trajectory_cache.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a content-addressed on-disk cache of parsed joints trajectories.
+ */
+
+#ifndef CABLE_ROBOT_TRAJECTORY_CACHE_H
+#define CABLE_ROBOT_TRAJECTORY_CACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+struct TrajectorySet;
+
+/**
+ * @brief A content-addressed on-disk cache of parsed joints trajectories.
+ *
+ * Each entry holds a trajectory set as it is after parsing, unit conversion and
+ * compression, but before relative trajectories are offset by current robot state,
+ * since that changes at every reading. Entries are addressed by the SHA-1 hash of the
+ * trajectory file content together with a context, which collects everything else the
+ * parsed set depends on, e.g. the robot configuration and conversion parameters. Hence
+ * an entry never goes stale: a change in either file or context simply addresses a
+ * different entry.
+ */
+class TrajectoryCache
+{
+ public:
+  /**
+   * @brief Constructor.
+   * @param[in] dirpath The directory holding cache entries. If empty, a default one in
+   * user home is used.
+   */
+  explicit TrajectoryCache(const QString& dirpath = QString());
+
+  /**
+   * @brief Compute the key of a trajectory file.
+   * @param[in] content The trajectory file content.
+   * @param[in] context Anything else the parsed trajectories depend on.
+   * @return The cache key.
+   */
+  static QString makeKey(const QByteArray& content, const QByteArray& context);
+
+  /**
+   * @brief Load a trajectory set from cache.
+   * @param[in] key The cache key.
+   * @param[out] traj_set The cached trajectory set.
+   * @param[out] relative _True_ if cached trajectories are relative ones.
+   * @return _True_ if a valid entry was found, _False_ otherwise.
+   */
+  bool load(const QString& key, TrajectorySet& traj_set, bool& relative) const;
+  /**
+   * @brief Store a trajectory set in cache.
+   * @param[in] key The cache key.
+   * @param[in] traj_set The trajectory set to be stored.
+   * @param[in] relative _True_ if trajectories are relative ones.
+   * @return _True_ if the entry was written, _False_ otherwise.
+   */
+  bool store(const QString& key, const TrajectorySet& traj_set,
+             const bool relative) const;
+  /**
+   * @brief Remove all cache entries.
+   */
+  void clear() const;
+
+ private:
+  static constexpr quint32 kMagicNumber_ = 0x4a505654; // "JPVT"
+  static constexpr quint32 kVersion_     = 1;
+
+  QString dirpath_;
+
+  QString entryFilepath(const QString& key) const;
+};
+
+#endif // CABLE_ROBOT_TRAJECTORY_CACHE_H
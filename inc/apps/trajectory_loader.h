@@ -0,0 +1,137 @@
+/**
+ * @file trajectory_loader.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a thread pool based loader of multiple trajectory files.
+ */
+
+#ifndef CABLE_ROBOT_TRAJECTORY_LOADER_H
+#define CABLE_ROBOT_TRAJECTORY_LOADER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+#include "apps/joints_pvt_app.h"
+
+/**
+ * @brief A loader of multiple trajectory files, which are read concurrently on a pool of
+ * worker threads.
+ *
+ * Each file is loaded on its own task by a given loading function, which must then be
+ * safe to be called concurrently. Loaded sets are kept in the same order as given files,
+ * regardless of the order tasks complete, and are handed over all together only once
+ * every file was loaded successfully, so that a partial list is never exposed. As soon as
+ * a file fails to load, or loading is canceled, pending tasks are skipped.
+ *
+ * Progress and completion are notified by signals emitted on the thread owning the
+ * loader, typically the GUI one.
+ */
+class TrajectoryLoader: public QObject
+{
+  Q_OBJECT
+
+ public:
+  /**
+   * @brief Loading function, yielding a trajectory set and whether it is relative, given
+   * the path of a file. It returns _False_ if file could not be loaded, together with
+   * the reason why.
+   */
+  using LoadFunction =
+    std::function<bool(const QString&, TrajectorySet&, bool&, QString&)>;
+
+  /**
+   * @brief Constructor.
+   * @param parent The parent QObject.
+   */
+  explicit TrajectoryLoader(QObject* parent = nullptr);
+  ~TrajectoryLoader() override;
+
+  /**
+   * @brief Start loading given files concurrently.
+   * @param[in] filepaths The paths of files to be loaded, in queue order.
+   * @param[in] load_fun The loading function.
+   * @return _False_ if a previous loading is still running, _True_ otherwise.
+   */
+  bool start(const QVector<QString>& filepaths, const LoadFunction& load_fun);
+  /**
+   * @brief Cancel ongoing loading. Files already being loaded are completed anyway.
+   */
+  void cancel();
+  /**
+   * @brief Block until all tasks are done.
+   */
+  void wait();
+  /**
+   * @brief Check if a loading is running.
+   * @return _True_ if a loading is running, _False_ otherwise.
+   */
+  bool isRunning() const { return running_; }
+
+  /**
+   * @brief Get the path of the first file in queue order which failed to load.
+   * @return The path of the failed file, or an empty string if none failed.
+   */
+  QString failedFilepath() const;
+  /**
+   * @brief Get the reason why the first file in queue order failed to load.
+   * @return The reason of the failure, or an empty string if none failed or no reason
+   * was given.
+   */
+  QString failedError() const;
+  /**
+   * @brief Get the path of a file of current or last loading.
+   * @param[in] index The index of the file in queue order.
+   * @return The path of the file.
+   */
+  QString filepath(const int index) const { return filepaths_.at(index); }
+  /**
+   * @brief Move loaded trajectory sets out of the loader.
+   * @param[out] traj_sets Loaded trajectory sets, in queue order.
+   * @param[out] relative For each set, _True_ if it is relative.
+   */
+  void takeResults(QVector<TrajectorySet>& traj_sets, QVector<bool>& relative);
+
+ signals:
+  /**
+   * @brief Signal carrying the number of files done so far, out of the total.
+   */
+  void progress(const int, const int) const;
+  /**
+   * @brief Signal notifying that loading is over, successfully or not.
+   */
+  void completed(const bool) const;
+
+ private slots:
+  void handleFileDone(const int index, const int status);
+
+ private:
+  friend class TrajectoryLoadTask;
+
+  enum TaskStatus
+  {
+    LOADED,
+    FAILED,
+    SKIPPED
+  };
+
+  QThreadPool pool_;
+  LoadFunction load_fun_;
+  QVector<QString> filepaths_;
+  QVector<TrajectorySet> traj_sets_;
+  QVector<bool> relative_;
+  QVector<QString> errors_;
+
+  std::atomic<bool> abort_{false};
+  bool running_  = false;
+  bool canceled_ = false;
+  int files_done_;
+  int failed_idx_;
+
+  void loadFile(const int index);
+};
+
+#endif // CABLE_ROBOT_TRAJECTORY_LOADER_H
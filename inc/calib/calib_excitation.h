@@ -10,12 +10,13 @@
 #define CABLE_ROBOT_CALIB_EXCITATION_H
 
 #include <QObject>
-#include <QTextStream>
 
 #include "StateMachine.h"
 
-#include "ctrl/controller_joints_pvt.h"
+#include "ctrl/controller_excitation.h"
+#include "ctrl/controller_multidrive.h"
 #include "robot/cablerobot.h"
+#include "utils/tracer.h"
 
 /**
  * @brief The EventData derived class for CalibExcitation state machine.
@@ -60,8 +61,14 @@ std::ostream& operator<<(std::ostream& stream, const CalibExcitationData& data);
  * 2. Manually move the platform in a desired position in freedrive mode (i.e. torque
  * control mode).
  * 3. Switch to position control to fix the cable length.
- * 4. Start logging actuators status while performing a predefined trajectory which should
- * excite most platform dynamics.
+ * 4. Start logging actuators status while performing an excitation of cable lengths
+ * which should excite most platform dynamics.
+ *
+ * Excitation signals are generated on the fly by ControllerExcitation, one per active
+ * cable. By default, each cable in turn is pulled by a 2 seconds pulse of 5cm, while the
+ * others hold still. Richer designs, like uncorrelated multisines on all cables at once,
+ * must be loaded explicitly by loadExcitationParams(), and may slacken or overload
+ * cables of an over-constrained robot.
  */
 class CalibExcitation: public QObject, public StateMachine
 {
@@ -72,11 +79,8 @@ class CalibExcitation: public QObject, public StateMachine
    * @brief Full constructor.
    * @param parent The parent QObject, in this case the corresponding interface.
    * @param robot A pointer to the cable robot object.
-   * @param[in] params A vector of actuator parameters, with as many elements as the
-   * active motors.
    */
-  explicit CalibExcitation(QObject* parent, CableRobot* robot,
-                           const vect<grabcdpr::ActuatorParams>& params);
+  explicit CalibExcitation(QObject* parent, CableRobot* robot);
   ~CalibExcitation() override;
 
   /**
@@ -107,6 +111,36 @@ class CalibExcitation: public QObject, public StateMachine
    * @param data Torque target for all motors.
    */
   void changeControlMode(CalibExcitationData* data);
+  /**
+   * @brief Set the excitation signals of following logging sessions.
+   * @param[in] params Excitation parameters, one per active motor, in the same order,
+   * with amplitude and offset in meters.
+   * @return _True_ if parameters are valid, _false_ otherwise.
+   */
+  bool setExcitationParams(const vect<ExcitationParams>& params);
+  /**
+   * @brief Load the excitation signals of following logging sessions from a JSON file.
+   *
+   * The file holds an _excitations_ array, with one element per active motor, in the
+   * same order, including any field of ExcitationParams. Signal _type_ is one of
+   * "pulse", "multisine", "chirp" and "prbs". Missing fields keep their default value.
+   * @param[in] filepath Path of the JSON file.
+   * @return _True_ if file was loaded successfully, _false_ otherwise.
+   * @see setExcitationParams()
+   */
+  bool loadExcitationParams(const QString& filepath);
+  /**
+   * @brief Identify the friction of all winches from a logged session and save it as
+   * default friction parameters.
+   *
+   * The session must have been recorded with winches running at several constant speeds
+   * and no external load, as required by identifyWinchFriction(). Winches which can't be
+   * identified keep their current default parameters.
+   * @param log_filepath Path of the binary data log of the session.
+   * @return _True_ if at least one winch was identified and saved, _false_ otherwise.
+   * @see WinchesTorqueControl::identifyFrictionParams()
+   */
+  bool identifyWinchesFriction(const QString& log_filepath);
   /**
    * @brief Start logging while following an excitation trajectory.
    * @note The operation starts as soon as the platform is considered to be steady.
@@ -138,8 +172,8 @@ class CalibExcitation: public QObject, public StateMachine
   static constexpr qint16 kTorqueSsErrTol_ = 5;
 
   CableRobot* robot_ptr_ = nullptr;
-  ControllerSingleDrive controller_single_drive_;
-  ControllerJointsPVT* controller_joints_ptv_ = nullptr;
+  ControllerMultiDrive controller_multi_drive_;
+  ControllerExcitation controller_excitation_;
 
   bool disable_cmd_recv_ = false;
   QMutex qmutex_;
@@ -147,10 +181,7 @@ class CalibExcitation: public QObject, public StateMachine
   vect<id_t> active_actuators_id_;
 
   static constexpr uint kRtCycleMultiplier_ = 10; // logging T = cycle_time * multiplier
-  static const QString kExcitationTrajFilepath_;
-  vect<TrajectoryD> traj_cables_len_;
-  bool readTrajectories(const QString& ifilepath);
-  void setCablesLenTraj(const bool relative, const vect<id_t>& motors_id, QTextStream& s);
+  vect<ExcitationParams> excitation_params_;
 
  private:
   //--------- State machine ---------------------------------------------------------//
@@ -165,6 +196,7 @@ class CalibExcitation: public QObject, public StateMachine
   // clang-format on
 
   States prev_state_;
+  TraceTrack trace_track_{"CalibExcitation"};
 
   STATE_DECLARE(CalibExcitation, Idle, NoEventData)
   GUARD_DECLARE(CalibExcitation, GuardEnabled, NoEventData)
@@ -0,0 +1,183 @@
+/**
+ * @file control_pipeline.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a pipeline of control stages, composed at compile time and
+ * applied to control actions at every cycle of the real time thread.
+ */
+
+#ifndef CABLE_ROBOT_CONTROL_PIPELINE_H
+#define CABLE_ROBOT_CONTROL_PIPELINE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+
+#include "ctrl/controller_base.h"
+#include "utils/tracer.h"
+
+/**
+ * @brief Execution time statistics of a single pipeline stage.
+ */
+struct StageTiming
+{
+  const char* name    = nullptr; /**< Stage name. */
+  uint64_t calls      = 0;       /**< Number of stage executions. */
+  uint64_t total_nsec = 0;       /**< [nsec] Total execution time. */
+  uint64_t max_nsec   = 0;       /**< [nsec] Worst execution time. */
+
+  /**
+   * @brief Get mean execution time.
+   * @return [nsec] Mean execution time, 0 if stage was never executed.
+   */
+  double MeanNsec() const
+  {
+    return calls == 0 ? 0.0 : static_cast<double>(total_nsec) / calls;
+  }
+};
+
+/**
+ * @brief A pipeline of control stages, post-processing the control actions computed by
+ * any controller before they are applied to the motors.
+ *
+ * Stages are composed at compile time, so that each one is called directly, without any
+ * virtual dispatch, and can be inlined. A stage is any class exposing:
+ * - `static const char* Name()`, used for reporting;
+ * - `void Apply(ControlAction* actions, const ActuatorStatus* status, size_t num)`,
+ * processing all _num_ actions in a single loop, where _status_ holds the current status
+ * of the motor targeted by each action.
+ *
+ * Stages are applied in the order they are listed, each one over all motors before the
+ * next one starts. The execution time of each stage is accumulated at every cycle and can
+ * be inquired from any thread with GetTiming().
+ * @tparam Stages Stage classes, at least one.
+ */
+template <class... Stages>
+class ControlPipeline
+{
+  static_assert(sizeof...(Stages) > 0, "A control pipeline needs at least one stage");
+
+ public:
+  /**
+   * @brief Number of stages.
+   */
+  static constexpr size_t kStagesNum = sizeof...(Stages);
+
+  /**
+   * @brief Constructor.
+   * @param[in] stages Stage instances, in the same order as the template arguments.
+   */
+  explicit ControlPipeline(const Stages&... stages) : stages_(stages...)
+  {
+    InitNames<0>();
+  }
+
+  /**
+   * @brief Get a stage, for instance to configure it.
+   * @tparam I Stage index.
+   * @return A reference to the I-th stage.
+   * @note Stages are used by the real time thread, so they should be configured under
+   * robot mutex.
+   */
+  template <size_t I>
+  typename std::tuple_element<I, std::tuple<Stages...>>::type& GetStage()
+  {
+    return std::get<I>(stages_);
+  }
+
+  /**
+   * @brief Apply all stages to given control actions.
+   * @param[in,out] actions Control actions to be processed in place.
+   * @param[in] status Current status of the motor targeted by each action.
+   * @param[in] num Number of actions.
+   * @note This function lives in the real time thread.
+   */
+  void Apply(ControlAction* actions, const ActuatorStatus* status, const size_t num)
+  {
+    ApplyFrom<0>(actions, status, num);
+  }
+
+  /**
+   * @brief Get execution time statistics of a stage.
+   * @param[in] idx Stage index.
+   * @return Execution time statistics of the stage.
+   */
+  StageTiming GetTiming(const size_t idx) const
+  {
+    StageTiming timing;
+    if (idx >= kStagesNum)
+      return timing;
+    timing.name       = timings_[idx].name;
+    timing.calls      = timings_[idx].calls.load(std::memory_order_relaxed);
+    timing.total_nsec = timings_[idx].total_nsec.load(std::memory_order_relaxed);
+    timing.max_nsec   = timings_[idx].max_nsec.load(std::memory_order_relaxed);
+    return timing;
+  }
+
+  /**
+   * @brief Reset execution time statistics of all stages.
+   */
+  void ResetTimings()
+  {
+    for (size_t i = 0; i < kStagesNum; i++)
+    {
+      timings_[i].calls      = 0;
+      timings_[i].total_nsec = 0;
+      timings_[i].max_nsec   = 0;
+    }
+  }
+
+ private:
+  // Counters are written by real time thread only and read by any other thread.
+  struct AtomicTiming
+  {
+    const char* name = nullptr;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_nsec{0};
+    std::atomic<uint64_t> max_nsec{0};
+  };
+
+  std::tuple<Stages...> stages_;
+  AtomicTiming timings_[kStagesNum];
+
+  template <size_t I>
+  typename std::enable_if<(I < kStagesNum)>::type InitNames()
+  {
+    timings_[I].name = std::tuple_element<I, std::tuple<Stages...>>::type::Name();
+    InitNames<I + 1>();
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I >= kStagesNum)>::type InitNames()
+  {}
+
+  template <size_t I>
+  typename std::enable_if<(I < kStagesNum)>::type
+  ApplyFrom(ControlAction* actions, const ActuatorStatus* status, const size_t num)
+  {
+    AtomicTiming& timing = timings_[I];
+    const uint64_t start = Tracer::NowNsec();
+    std::get<I>(stages_).Apply(actions, status, num);
+    const uint64_t elapsed = Tracer::NowNsec() - start;
+
+    timing.calls.store(timing.calls.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    timing.total_nsec.store(timing.total_nsec.load(std::memory_order_relaxed) + elapsed,
+                            std::memory_order_relaxed);
+    if (elapsed > timing.max_nsec.load(std::memory_order_relaxed))
+      timing.max_nsec.store(elapsed, std::memory_order_relaxed);
+
+    ApplyFrom<I + 1>(actions, status, num);
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I >= kStagesNum)>::type
+  ApplyFrom(ControlAction*, const ActuatorStatus*, const size_t)
+  {}
+};
+
+template <class... Stages>
+constexpr size_t ControlPipeline<Stages...>::kStagesNum;
+
+#endif // CABLE_ROBOT_CONTROL_PIPELINE_H
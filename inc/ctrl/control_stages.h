@@ -0,0 +1,273 @@
+/**
+ * @file control_stages.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing the stages of the control pipeline, shared by all controllers.
+ */
+
+#ifndef CABLE_ROBOT_CONTROL_STAGES_H
+#define CABLE_ROBOT_CONTROL_STAGES_H
+
+#include <array>
+#include <string>
+
+#include "ctrl/control_pipeline.h"
+
+/**
+ * @brief A map from motor IDs to their slots, i.e. to their positions in the list of
+ * motor IDs given at construction.
+ *
+ * It lets stages keep their per-motor state in vectors sized after the configured motors,
+ * which are allocated once at construction, and look them up in constant time.
+ */
+class MotorSlots
+{
+ public:
+  /**
+   * @brief Constructor.
+   * @param[in] motors_id IDs of all the motors, in slot order.
+   */
+  explicit MotorSlots(const vect<id_t>& motors_id);
+
+  /**
+   * @brief Get the number of slots.
+   * @return The number of motors given at construction.
+   */
+  size_t Size() const { return size_; }
+
+  /**
+   * @brief Get the slot of a motor.
+   * @param[in] motor_id Motor ID.
+   * @return The slot of the motor, or Size() if it was not given at construction.
+   */
+  size_t Slot(const id_t motor_id) const
+  {
+    return motor_id < slots_.size() ? slots_[motor_id] : size_;
+  }
+
+ private:
+  size_t size_;
+  vect<size_t> slots_;
+};
+
+/**
+ * @brief A control stage saturating every set point within the limits of its motor.
+ *
+ * Limits are given per motor ID and per control mode, and they are stored per motor
+ * slot, i.e. in the order of the motor IDs given at construction, so that any number of
+ * motors with any ID is supported. By default, motor speed and torque are limited to the
+ * absolute maximum values shared with the controllers, kAbsMaxMotorSpeed and
+ * kAbsMaxMotorTorque, while cable length and motor position are unlimited.
+ * Motor acceleration limits are not enforced on set points, which carry no acceleration,
+ * but they are stored here with the others, to validate trajectories before they are
+ * run. They are unlimited by default, as they depend on the motor and drive profile
+ * settings, hence they must be given in the limits file.
+ */
+class LimitClampStage
+{
+ public:
+  /**
+   * @brief Default location of joint limits file.
+   */
+  static const std::string kDefaultLimitsFilepath;
+
+  /**
+   * @brief Constructor, setting default limits on all given motors.
+   * @param[in] motors_id IDs of all the motors which can be controlled.
+   */
+  explicit LimitClampStage(const vect<id_t>& motors_id);
+
+  /**
+   * @brief Get stage name.
+   * @return Stage name.
+   */
+  static const char* Name() { return "LimitClamp"; }
+
+  /**
+   * @brief Load limits of all motors from a JSON file.
+   *
+   * The file holds a _motors_ array, whose elements include motor _id_ and any of
+   * _cable_length_ and _motor_position_, as [min, max] pairs, _motor_speed_,
+   * _motor_acceleration_ and _motor_torque_, as absolute maximum values. Missing limits and motors keep their
+   * values.
+   * @param[in] filepath Path of the JSON file.
+   * @return _True_ if file was loaded successfully, _false_ otherwise.
+   */
+  bool LoadLimits(const std::string& filepath);
+
+  /**
+   * @brief Set cable length limits of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] min [m] Minimum cable length.
+   * @param[in] max [m] Maximum cable length.
+   */
+  void SetCableLenLimits(const id_t motor_id, const double min, const double max);
+  /**
+   * @brief Set motor position limits of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] min [counts] Minimum motor position.
+   * @param[in] max [counts] Maximum motor position.
+   */
+  void SetMotorPosLimits(const id_t motor_id, const int32_t min, const int32_t max);
+  /**
+   * @brief Set absolute maximum speed of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] abs_max [counts/s] Absolute maximum motor speed.
+   */
+  void SetMotorSpeedLimit(const id_t motor_id, const int32_t abs_max);
+  /**
+   * @brief Set absolute maximum acceleration of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] abs_max [counts/s^2] Absolute maximum motor acceleration.
+   */
+  void SetMotorAccLimit(const id_t motor_id, const double abs_max);
+  /**
+   * @brief Set absolute maximum torque of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] abs_max [nominal points] Absolute maximum motor torque.
+   */
+  void SetMotorTorqueLimit(const id_t motor_id, const int16_t abs_max);
+
+  /**
+   * @brief Get cable length limits of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[out] min [m] Minimum cable length.
+   * @param[out] max [m] Maximum cable length.
+   * @note Limits of a motor not given at construction are null.
+   */
+  void GetCableLenLimits(const id_t motor_id, double& min, double& max) const;
+  /**
+   * @brief Get motor position limits of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[out] min [counts] Minimum motor position.
+   * @param[out] max [counts] Maximum motor position.
+   * @note Limits of a motor not given at construction are null.
+   */
+  void GetMotorPosLimits(const id_t motor_id, int32_t& min, int32_t& max) const;
+  /**
+   * @brief Get absolute maximum speed of a motor.
+   * @param[in] motor_id Motor ID.
+   * @return [counts/s] Absolute maximum motor speed, null for a motor not given at
+   * construction.
+   */
+  int32_t GetMotorSpeedLimit(const id_t motor_id) const;
+  /**
+   * @brief Get absolute maximum acceleration of a motor.
+   * @param[in] motor_id Motor ID.
+   * @return [counts/s^2] Absolute maximum motor acceleration, null for a motor not given
+   * at construction.
+   */
+  double GetMotorAccLimit(const id_t motor_id) const;
+  /**
+   * @brief Get absolute maximum torque of a motor.
+   * @param[in] motor_id Motor ID.
+   * @return [nominal points] Absolute maximum motor torque, null for a motor not given
+   * at construction.
+   */
+  int16_t GetMotorTorqueLimit(const id_t motor_id) const;
+
+  /**
+   * @brief Saturate all control actions within their motor limits.
+   * @param[in,out] actions Control actions to be processed in place.
+   * @param[in] status Current status of the motor targeted by each action (unused).
+   * @param[in] num Number of actions.
+   * @note Every action must target a motor given at construction, otherwise it cannot be
+   * saturated and it is set to NONE.
+   */
+  void Apply(ControlAction* actions, const ActuatorStatus* status, const size_t num);
+
+ private:
+  MotorSlots slots_;
+  vectD min_length_;
+  vectD max_length_;
+  vect<int32_t> min_pos_;
+  vect<int32_t> max_pos_;
+  vect<int32_t> max_speed_;
+  vectD max_acc_;
+  vect<int16_t> max_torque_;
+};
+
+/**
+ * @brief A control stage limiting the variation of every set point between two
+ * consecutive cycles.
+ *
+ * Rates are given per motor ID and per control mode, and they are stored per motor slot
+ * like in LimitClampStage. Whenever a motor enters a new
+ * control mode, or is controlled again after some cycles, its set point starts from the
+ * current motor status, so that a set point far from it is reached gradually instead of
+ * being applied as a step. By default, motor position rate is limited to the absolute
+ * maximum speed shared with the controllers, kAbsMaxMotorSpeed, while all other rates are
+ * unlimited.
+ */
+class RateLimitStage
+{
+ public:
+  /**
+   * @brief Constructor, setting default rates on all given motors.
+   * @param[in] motors_id IDs of all the motors which can be controlled.
+   * @param[in] period_nsec Controller sample period in nanoseconds.
+   */
+  RateLimitStage(const vect<id_t>& motors_id, const uint32_t period_nsec);
+
+  /**
+   * @brief Get stage name.
+   * @return Stage name.
+   */
+  static const char* Name() { return "RateLimit"; }
+
+  /**
+   * @brief Set maximum cable length rate of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] max_rate [m/s] Maximum cable length rate.
+   */
+  void SetCableLenRate(const id_t motor_id, const double max_rate);
+  /**
+   * @brief Set maximum motor position rate of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] max_rate [counts/s] Maximum motor position rate.
+   */
+  void SetMotorPosRate(const id_t motor_id, const double max_rate);
+  /**
+   * @brief Set maximum motor speed rate, i.e. acceleration, of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] max_rate [counts/s^2] Maximum motor speed rate.
+   */
+  void SetMotorSpeedRate(const id_t motor_id, const double max_rate);
+  /**
+   * @brief Set maximum motor torque rate of a motor.
+   * @param[in] motor_id Motor ID.
+   * @param[in] max_rate [nominal points/s] Maximum motor torque rate.
+   */
+  void SetMotorTorqueRate(const id_t motor_id, const double max_rate);
+
+  /**
+   * @brief Limit the variation of all control actions since previous cycle.
+   * @param[in,out] actions Control actions to be processed in place.
+   * @param[in] status Current status of the motor targeted by each action.
+   * @param[in] num Number of actions.
+   * @note Every action must target a motor given at construction, otherwise its
+   * variation cannot be limited and it is set to NONE.
+   */
+  void Apply(ControlAction* actions, const ActuatorStatus* status, const size_t num);
+
+ private:
+  MotorSlots slots_;
+  double period_sec_;
+  uint64_t cycle_ = 0;
+
+  // Maximum variation per cycle, for each motor slot and control mode
+  vect<std::array<double, NONE>> max_step_;
+  // Set point applied at previous cycle, for each motor slot
+  vectD prev_setpoint_;
+  vect<ControlMode> prev_mode_;
+  vect<uint64_t> prev_cycle_;
+
+  void SetRate(const id_t motor_id, const ControlMode mode, const double max_rate);
+};
+
+/**
+ * @brief The control pipeline applied by the robot to the actions of any controller.
+ */
+typedef ControlPipeline<LimitClampStage, RateLimitStage> SafetyPipeline;
+
+#endif // CABLE_ROBOT_CONTROL_STAGES_H
@@ -33,6 +33,23 @@ enum ControlMode : uint8_t
   NONE
 };
 
+/**
+ * @brief Absolute maximum motor speed which any controller may command.
+ */
+static constexpr int32_t kAbsMaxMotorSpeed = 4000000; // [counts/s]
+/**
+ * @brief Absolute maximum motor torque which any controller may command.
+ */
+static constexpr int16_t kAbsMaxMotorTorque = 800; // [nominal points]
+/**
+ * @brief Default proportional gain of motor torque PID controllers.
+ */
+static constexpr double kDefaultTorquePidKp = 0.0263;
+/**
+ * @brief Default integral gain of motor torque PID controllers.
+ */
+static constexpr double kDefaultTorquePidKi = 15.847;
+
 /**
  * @brief The control action structure, including target drive information and set point.
  */
@@ -49,6 +66,23 @@ struct ControlAction
   ControlMode ctrl_mode = ControlMode::NONE; /**< The control mode for the target motor */
 };
 
+/**
+ * @brief A structure collecting the control actions applied in the same cycle.
+ *
+ * Only the first _actions_num_ elements of _actions_ are valid.
+ */
+struct ControlActionsFrame
+{
+  /**
+   * @brief ControlActionsFrame default constructor, yielding an empty frame.
+   */
+  ControlActionsFrame() : cycle_count(0), actions_num(0) {}
+
+  uint32_t cycle_count;                 /**< Real-time cycle counter. */
+  uint8_t actions_num;                  /**< Number of valid control actions. */
+  ControlAction actions[kMaxActuators]; /**< Applied control actions. */
+};
+
 /**
  * @brief The abstract base class for any cable robot controller.
  *
@@ -57,7 +91,9 @@ struct ControlAction
  * a derived class of this abstract class, which provides the virtual API used and called
  * there.
  * Make sure that the computational time of your new controller stays largely within 1ms
- * to have some margin for other cyclic operations. Because the controller is a shared
+ * to have some margin for other cyclic operations. This is enforced by the robot, which
+ * times every call to CalcCtrlActions() against a budget and replaces a controller
+ * repeatedly exceeding it (see ControllerBudget). Because the controller is a shared
  * pointer between threads, be sure to lock the robot mutex when accessing it from
  * outside. Any controller is characterized by a set of targeted motors id and their
  * relative control mode at drive level.
@@ -0,0 +1,135 @@
+/**
+ * @file controller_budget.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing the monitor of controllers computational time against a given
+ * budget.
+ */
+
+#ifndef CABLE_ROBOT_CONTROLLER_BUDGET_H
+#define CABLE_ROBOT_CONTROLLER_BUDGET_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Computational time statistics of a controller.
+ */
+struct BudgetStats
+{
+  uint64_t calls           = 0;     /**< Number of calls since last reset. */
+  uint64_t overruns        = 0;     /**< Number of calls exceeding the budget. */
+  uint32_t max_streak      = 0;     /**< Longest sequence of consecutive overruns. */
+  uint64_t max_nsec        = 0;     /**< [nsec] Worst time since last reset. */
+  uint64_t window_p99_nsec = 0;     /**< [nsec] 99th percentile over latest calls. */
+  uint64_t window_max_nsec = 0;     /**< [nsec] Worst time over latest calls. */
+  uint64_t budget_nsec     = 0;     /**< [nsec] Budget in use. */
+  bool fallback_engaged    = false; /**< _True_ if budget was exhausted. */
+};
+
+/**
+ * @brief A monitor of the time taken by a controller at every cycle, enforcing a given
+ * budget.
+ *
+ * The time of each call to ControllerBase::CalcCtrlActions() is recorded in the real
+ * time thread onto a histogram with fixed-size bins, holding the latest kWindowSize_
+ * samples only, so that the 99th percentile and the worst case over a rolling window
+ * can be inquired at any time from any other thread, together with the all-time worst
+ * case. Recording a sample takes constant time and never allocates or locks.
+ *
+ * A sample exceeding the budget is an overrun. The first overrun of a sequence raises a
+ * warning, while _max_overruns_ consecutive overruns exhaust the budget, meaning that the
+ * controller must be replaced by a safe fallback. Both events are latched and can be
+ * polled from a non real time thread with TakeOverrunWarning() and TakeFallbackNotice().
+ */
+class ControllerBudget
+{
+ public:
+  /**
+   * @brief Outcome of a single recorded sample.
+   */
+  enum Verdict : uint8_t
+  {
+    WITHIN_BUDGET, /**< The sample is within budget. */
+    OVERRUN,       /**< The sample exceeds the budget. */
+    EXHAUSTED      /**< The sample is the last allowed consecutive overrun. */
+  };
+
+  /**
+   * @brief Constructor.
+   * @param[in] budget_nsec [nsec] Time budget of a single call.
+   * @param[in] max_overruns Number of consecutive overruns exhausting the budget.
+   */
+  ControllerBudget(const uint64_t budget_nsec, const uint32_t max_overruns);
+
+  /**
+   * @brief Set time budget of a single call.
+   * @param[in] budget_nsec [nsec] Time budget of a single call.
+   */
+  void SetBudget(const uint64_t budget_nsec) { budget_nsec_ = budget_nsec; }
+  /**
+   * @brief Set number of consecutive overruns exhausting the budget.
+   * @param[in] max_overruns Number of consecutive overruns, at least 1.
+   */
+  void SetMaxOverruns(const uint32_t max_overruns)
+  {
+    max_overruns_ = max_overruns > 0 ? max_overruns : 1;
+  }
+
+  /**
+   * @brief Record the time taken by a single call.
+   * @param[in] elapsed_nsec [nsec] Time taken by the call.
+   * @return The outcome of given sample with respect to the budget.
+   * @note This function lives in the real time thread.
+   */
+  Verdict Record(const uint64_t elapsed_nsec);
+
+  /**
+   * @brief Reset all statistics, e.g. when a new controller is set.
+   * @note This function must not run concurrently with Record().
+   */
+  void Reset();
+
+  /**
+   * @brief Get computational time statistics.
+   * @return Computational time statistics since last reset.
+   */
+  BudgetStats GetStats() const;
+
+  /**
+   * @brief Check and clear the overrun warning.
+   * @return _True_ if a new sequence of overruns started since last call.
+   */
+  bool TakeOverrunWarning() { return overrun_warning_.exchange(false); }
+  /**
+   * @brief Check and clear the fallback notice.
+   * @return _True_ if budget was exhausted since last call.
+   */
+  bool TakeFallbackNotice() { return fallback_notice_.exchange(false); }
+
+ private:
+  static constexpr size_t kWindowSize_ = 1000; // samples, i.e. 1s at 1kHz
+  static constexpr uint64_t kBinNsec_  = 1000; // [nsec]
+  static constexpr size_t kBinsNum_    = 2048; // last bin collects all slower samples
+
+  std::atomic<uint64_t> budget_nsec_;
+  std::atomic<uint32_t> max_overruns_;
+
+  // Rolling window, as a ring of bin indexes and the histogram of its content
+  uint16_t window_[kWindowSize_];
+  size_t window_head_ = 0;
+  std::atomic<uint32_t> histogram_[kBinsNum_];
+
+  std::atomic<uint64_t> calls_;
+  std::atomic<uint64_t> overruns_;
+  std::atomic<uint32_t> max_streak_;
+  std::atomic<uint64_t> max_nsec_;
+  uint32_t streak_ = 0;
+
+  std::atomic<bool> fallback_engaged_;
+  std::atomic<bool> overrun_warning_;
+  std::atomic<bool> fallback_notice_;
+};
+
+#endif // CABLE_ROBOT_CONTROLLER_BUDGET_H
@@ -0,0 +1,112 @@
+/**
+ * @file controller_excitation.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes the implementation of the controller exciting cable lengths
+ * for system identification.
+ */
+
+#ifndef CABLE_ROBOT_CONTROLLER_EXCITATION_H
+#define CABLE_ROBOT_CONTROLLER_EXCITATION_H
+
+#include <QTimer>
+
+#include <atomic>
+
+#include "easylogging++.h"
+
+#include "ctrl/controller_base.h"
+#include "ctrl/excitation_generator.h"
+
+/**
+ * @brief The controller exciting cable lengths for system identification.
+ *
+ * Each controlled motor follows its own excitation signal, generated on the fly by an
+ * ExcitationGenerator, as a relative cable length [m] with respect to its length at the
+ * first controller cycle. Signals are therefore never stored, and memory does not grow
+ * with excitation duration. Once all signals are complete, motors hold their initial
+ * cable length.
+ *
+ * The real-time thread only publishes completion onto a lock-free atomic variable,
+ * without touching any Qt machinery. A timer living in the thread of this object polls it
+ * at display rate (20Hz) and emits the corresponding excitationCompleted() signal. The
+ * timer runs from when an excitation is set until it is completed.
+ */
+class ControllerExcitation: public QObject, public ControllerBase
+{
+  Q_OBJECT
+
+ public:
+  /**
+   * @brief Full constructor.
+   * @param[in] motors_id IDs of the motors to be controlled.
+   * @param[in] cycle_t_nsec Real-time thread cycle time in nanoseconds.
+   * @param[in] parent The optional parent QObject.
+   */
+  explicit ControllerExcitation(const vect<id_t>& motors_id, const uint32_t cycle_t_nsec,
+                                QObject* parent = nullptr);
+  ~ControllerExcitation() override;
+
+  /**
+   * @brief Set excitation signals and restart them.
+   * @param[in] params Excitation parameters, one per controlled motor, in the same order,
+   * with amplitude and offset in meters.
+   * @return _True_ if parameters are valid, _false_ otherwise.
+   * @note Multisine phases are optimized here, therefore this should not be called while
+   * the controller is active.
+   */
+  bool SetExcitations(const vect<ExcitationParams>& params);
+
+  /**
+   * @brief Get the duration of the longest excitation signal.
+   * @return [sec] Excitation duration, rests included.
+   */
+  double GetDuration() const;
+
+  /**
+   * @brief Check if all excitation signals are complete.
+   * @return _True_ if excitation is complete, _false_ otherwise.
+   */
+  bool TargetReached() const override final { return completed_; }
+
+  /**
+   * @brief Calculate control actions depending on current robot status.
+   *
+   * This is the main method of this class, which is called at every cycle of the real
+   * time thread.
+   * The cable length setpoint of each motor is its initial cable length plus the next
+   * value of its excitation signal.
+   * @param[in] robot_status Cable robot status, in terms of platform configuration.
+   * @param[in] actuators_status Actuators status, in terms of drives, winches, pulleys
+   * and cables configuration.
+   * @return Control actions for each targeted motor.
+   */
+  vect<ControlAction>
+  CalcCtrlActions(const grabcdpr::RobotVars& robot_status,
+                  const vect<ActuatorStatus>& actuators_status) override final;
+
+ signals:
+  /**
+   * @brief Signal to notice that all excitation signals have been completed.
+   */
+  void excitationCompleted() const;
+
+ private slots:
+  void pollProgress();
+
+ private:
+  static constexpr int kProgressPollIntervalMsec_ = 50;
+
+  double cycle_time_; // [sec]
+  vect<ExcitationGenerator> generators_;
+  vectD init_cables_len_; // [m]
+  bool new_excitation_;
+
+  // Written by RT thread, polled by progress_timer_
+  QTimer progress_timer_;
+  std::atomic<bool> completed_;
+  std::atomic<uint> completions_count_;
+  uint last_completions_count_;
+};
+
+#endif // CABLE_ROBOT_CONTROLLER_EXCITATION_H
@@ -8,9 +8,14 @@
 #ifndef CABLE_ROBOT_CONTROLLER_JOINTS_PVT_H
 #define CABLE_ROBOT_CONTROLLER_JOINTS_PVT_H
 
+#include <QTimer>
+
+#include <atomic>
+
 #include "easylogging++.h"
 
 #include "ctrl/controller_base.h"
+#include "ctrl/trajectory_feedforward.h"
 #include "ctrl/winch_torque_controller.h"
 
 /**
@@ -25,12 +30,20 @@
  * If trajectories are valid, upon each call of CalcCtrlActions() the point next in line
  * in the trajectory is read and used as next setpoint for the motor.
  *
+ * Cable length and motor position setpoints can be led by the velocity and acceleration
+ * feedforward of their trajectory, computed once when the trajectory is set, to
+ * compensate for the latency of the drive position loop. This is disabled until a lead
+ * time is set by setFeedforwardLeadTime().
+ *
  * The trajectory following can be pause, resumed and stopped at any time. When stopping
  * or resuming time is warped to smooth out the arrest/start up phase and avoid abrubt
  * accelerations at motors level.
  *
- * While executing a trajectory, the progress status is emitted at a constant rate (5Hz).
- * Once trajectory is completed a trajectoryCompleted() signal is emitted.
+ * While executing a trajectory, the real-time thread only publishes progress and
+ * completion onto lock-free atomic variables, without touching any Qt machinery. A
+ * timer living in the thread of this object polls them at display rate (20Hz) and
+ * emits the corresponding trajectoryProgressStatus() and trajectoryCompleted() signals.
+ * The timer runs from when a trajectory is set until it is completed.
  */
 class ControllerJointsPVT: public QObject, public ControllerBase
 {
@@ -46,7 +59,7 @@ class ControllerJointsPVT: public QObject, public ControllerBase
    */
   explicit ControllerJointsPVT(const vect<grabcdpr::ActuatorParams>& params,
                                const uint32_t cycle_t_nsec, QObject* parent = nullptr);
-  ~ControllerJointsPVT() override {}
+  ~ControllerJointsPVT() override;
 
   /**
    * @brief Set trajectories of cable length type.
@@ -73,6 +86,15 @@ class ControllerJointsPVT: public QObject, public ControllerBase
    */
   bool setMotorsTorqueTrajectories(const vect<TrajectoryS>& trajectories);
 
+  /**
+   * @brief Set the time by which cable length and motor position setpoints are led.
+   * @param lead_time [sec] Lead time, 0 to disable feedforward. By default, it is 0,
+   * since it must match the latency of the drive position loop, which has to be
+   * identified on the hardware first.
+   * @see TrajectoryFeedforward
+   */
+  void setFeedforwardLeadTime(const double lead_time) { lead_time_ = lead_time; }
+
   /**
    * @brief Pause trajectory following with a smooth arrest.
    */
@@ -137,7 +159,11 @@ class ControllerJointsPVT: public QObject, public ControllerBase
    */
   void trajectoryProgressStatus(const int, const double) const;
 
+ private slots:
+  void pollProgress();
+
  private:
+  static constexpr int kProgressPollIntervalMsec_ = 50;
   static constexpr double kMinArrestTime_       = 1.0;     // [sec]
   static constexpr double kVel2ArrestTimeRatio_ = 1500000; // [counts/sec^2]
   static constexpr short kTorqueStopValue_ = -300; // [nominal points]
@@ -155,9 +181,22 @@ class ControllerJointsPVT: public QObject, public ControllerBase
   double cycle_time_;     // [sec]
   double traj_time_;      // [sec]
   double true_traj_time_; // [sec]
-  ulong progress_counter_;
+  double time_rate_;      // trajectory time over real time, during last cycle
   bool new_trajectory_;
 
+  // Setpoint lead, one feedforward per position-like trajectory
+  double lead_time_; // [sec]
+  vect<TrajectoryFeedforward> feedforwards_;
+
+  // Written by RT thread, polled by progress_timer_
+  QTimer progress_timer_;
+  std::atomic<int> progress_percent_;
+  std::atomic<double> progress_ts_; // [sec]
+  std::atomic<uint> completions_count_;
+  int last_progress_percent_;
+  double last_progress_ts_; // [sec]
+  uint last_completions_count_;
+
   double stop_request_time_; // [sec]
   bool stop_;
   bool stop_request_;
@@ -177,6 +216,9 @@ class ControllerJointsPVT: public QObject, public ControllerBase
 
   void processTrajTime();
 
+  template <typename T>
+  void computeFeedforwards(const vect<Trajectory<T>>& trajectories);
+
   template <typename T>
   T getTrajectoryPointValue(const id_t id, const vect<Trajectory<T>>& trajectories, const ControlMode mode);
 
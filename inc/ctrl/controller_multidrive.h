@@ -0,0 +1,216 @@
+/**
+ * @file controller_multidrive.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a multi drive controller class for cable robot, moving several
+ * motors simultaneously.
+ */
+
+#ifndef CABLE_ROBOT_CONTROLLER_MULTIDRIVE_H
+#define CABLE_ROBOT_CONTROLLER_MULTIDRIVE_H
+
+#include "libs/grab_common/pid/pid.h"
+
+#include "ctrl/controller_base.h"
+#include "ctrl/poly5_profile.h"
+#include "ctrl/winch_torque_controller.h"
+
+/**
+ * @brief A multi drive control class for cable robot, controlling all its motors at once.
+ *
+ * Unlike ControllerSingleDrive, which controls one motor at a time, this controller
+ * provides control actions for all its motors at every cycle, so that operations
+ * involving several motors run in parallel instead of one motor after the other. Each
+ * motor has its own control mode, target and controller state, e.g. its own torque PID,
+ * while TargetReached() is satisfied only when all motors reached their targets.
+ *
+ * Motor position targets are reached on 5th order polynomial trajectories, with zero
+ * initial and final velocity and acceleration. Trajectories starting together are
+ * time-synchronised unless their time is given: all such motors reach their targets at
+ * the same time, the duration of the whole movement being the one of the longest single
+ * movement. This keeps the platform close to a symmetric configuration along the way.
+ * Trajectory time is counted in controller cycles rather than read from a clock, so that
+ * it is exactly synchronous with the real time thread, and all trajectories are evaluated
+ * at once by a Poly5ProfileBatch.
+ *
+ * @note Per-motor setters silently ignore IDs which are not controlled by this instance.
+ */
+class ControllerMultiDrive: public ControllerBase
+{
+ public:
+  /**
+   * @brief ControllerMultiDrive targetless constructor.
+   * @param[in] period_nsec Controller sample period in nanoseconds.
+   */
+  ControllerMultiDrive(const uint32_t period_nsec);
+  /**
+   * @brief ControllerMultiDrive full constructor.
+   * @param[in] motors_id IDs of the motors to be controlled.
+   * @param[in] period_nsec Controller sample period in nanoseconds.
+   */
+  ControllerMultiDrive(const vect<id_t>& motors_id, const uint32_t period_nsec);
+
+  /**
+   * @brief Set cable length target of a single motor in meters.
+   * @param[in] motor_id ID of the target motor.
+   * @param[in] target Cable length target in meters.
+   * @note This target is effective if and only if ControlMode::CABLE_LENGTH is set for
+   * given motor.
+   */
+  void SetCableLenTarget(const id_t motor_id, const double target);
+  /**
+   * @brief Set motor position target of a single motor, in encoder absolute counts.
+   * @param[in] motor_id ID of the target motor.
+   * @param[in] target Motor position target, in encoder absolute counts.
+   * @param[in] apply_traj If _true_, a 5th order polynomial trajectory is applied to
+   * reach given target.
+   * @param[in] time Time of trajectory execution. If not given, this value is computed
+   * according to the maximum delta counts that the motor can safely handle in a single
+   * cycle.
+   * @note This target is effective if and only if ControlMode::MOTOR_POSITION is set for
+   * given motor.
+   */
+  void SetMotorPosTarget(const id_t motor_id, const int32_t target,
+                         const bool apply_traj = true, const double time = -1.0);
+  /**
+   * @brief Set motor position targets of all controlled motors, in encoder absolute
+   * counts.
+   *
+   * If requested, a time-synchronised 5th order polynomial trajectory is applied to move
+   * all motors from their current position to their target at once.
+   * @param[in] targets Motor position targets, in encoder absolute counts, one per
+   * controlled motor in the same order of their IDs.
+   * @param[in] apply_traj If _true_, 5th order polynomial trajectories are applied to
+   * reach given targets.
+   * @param[in] time Time of trajectory execution. If not given, this value is computed
+   * according to the maximum delta counts that the motors can safely handle in a single
+   * cycle, considering the longest single movement.
+   * @note These targets are effective if and only if ControlMode::MOTOR_POSITION is set.
+   */
+  void SetMotorsPosTarget(const vect<int32_t>& targets, const bool apply_traj = true,
+                          const double time = -1.0);
+  /**
+   * @brief Set motor speed target of a single motor, in counts/s.
+   * @param[in] motor_id ID of the target motor.
+   * @param[in] target Motor speed target, in counts/s.
+   * @note This target is effective if and only if ControlMode::MOTOR_SPEED is set for
+   * given motor.
+   */
+  void SetMotorSpeedTarget(const id_t motor_id, const int32_t target);
+  /**
+   * @brief Set motor torque target of a single motor, in nominal points.
+   * @param[in] motor_id ID of the target motor.
+   * @param[in] target Motor torque target, in nominal points.
+   * @note This target is effective if and only if ControlMode::MOTOR_TORQUE is set for
+   * given motor.
+   */
+  void SetMotorTorqueTarget(const id_t motor_id, const int16_t target);
+  /**
+   * @brief Set motor torque targets of all controlled motors, in nominal points.
+   * @param[in] targets Motor torque targets, in nominal points, one per controlled motor
+   * in the same order of their IDs.
+   * @note These targets are effective if and only if ControlMode::MOTOR_TORQUE is set.
+   */
+  void SetMotorsTorqueTarget(const vect<int16_t>& targets);
+  /**
+   * @brief Set motor torque steady-state error tolerance, common to all motors.
+   * @param[in] tol Motor torque steady-state error tolerance, in nominal points.
+   */
+  void SetMotorTorqueSsErrTol(const int16_t tol) { torque_ss_err_tol_ = tol; }
+  /**
+   * @brief Set the winches controller compensating friction of motor torque targets.
+   * @param[in] winches_controller Pointer to a winches controller, or _nullptr_ to
+   * disable friction compensation. It must outlive this controller.
+   */
+  void SetWinchesController(WinchesTorqueControl* winches_controller)
+  {
+    winches_controller_ = winches_controller;
+  }
+
+  /**
+   * @brief Get motor position targets of all controlled motors, in encoder absolute
+   * counts.
+   * @return Motor position targets, in encoder absolute counts.
+   */
+  const vect<int32_t>& GetMotorsPosTarget() const { return pos_targets_; }
+
+  /**
+   * @brief Check if target of a single motor is reached.
+   * @param[in] motor_id ID of the target motor.
+   * @return _True_ if target is reached, _false_ otherwise or if motor is not
+   * controlled.
+   */
+  bool TargetReached(const id_t motor_id) const;
+  /**
+   * @brief Check if targets of all controlled motors are reached.
+   *
+   * Motors with no control mode set are not considered.
+   * @return _True_ if all targets are reached, _false_ otherwise.
+   */
+  bool TargetReached() const override;
+
+  /**
+   * @brief Calculate control actions depending on current robot status.
+   *
+   * This is the main method of this class, which is called at every cycle of the real
+   * time thread. A control action is provided for each controlled motor, according to
+   * its control mode.
+   * @param[in] robot_status Cable robot status, in terms of platform configuration.
+   * @param[in] actuators_status Actuators status, in terms of drives, winches, pulleys
+   * and cables configuration.
+   * @return Control actions for each targeted motor.
+   */
+  vect<ControlAction>
+  CalcCtrlActions(const grabcdpr::RobotVars& robot_status,
+                  const vect<ActuatorStatus>& actuators_status) override final;
+
+  /**
+   * @brief Clear all targets and controller states, sizing them on controlled motors.
+   *
+   * This is done automatically by the first setter or cycle after controlled motors are
+   * changed, but it can be called beforehand, e.g. right after SetMotorsID(), so that no
+   * memory is allocated by the real time thread.
+   */
+  void Reset();
+
+ private:
+  static constexpr int16_t kDefaultTorqueSsErrTol_ = 5; // [nominal points]
+
+  double period_sec_;
+  int16_t torque_ss_err_tol_;
+  WinchesTorqueControl* winches_controller_ = nullptr;
+  const ParamsPID torque_pid_params_ = {
+    kDefaultTorquePidKp, kDefaultTorquePidKi, 0., 0., kAbsMaxMotorTorque,
+    -kAbsMaxMotorTorque};
+
+  // Per-motor state, indexed as motors_id_. The mode of the target currently set for
+  // each motor is NONE if no target is set.
+  vect<ControlMode> targets_mode_;
+  vect<bool> on_target_;
+  vect<double> length_targets_;
+  vect<int32_t> pos_targets_;
+  vect<int32_t> speed_targets_;
+  vect<int16_t> torque_targets_;
+  vect<PID> torque_pids_;
+
+  // Quintic trajectories, one per motor, evaluated all at once
+  vect<bool> apply_traj_;
+  vect<bool> new_traj_;
+  vect<double> traj_time_; // [sec]
+  vect<double> traj_init_pos_;
+  vect<double> pos_setpoints_;
+  Poly5ProfileBatch pos_profiles_;
+
+  void CheckMotorsNum();
+  size_t MotorIdx(const id_t motor_id) const;
+  void SetTarget(const size_t idx, const ControlMode mode);
+
+  void StartPosTrajectories(const vect<ActuatorStatus>& actuators_status);
+  int32_t CalcMotorPos(const size_t idx);
+  int16_t CalcMotorTorque(const size_t idx, const ActuatorStatus* actuator_status);
+
+  const ActuatorStatus* FindStatus(const id_t motor_id,
+                                   const vect<ActuatorStatus>& actuators_status) const;
+};
+
+#endif // CABLE_ROBOT_CONTROLLER_MULTIDRIVE_H
@@ -13,6 +13,8 @@
 #include "libs/grab_common/pid/pid.h"
 
 #include "ctrl/controller_base.h"
+#include "ctrl/jog_profile.h"
+#include "ctrl/poly5_profile.h"
 
 /**
  * @brief A numerical sign enum
@@ -136,12 +138,15 @@ class ControllerSingleDrive: public ControllerBase
    * cable robot app.
    * The increment is applied as long as the plus/minus button is
    * pressed, so that at every cycle of the controller the winch rolls/unrolls the cable
-   * by a small amount.
+   * by a small amount. Jogging speed is reached and brought back to rest on a
+   * jerk-limited profile, so that pressing and releasing the button never steps the
+   * cable speed.
    * @param[in] active When _true_, a small increment to the targeted drive position is
    * applied at every cycle.
    * @param[in] sign The direction of the increment. POS unrolls the cable, NEG rolls it.
    * @param[in] micromove If _true_ a "micro" increment is applied (5 mm/s), a larger one
-   * (2 cm/s) otherwise.
+   * (2 cm/s by default) otherwise.
+   * @see SetCableLenJogLimits()
    */
   void CableLenIncrement(const bool active, const Sign sign = Sign::POS,
                          const bool micromove = true);
@@ -151,10 +156,27 @@ class ControllerSingleDrive: public ControllerBase
    * Speed scale is directly linked to the slider present in direct drive manual control
    * on the main GUI of cable robot app.
    * This scaling factor set motor's speed in a range from -800000 to +800000 counts per
-   * seconds.
+   * seconds. The scaled speed is reached on a jerk-limited profile.
    * @param[in] scale A scaling factor, from -1.0 to 1.0.
+   * @see SetMotorSpeedJogLimits()
    */
   void ScaleMotorSpeed(const double scale);
+  /**
+   * @brief Set motion limits of cable length jogging.
+   * @param[in] max_speed [m/s] Jogging speed, applied when not in micromove.
+   * @param[in] max_acc [m/s^2] Maximum acceleration.
+   * @param[in] max_jerk [m/s^3] Maximum jerk.
+   * @see CableLenIncrement()
+   */
+  void SetCableLenJogLimits(const double max_speed, const double max_acc,
+                            const double max_jerk);
+  /**
+   * @brief Set motion limits of motor speed jogging.
+   * @param[in] max_acc [counts/s^2] Maximum acceleration.
+   * @param[in] max_jerk [counts/s^3] Maximum jerk.
+   * @see ScaleMotorSpeed()
+   */
+  void SetMotorSpeedJogLimits(const double max_acc, const double max_jerk);
   /**
    * @brief Change motor torque increment.
    *
@@ -184,10 +206,11 @@ class ControllerSingleDrive: public ControllerBase
    * single targeted motor is computed.
    * In particular:
    * - cable length control is applied directly with a continuous synchronous increment
-   * according to the user inputs in the direct drive control panels;
+   * according to the user inputs in the direct drive control panels, following a
+   * jerk-limited online trajectory;
    * - motor position control follows a smooth 5th order polynomial trajectory;
-   * - motor speed is applied directly once scaled by a factor specified by the user in
-   * the same panel;
+   * - motor speed is applied once scaled by a factor specified by the user in the same
+   * panel, following a jerk-limited online trajectory;
    * - motor torque target is filtered through a PI controller before being assigned to
    * the end drive to avoid aggressive, possibly unfeasible deltas.
    * @param[in] robot_status Cable robot status, in terms of platform configuration.
@@ -205,10 +228,12 @@ class ControllerSingleDrive: public ControllerBase
   static constexpr int32_t kMaxPos_                   = 12000000;  // [counts]
   static constexpr int32_t kMinPos_                   = -16500000; // [counts]
   static constexpr int32_t kDefaultPosSsErrTol_       = 5;         // [counts]
-  static constexpr int32_t kAbsMaxSpeed_              = 4000000;   // [counts/s]
   static constexpr int16_t kAbsDeltaTorquePerSec_     = 20;        // [nominal points]
-  static constexpr int16_t kAbsMaxTorque_             = 800;       // [nominal points]
   static constexpr int16_t kDefaultTorqueSsErrTol_    = 5;         // [nominal points]
+  static constexpr double kDefaultLengthJogAcc_       = 0.2;       // [m/s^2]
+  static constexpr double kDefaultLengthJogJerk_      = 2.0;       // [m/s^3]
+  static constexpr double kDefaultSpeedJogAcc_        = 8000000.0; // [counts/s^2]
+  static constexpr double kDefaultSpeedJogJerk_       = 4.0e7;     // [counts/s^3]
 
   enum BitPosition
   {
@@ -238,22 +263,28 @@ class ControllerSingleDrive: public ControllerBase
   bool change_torque_target_;
 
   double abs_delta_length_;
-  double delta_length_;
   double abs_delta_speed_;
   double delta_speed_;
   double abs_delta_torque_;
   double delta_torque_;
 
   PID torque_pid_;
-  const ParamsPID torque_pid_params_ = {0.0263, 15.847,         0.,
-                                        0.,     kAbsMaxTorque_, -kAbsMaxTorque_};
+  const ParamsPID torque_pid_params_ = {
+    kDefaultTorquePidKp, kDefaultTorquePidKi, 0., 0., kAbsMaxMotorTorque,
+    -kAbsMaxMotorTorque};
 
   double traj_time_; /**< [sec] */
   bool new_trajectory_ = false;
   bool apply_trajectory_;
+  Poly5Profile pos_profile_;
 
   vect<double> cable_len_traj_;
 
+  // Online trajectories for manual jogging
+  JogProfile length_jog_;
+  JogProfile speed_jog_;
+  double length_jog_max_speed_ = kAbsDeltaLengthPerSec_;
+
   int32_t CalcMotorPos(const vect<ActuatorStatus>& actuators_status);
   int16_t CalcMotorTorque(const vect<ActuatorStatus>& actuators_status);
 
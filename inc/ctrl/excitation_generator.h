@@ -0,0 +1,185 @@
+/**
+ * @file excitation_generator.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a generator of excitation signals for system identification,
+ * evaluated once per controller cycle.
+ */
+
+#ifndef CABLE_ROBOT_EXCITATION_GENERATOR_H
+#define CABLE_ROBOT_EXCITATION_GENERATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils/types.h"
+
+/**
+ * @brief The possible types of excitation signal.
+ */
+enum ExcitationType : uint8_t
+{
+  PULSE,     /**< Single smooth pulse, i.e. offset alone faded in and out. */
+  MULTISINE, /**< Sum of harmonics with flat spectrum and optimized crest factor. */
+  CHIRP,     /**< Exponential frequency sweep. */
+  PRBS       /**< Maximum length pseudo-random binary sequence. */
+};
+
+/**
+ * @brief A structure collecting the parameters of an excitation signal.
+ *
+ * The signal is preceded and followed by a rest time, where it is null, and it is faded
+ * in and out together with its offset, so that it starts and ends with null velocity.
+ * By default, it is a raised cosine pulse of -5cm lasting 2 seconds, which is a gentle
+ * excitation of a single cable.
+ */
+struct ExcitationParams
+{
+  ExcitationType type = PULSE; /**< Signal type. */
+  double amplitude    = 0.0;   /**< Peak amplitude around offset, unused by pulses. */
+  double offset       = -0.05; /**< Mean value while excitation is active. */
+  double min_freq     = 0.2;   /**< [Hz] Lower bound of excited bandwidth. */
+  double max_freq     = 5.0;   /**< [Hz] Upper bound of excited bandwidth. */
+  double duration     = 2.0;   /**< [sec] Excitation duration, fades included. */
+  double fade_time    = 1.0;   /**< [sec] Duration of fade in and fade out. */
+  double rest_time    = 3.0;   /**< [sec] Rest before and after excitation. */
+  /**
+   * [sec] Further rest before excitation only, e.g. to excite axes one after another.
+   */
+  double delay = 0.0;
+  /**
+   * Seed of multisine phases and of the binary sequence. If 0, multisine starts from
+   * Schroeder phases, otherwise from random ones, so that different seeds yield
+   * uncorrelated signals on different axes.
+   */
+  uint seed = 0;
+};
+
+/**
+ * @brief An excitation signal of a single axis, generated on the fly at constant memory.
+ *
+ * Time is counted in controller cycles, so that the signal is exactly synchronous with
+ * the real time thread. Depending on type:
+ * - a pulse is its offset alone, shaped by fades, so that fades lasting half of the
+ * duration yield a raised cosine;
+ * - a multisine is a sum of up to 256 harmonics of the lowest frequency with equal
+ * amplitude, whose phases are optimized once at construction by iterative clipping to
+ * minimize the crest factor. At run time each harmonic is a recursive oscillator, i.e. a
+ * rotation of its previous value, which is resynchronized to its closed form every
+ * second of signal to avoid drift;
+ * - a chirp sweeps from lowest to highest frequency at an exponential rate, so that each
+ * octave is excited for the same time;
+ * - a PRBS is generated by a linear feedback shift register clocked fast enough to cover
+ * the highest frequency and long enough to cover the lowest one, with raised cosine
+ * transitions between levels.
+ *
+ * The signal is scaled so that its peak equals the given amplitude.
+ */
+class ExcitationGenerator
+{
+ public:
+  /**
+   * @brief Constructor.
+   * @param[in] period_sec [sec] Cycle period.
+   * @param[in] params Excitation parameters.
+   */
+  ExcitationGenerator(const double period_sec,
+                      const ExcitationParams& params = ExcitationParams());
+
+  /**
+   * @brief Restart the signal from the beginning of the initial rest.
+   */
+  void Reset();
+
+  /**
+   * @brief Advance the signal by one cycle and evaluate it.
+   * @return Signal value at current cycle, or 0 if signal is complete.
+   */
+  double Next();
+
+  /**
+   * @brief Check if signal is complete, i.e. if its final rest is over.
+   * @return _True_ if signal is complete, _false_ otherwise.
+   */
+  bool Done() const { return k_ >= end_cycle_; }
+
+  /**
+   * @brief Get the signal duration.
+   * @return [sec] Signal duration, rests included.
+   */
+  double Duration() const { return end_cycle_ * period_sec_; }
+  /**
+   * @brief Get the crest factor of the signal, i.e. the ratio between its peak and RMS
+   * values, excluding fades.
+   * @return The crest factor.
+   */
+  double CrestFactor() const { return crest_factor_; }
+  /**
+   * @brief Get the excitation parameters.
+   * @return The excitation parameters, once validated.
+   */
+  const ExcitationParams& GetParams() const { return params_; }
+
+ private:
+  static constexpr uint kMaxLines_        = 256;
+  static constexpr uint kGridPerLine_     = 8;
+  static constexpr uint kPeakGridPerLine_ = 64;
+  static constexpr uint kCrestIterations_ = 100;
+  static constexpr double kClipRatio_     = 0.8;
+  static constexpr double kResyncTime_    = 1.0; // [sec]
+  static constexpr double kPrbsBandRatio_ = 0.4;
+  static constexpr uint kPrbsMinOrder_    = 2;
+  static constexpr uint kPrbsMaxOrder_    = 20;
+  static constexpr double kPrbsRiseRatio_ = 0.5;
+
+  double period_sec_;
+  ExcitationParams params_;
+  double scale_;
+  double crest_factor_;
+
+  uint64_t k_;
+  uint64_t start_cycle_;
+  uint64_t fade_cycles_;
+  uint64_t excitation_cycles_;
+  uint64_t end_cycle_;
+  uint64_t resync_cycles_;
+
+  // Multisine, as recursive oscillators in structure of arrays layout
+  double base_freq_; // [Hz]
+  vect<uint> lines_; // harmonic numbers
+  vectD phases_;     // [rad]
+  vectD cos_;
+  vectD sin_;
+  vectD cos_step_;
+  vectD sin_step_;
+
+  // Chirp
+  double sweep_ratio_;
+
+  // PRBS
+  double clock_freq_; // [Hz]
+  uint32_t lfsr_taps_;
+  uint32_t lfsr_mask_;
+  uint32_t lfsr_;
+  uint64_t bits_count_;
+  double prev_level_;
+  double level_;
+
+  void SetupMultisine();
+  void SetupChirp();
+  void SetupPrbs();
+
+  double NextMultisine(const uint64_t k);
+  double NextChirp(const uint64_t k) const;
+  double NextPrbs(const uint64_t k);
+  double Envelope(const uint64_t k) const;
+
+  void ResyncOscillators(const uint64_t k);
+  void OptimizePhases();
+  double MultisinePeak(const uint grid_size) const;
+  void SynthesizePeriod(const vectD& cos_table, const vectD& sin_table,
+                        vectD& signal) const;
+  void ShiftRegister();
+};
+
+#endif // CABLE_ROBOT_EXCITATION_GENERATOR_H
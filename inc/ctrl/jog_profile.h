@@ -0,0 +1,93 @@
+/**
+ * @file jog_profile.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a jerk-limited online trajectory generator for manual jogging.
+ */
+
+#ifndef CABLE_ROBOT_JOG_PROFILE_H
+#define CABLE_ROBOT_JOG_PROFILE_H
+
+/**
+ * @brief A jerk-limited online trajectory generator of a single axis, tracking a target
+ * speed which may change at any time.
+ *
+ * This is meant for manual jogging, where the target speed steps whenever a button is
+ * pressed or released, or a slider is moved. Instead of applying such steps directly,
+ * the generator ramps the acceleration at most by _max_jerk_ and saturates it at
+ * _max_acc_, so that the resulting motion is smooth and does not excite platform
+ * oscillations. At every cycle, the acceleration is steered towards
+ * @f$a^*(e) = \mathrm{sign}(e)\min(a_{max}, \sqrt{2 j_{max} |e|})@f$, where _e_ is the
+ * speed error, which is the largest acceleration that can still be ramped down to zero
+ * exactly when target speed is reached. Each cycle takes constant time, so the profile
+ * can be recomputed online within the real time thread.
+ */
+class JogProfile
+{
+ public:
+  /**
+   * @brief Constructor.
+   * @param[in] period_sec [sec] Cycle period.
+   * @param[in] max_speed Maximum absolute speed.
+   * @param[in] max_acc Maximum absolute acceleration.
+   * @param[in] max_jerk Maximum absolute jerk.
+   */
+  JogProfile(const double period_sec, const double max_speed, const double max_acc,
+             const double max_jerk);
+
+  /**
+   * @brief Set motion limits. Target speed is saturated accordingly.
+   * @param[in] max_speed Maximum absolute speed.
+   * @param[in] max_acc Maximum absolute acceleration.
+   * @param[in] max_jerk Maximum absolute jerk.
+   */
+  void SetLimits(const double max_speed, const double max_acc, const double max_jerk);
+
+  /**
+   * @brief Reset the axis state, stopping any ongoing motion.
+   * @param[in] position Current position.
+   * @param[in] speed Current speed, which is also the new target speed.
+   */
+  void Reset(const double position, const double speed = 0.0);
+
+  /**
+   * @brief Set target speed, saturated within maximum speed.
+   * @param[in] speed Target speed.
+   */
+  void SetTargetSpeed(const double speed);
+
+  /**
+   * @brief Advance the profile by one cycle.
+   * @return Position at current cycle.
+   */
+  double Next();
+
+  /**
+   * @brief Get position at current cycle.
+   * @return Position at current cycle.
+   */
+  double Position() const { return pos_; }
+  /**
+   * @brief Get speed at current cycle.
+   * @return Speed at current cycle.
+   */
+  double Speed() const { return vel_; }
+  /**
+   * @brief Check if axis is at rest, with no motion requested.
+   * @return _True_ if speed, acceleration and target speed are all null.
+   */
+  bool Idle() const { return vel_ == 0.0 && acc_ == 0.0 && target_vel_ == 0.0; }
+
+ private:
+  double period_sec_;
+  double max_speed_;
+  double max_acc_;
+  double max_jerk_;
+
+  double pos_        = 0.0;
+  double vel_        = 0.0;
+  double acc_        = 0.0;
+  double target_vel_ = 0.0;
+};
+
+#endif // CABLE_ROBOT_JOG_PROFILE_H
@@ -0,0 +1,120 @@
+/**
+ * @file poly5_profile.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing 5th order polynomial profile generators, evaluated once per
+ * controller cycle.
+ */
+
+#ifndef CABLE_ROBOT_POLY5_PROFILE_H
+#define CABLE_ROBOT_POLY5_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils/types.h"
+
+/**
+ * @brief A 5th order polynomial profile of a single axis, from an initial to a final
+ * value with null initial and final velocity and acceleration.
+ *
+ * Time is counted in controller cycles, so that the profile is exactly synchronous with
+ * the real time thread, and coefficients are precomputed at start with respect to the
+ * cycle count _k_, so that each waypoint is evaluated in Horner form as
+ * @f$q(k) = a_0 + k^3(c_3 + k(c_4 + k c_5))@f$.
+ */
+class Poly5Profile
+{
+ public:
+  /**
+   * @brief Start a new profile.
+   * @param[in] q_init Initial value.
+   * @param[in] q_final Final value.
+   * @param[in] cycles Profile duration in cycles. If 0, final value is returned
+   * straight away.
+   */
+  void Start(const double q_init, const double q_final, const uint64_t cycles);
+
+  /**
+   * @brief Advance the profile by one cycle and evaluate it.
+   * @return Profile value at current cycle, or final value if profile is complete.
+   */
+  double Next();
+
+  /**
+   * @brief Check if profile is complete, i.e. if its final value was returned.
+   * @return _True_ if profile is complete, _false_ otherwise.
+   */
+  bool Done() const { return k_ >= n_; }
+
+  /**
+   * @brief Convert a duration into a number of cycles, rounding up.
+   * @param[in] time_sec [sec] Duration.
+   * @param[in] period_sec [sec] Cycle period.
+   * @return Number of cycles, 0 if duration is not positive.
+   */
+  static uint64_t CyclesFromTime(const double time_sec, const double period_sec);
+
+ private:
+  // Cycle counts are stored as double to keep evaluation free of conversions.
+  double a0_ = 0.0, c3_ = 0.0, c4_ = 0.0, c5_ = 0.0;
+  double q_final_ = 0.0;
+  double n_       = 0.0; // profile duration in cycles
+  double k_       = 0.0; // cycles elapsed since profile start
+};
+
+/**
+ * @brief A batch of 5th order polynomial profiles, one per axis, evaluated all at once.
+ *
+ * This is the structure-of-arrays counterpart of Poly5Profile: each axis has its own
+ * profile, which can be started independently, while all of them advance together at
+ * every call to Evaluate(). The evaluation loop is branchless and operates on contiguous
+ * arrays, so that it is vectorized by the compiler.
+ */
+class Poly5ProfileBatch
+{
+ public:
+  /**
+   * @brief Set the number of axes, resetting all profiles.
+   * @param[in] axes_num Number of axes.
+   */
+  void Resize(const size_t axes_num);
+  /**
+   * @brief Get the number of axes.
+   * @return The number of axes.
+   */
+  size_t Size() const { return a0_.size(); }
+
+  /**
+   * @brief Start a new profile on a single axis.
+   * @param[in] idx Axis index.
+   * @param[in] q_init Initial value.
+   * @param[in] q_final Final value.
+   * @param[in] cycles Profile duration in cycles. If 0, final value is returned
+   * straight away.
+   */
+  void Start(const size_t idx, const double q_init, const double q_final,
+             const uint64_t cycles);
+
+  /**
+   * @brief Advance all profiles by one cycle and evaluate them.
+   * @param[out] values Profile values at current cycle, one per axis. It must point to
+   * at least Size() elements.
+   */
+  void Evaluate(double* values);
+
+  /**
+   * @brief Check if profile of a single axis is complete.
+   * @param[in] idx Axis index.
+   * @return _True_ if profile is complete, _false_ otherwise.
+   */
+  bool Done(const size_t idx) const { return k_[idx] >= n_[idx]; }
+
+ private:
+  vect<double> a0_, c3_, c4_, c5_;
+  vect<double> q_final_;
+  vect<double> n_;
+  vect<double> k_;
+};
+
+#endif // CABLE_ROBOT_POLY5_PROFILE_H
@@ -0,0 +1,68 @@
+/**
+ * @file trajectory_feedforward.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing the velocity and acceleration feedforward of a sampled
+ * trajectory.
+ */
+
+#ifndef CABLE_ROBOT_TRAJECTORY_FEEDFORWARD_H
+#define CABLE_ROBOT_TRAJECTORY_FEEDFORWARD_H
+
+#include "utils/types.h"
+
+/**
+ * @brief The velocity and acceleration profiles of a sampled position-like trajectory,
+ * used to lead its setpoints.
+ *
+ * For PVT trajectories, velocity and acceleration are the analytic derivatives of their
+ * cubic Hermite splines. Otherwise, they are computed once, when the trajectory is set,
+ * at each sample by second order finite differences on non-uniform timestamps, and
+ * linearly interpolated in between at every cycle. They are used to lead the setpoint by
+ * the latency of the drive position loop, i.e.
+ * @f$q(t) + \dot{q}(t)\,T_{lead} + \frac{1}{2}\ddot{q}(t)\,T_{lead}^2@f$, so that the
+ * drive does not have to infer velocity from position deltas and following error does
+ * not grow with speed. Before the first and after the last sample the trajectory is
+ * held still, therefore both velocity and acceleration are null there.
+ */
+class TrajectoryFeedforward
+{
+ public:
+  /**
+   * @brief Compute velocity and acceleration profiles of given trajectory.
+   * @param[in] traj A trajectory with valid timestamps.
+   */
+  template <typename T>
+  void Compute(const Trajectory<T>& traj)
+  {
+    timestamps_ = traj.timestamps;
+    values_.assign(traj.values.begin(), traj.values.end());
+    hermite_ = traj.hasVelocities();
+    if (hermite_)
+      velocities_ = traj.velocities;
+    else
+      ComputeDerivatives();
+  }
+
+  /**
+   * @brief Get the lead term to be added to the setpoint at given time.
+   * @param[in] abs_time [sec] Absolute trajectory time.
+   * @param[in] lead_time [sec] Time by which the setpoint is led.
+   * @param[in] time_rate Rate of trajectory time with respect to real time, which is
+   * lower than 1 while trajectory following is smoothly stopped or resumed.
+   * @return The lead term, in trajectory units.
+   */
+  double Lead(const double abs_time, const double lead_time,
+              const double time_rate = 1.0) const;
+
+ private:
+  vectD timestamps_;
+  vectD values_;
+  vectD velocities_;
+  vectD accelerations_;
+  bool hermite_ = false;
+
+  void ComputeDerivatives();
+};
+
+#endif // CABLE_ROBOT_TRAJECTORY_FEEDFORWARD_H
@@ -8,15 +8,66 @@
 #ifndef CABLE_ROBOT_WINCH_TORQUE_CONTROLLER_H
 #define CABLE_ROBOT_WINCH_TORQUE_CONTROLLER_H
 
+#include <cassert>
+#include <string>
+
 #include "libcdpr/inc/cdpr_types.h"
 
 #include "utils/types.h"
 
+/**
+ * @brief Friction model parameters of a single winch and its pulleys system.
+ *
+ * Friction torque is modeled as
+ * @f[
+ * \tau_f(\omega, \theta) = \sigma(\omega)\left(\tau_c + \Delta\tau_c(\theta)\right) +
+ * b\,\omega
+ * @f]
+ * where @f$\omega@f$ is the motor speed, @f$\theta@f$ the swivel pulley angle and
+ * @f$\sigma@f$ a sign function smoothed within _stiction_speed_, to avoid chattering
+ * around standstill. The pulley-angle dependent Coulomb term @f$\Delta\tau_c@f$ is
+ * given by _angle_coulomb_ samples, located at the centers of evenly sized bins spanning
+ * [_angle_min_, _angle_max_], linearly interpolated in between and held beyond.
+ */
+struct WinchFrictionParams
+{
+  double coulomb        = 0.0; /**< [nominal points] Coulomb friction. */
+  double viscous        = 0.0; /**< [nominal points/(counts/s)] Viscous coefficient. */
+  double stiction_speed = 1.0; /**< [counts/s] Speed below which sign is smoothed. */
+  double angle_min      = 0.0; /**< [rad] Lower bound of pulley angle samples. */
+  double angle_max      = 0.0; /**< [rad] Upper bound of pulley angle samples. */
+  vect<double> angle_coulomb;  /**< [nominal points] Pulley-angle Coulomb samples. */
+};
+
+/**
+ * @brief Identify winch friction parameters from calibration logs.
+ *
+ * Samples must be recorded while moving the winch at several constant speeds, in both
+ * directions and across the pulley angle range, with no external load, so that the
+ * measured motor torque equals the friction torque. Coulomb and viscous terms are
+ * fitted by least squares on samples faster than _stiction_speed_, then the mean
+ * residual within each pulley angle bin gives the pulley-angle dependent term. Bins
+ * without samples are linearly interpolated between the nearest ones, or take the value
+ * of the nearest one at range ends.
+ * @param[in] samples Logged actuator status samples of a single winch.
+ * @param[in] angle_bins Number of pulley angle bins.
+ * @param[in] stiction_speed [counts/s] Speed below which samples are discarded.
+ * @param[out] params Identified friction parameters.
+ * @return _True_ if identification succeeded, _false_ if samples are not enough.
+ */
+bool identifyWinchFriction(const vect<ActuatorStatus>& samples, const size_t angle_bins,
+                           const double stiction_speed, WinchFrictionParams& params);
+
 /**
  * @brief The controller of a single winch.
  *
  * This controller takes into account the friction given by the pulleys systems and
- * regulate the torque consequently.
+ * regulate the torque consequently, adding the friction torque predicted by its model to
+ * the desired target. The pulley-angle dependent term is precomputed onto a fixed-size
+ * table with power-of-two resolution, so that evaluation at every cycle takes a handful
+ * of multiplications and never allocates.
+ *
+ * Until friction parameters are set, the model is null and targets pass through.
  */
 class WinchTorqueControl
 {
@@ -28,16 +79,26 @@ class WinchTorqueControl
    */
   explicit WinchTorqueControl(const id_t id, const grabcdpr::ActuatorParams& params);
 
+  /**
+   * @brief Set friction model parameters and precompute interpolation table.
+   * @param params Friction model parameters.
+   */
+  void setFrictionParams(const WinchFrictionParams& params);
+  /**
+   * @brief Get friction model parameters.
+   * @return Friction model parameters.
+   */
+  const WinchFrictionParams& frictionParams() const { return friction_params_; }
+
   /**
    * @brief Calculate servo torque setpoint given current actuator status and desired
    * target.
    * @param status Current actuator status.
-   * @param target Desired torque target in N/m.
-   * @return The adjusted torque setpoint in nominal points to achieve desired target.
-   * @warning Currently this function is dummy, so output = target in.
-   * @todo this
+   * @param target Desired torque target in nominal points.
+   * @return The adjusted torque setpoint in nominal points to achieve desired target,
+   * i.e. target plus predicted friction torque.
    */
-  short calcServoTorqueSetpoint(const ActuatorStatus& status, const short target);
+  short calcServoTorqueSetpoint(const ActuatorStatus& status, const short target) const;
 
   /**
    * @brief Returns winch ID.
@@ -46,7 +107,17 @@ class WinchTorqueControl
   id_t id() const { return id_; }
 
  private:
+  static constexpr size_t kTableIntervals_ = 256;
+
   id_t id_;
+  WinchFrictionParams friction_params_;
+
+  // Precomputed model, evaluated at every cycle
+  double viscous_            = 0.0;
+  double inv_stiction_speed_ = 1.0;
+  double angle_min_          = 0.0;
+  double inv_angle_step_     = 0.0;
+  double coulomb_table_[kTableIntervals_ + 1];
 };
 
 
@@ -54,23 +125,80 @@ class WinchTorqueControl
  * @brief The controller of multiple winches.
  *
  * This controller takes into account the frictions given by each pulleys systems and
- * regulate the torques consequently.
+ * regulate the torques consequently. There is one single winch controller per actuator,
+ * active or not, so that winch controllers are directly indexed by their ID.
  */
 class WinchesTorqueControl
 {
  public:
+  /**
+   * @brief Default location of friction parameters file.
+   */
+  static const std::string kDefaultFrictionFilepath;
+  /**
+   * @brief Default number of pulley angle bins used for identification.
+   */
+  static constexpr size_t kDefaultAngleBins = 16;
+  /**
+   * @brief [counts/s] Default speed below which samples are discarded by identification.
+   */
+  static constexpr double kDefaultStictionSpeed = 20000.0;
+
   /**
    * @brief Constructor.
    * @param params Parameters set for each actuator to which the winches belongs.
+   * @param friction_filepath Path of the JSON file holding friction parameters. If it
+   * can't be loaded, friction is not compensated.
+   * @see loadFrictionParams()
+   */
+  WinchesTorqueControl(const vect<grabcdpr::ActuatorParams>& params,
+                       const std::string& friction_filepath = kDefaultFrictionFilepath);
+
+  /**
+   * @brief Load friction parameters of all winches from a JSON file.
+   *
+   * The file holds a _winches_ array, whose elements include winch _id_ and all fields
+   * of WinchFrictionParams. Winches not listed in the file keep their parameters.
+   * @param filepath Path of the JSON file.
+   * @return _True_ if file was loaded successfully, _false_ otherwise.
+   * @see saveFrictionParams()
+   */
+  bool loadFrictionParams(const std::string& filepath);
+  /**
+   * @brief Save friction parameters of all winches onto a JSON file.
+   * @param filepath Path of the JSON file.
+   * @return _True_ if file was written successfully, _false_ otherwise.
+   * @see loadFrictionParams()
+   */
+  bool saveFrictionParams(const std::string& filepath) const;
+  /**
+   * @brief Identify friction parameters of all winches from a binary data log.
+   *
+   * Actuator status samples are collected from any logged message holding them, such as
+   * the frames of all actuators, and each winch is identified on its own samples by
+   * identifyWinchFriction(). Winches with too few samples keep their parameters.
+   * @param log_filepath Path of the binary data log, recorded as required by
+   * identifyWinchFriction().
+   * @param angle_bins Number of pulley angle bins.
+   * @param stiction_speed [counts/s] Speed below which samples are discarded.
+   * @return IDs of identified winches, empty if none was or log could not be read.
+   * @see saveFrictionParams()
    */
-  WinchesTorqueControl(const vect<grabcdpr::ActuatorParams>& params);
+  vect<id_t> identifyFrictionParams(const std::string& log_filepath,
+                                    const size_t angle_bins = kDefaultAngleBins,
+                                    const double stiction_speed = kDefaultStictionSpeed);
 
   /**
    * @brief operator []
-   * @param id Winch ID
+   * @param id Winch ID, which must be lower than the number of actuators.
    * @return The corresponding single winch controller.
+   * @note ID is checked by assertion only, since this is called by the real-time thread.
    */
-  WinchTorqueControl& operator[](const id_t id);
+  WinchTorqueControl& operator[](const id_t id)
+  {
+    assert(id < controllers_.size());
+    return controllers_[id];
+  }
 
  private:
   vect<WinchTorqueControl> controllers_;
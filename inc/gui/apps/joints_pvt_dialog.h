@@ -75,6 +75,10 @@ class JointsPVTDialog: public QDialog
  private slots:
   void handleTransitionCompleted();
   void handleTrajectoryCompleted();
+  void handleReadProgress(const int files_done, const int files_num);
+  void handleReadCompleted(const bool success, const QString& failed_filepath,
+                           const QString& reason);
+  void handleCheckCompleted(const bool safe, const QString& summary);
   void progressUpdateCallback(const int progress_value, const double timestamp);
   void progressUpdate(const int progress_value, const double timestamp);
 
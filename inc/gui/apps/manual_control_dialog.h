@@ -9,6 +9,7 @@
 #define CABLE_ROBOT_MANUAL_CONTROL_DIALOG_H
 
 #include <QDialog>
+#include <QSpinBox>
 #include <QTimer>
 
 #include "apps/manual_control_app.h"
@@ -45,6 +46,10 @@ class ManualControlDialog: public QDialog
   void updateActualXYZ();
 
  private slots:
+  void on_spinBox_x_editingFinished();
+  void on_spinBox_y_editingFinished();
+  void on_spinBox_z_editingFinished();
+
   void on_pushButton_reset_clicked();
 
   void on_pushButton_return_clicked();
@@ -60,6 +65,7 @@ class ManualControlDialog: public QDialog
   QTimer actual_pos_timer_;
 
   void resetTargetXYZ();
+  void updateTarget(const Coordinates coord, QSpinBox* spin_box);
 };
 
 #endif // CABLE_ROBOT_MANUAL_CONTROL_DIALOG_H
@@ -9,6 +9,8 @@
 #define CABLE_ROBOT_CALIB_INTERFACE_EXCITATION_H
 
 #include <QDialog>
+#include <QFileDialog>
+#include <QMessageBox>
 
 #include "calib/calib_excitation.h"
 
@@ -25,7 +27,9 @@ class CalibInterfaceExcitation;
  * - Switch between position and torque control, being the former used to fix the cables
  * length and the latter to manually move the platform (freedrive mode);
  * - Once in position control, start the logging phase, while a trajectory is excecuted to
- * excite most platform dynamics.
+ * excite most platform dynamics;
+ * - Load a different excitation design from file, before logging;
+ * - Identify winches friction from a logged session.
  */
 class CalibInterfaceExcitation: public QDialog
 {
@@ -36,11 +40,8 @@ class CalibInterfaceExcitation: public QDialog
    * @brief Full constructor.
    * @param parent The parent Qt object, in our case the main GUI.
    * @param robot Pointer to the cable robot instance.
-   * @param[in] params params A vector of actuator parameters, with as many elements as
-   * the active motors.
    */
-  explicit CalibInterfaceExcitation(QWidget* parent, CableRobot* robot,
-                                    const vect<grabcdpr::ActuatorParams>& params);
+  explicit CalibInterfaceExcitation(QWidget* parent, CableRobot* robot);
   ~CalibInterfaceExcitation();
 
  private slots:
@@ -53,7 +54,9 @@ class CalibInterfaceExcitation: public QDialog
   void on_radioButton_position_clicked();
   void on_pushButton_return_clicked();
 
+  void on_pushButton_loadExcitation_clicked();
   void on_pushButton_logging_clicked();
+  void on_pushButton_identifyFriction_clicked();
 
  private:
   Ui::CalibInterfaceExcitation* ui;
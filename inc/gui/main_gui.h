@@ -17,6 +17,7 @@
 #include "easylogging++.h"
 #include "libcdpr/inc/cdpr_types.h"
 
+#include "ctrl/controller_multidrive.h"
 #include "ctrl/controller_singledrive.h"
 #include "gui/apps/joints_pvt_dialog.h"
 #include "gui/apps/manual_control_dialog.h"
@@ -148,6 +149,8 @@ class MainGUI: public QDialog
   std::bitset<5> desired_ctrl_mode_;
   id_t motor_id_;
   ControllerSingleDrive* man_ctrl_ptr_;
+  ControllerMultiDrive* freedrive_ctrl_ptr_ = nullptr;
+  WinchesTorqueControl winches_controller_;
 
   void DisablePosCtrlButtons(const bool value);
   void DisableVelCtrlButtons(const bool value);
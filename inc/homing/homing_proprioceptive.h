@@ -16,9 +16,11 @@
 #include "StateMachine.h"
 #include "easylogging++.h"
 
+#include "ctrl/controller_multidrive.h"
 #include "ctrl/controller_singledrive.h"
 #include "homing/matlab_thread.h"
 #include "robot/cablerobot.h"
+#include "utils/tracer.h"
 #include "utils/types.h"
 
 #define HOMING_ACK true /**< Control motors in position mode even in should be torque */
@@ -257,6 +259,7 @@ class HomingProprioceptive: public QObject, public StateMachine
  private:
   CableRobot* robot_ptr_ = nullptr;
   ControllerSingleDrive controller_;
+  ControllerMultiDrive startup_controller_;
 
   static constexpr size_t kNumMeasMin_     = 1;
   static constexpr qint16 kTorqueSsErrTol_ = 5;
@@ -303,6 +306,7 @@ class HomingProprioceptive: public QObject, public StateMachine
   // clang-format on
 
   States prev_state_;
+  TraceTrack trace_track_{"HomingProprioceptive"};
 
   // Define the state machine state functions with event data type
   GUARD_DECLARE(HomingProprioceptive, GuardIdle, NoEventData)
@@ -25,9 +25,15 @@
 #endif
 
 #include "components/actuator.h"
+#include "ctrl/control_stages.h"
+#include "ctrl/controller_budget.h"
 #include "ctrl/controller_base.h"
+#include "ctrl/controller_multidrive.h"
 #include "ctrl/controller_singledrive.h"
+#include "robot/workspace_grid.h"
 #include "utils/easylog_wrapper.h"
+#include "utils/flight_recorder.h"
+#include "utils/tracer.h"
 
 /**
  * @brief The virtualization of physical GRAB CDPR.
@@ -53,7 +59,8 @@
  * or ethercat network failures.
  *
  * Robot status logging is also implemented here and can be exploited with CollectMeas()
- * and DumpMeas() functions.
+ * and DumpMeas() functions. Besides, an always-on flight recorder keeps the latest
+ * real-time cycles in memory and dumps them onto disk upon any drive fault or error.
  *
  * Last important remark regards the controller. The controller is called at every cycle
  * of the real time thread and provides commands to the motors, if present and its output
@@ -120,6 +127,17 @@ class CableRobot: public QObject,
    * @return A structure describing latest status of the robot.
    */
   const grabcdpr::RobotVars& GetRobotVars() const { return cdpr_status_; }
+  /**
+   * @brief Get robot configuration parameters.
+   * @return Robot configuration parameters.
+   */
+  const grabcdpr::RobotParams& GetRobotParams() const { return params_; }
+  /**
+   * @brief Get precomputed wrench-feasible workspace of the robot.
+   * @return The workspace grid, which is invalid until the offline analysis is over.
+   * @see WorkspaceGrid WorkspaceAnalyzer
+   */
+  const WorkspaceGrid& GetWorkspace() const { return workspace_; }
 
   /**
    * @brief Update home configuration of all actuators at once.
@@ -168,10 +186,15 @@ class CableRobot: public QObject,
   void EnableMotor(const id_t motor_id);
   /**
    * @brief Enable all motors at once.
+   * @see EnableMotors(const vect<id_t>&)
    */
   void EnableMotors();
   /**
    * @brief Enable a set of motors.
+   *
+   * All drives are brought through their enable sequence in parallel, so that the total
+   * enabling time is close to the one of a single drive. Returns when all drives are
+   * either enabled or failed.
    * @param[in] motors_id The IDs of the motor to enable.
    */
   void EnableMotors(const vect<id_t>& motors_id);
@@ -182,10 +205,14 @@ class CableRobot: public QObject,
   void DisableMotor(const id_t motor_id);
   /**
    * @brief Disable all motors at once.
+   * @see DisableMotors(const vect<id_t>&)
    */
   void DisableMotors();
   /**
    * @brief Disable a set of motors.
+   *
+   * Disable commands are issued to all drives at once, then their completion is awaited
+   * in parallel. The outcome of each drive and the total latency are logged.
    * @param[in] motors_id The IDs of the motor to disable.
    */
   void DisableMotors(const vect<id_t>& motors_id);
@@ -213,11 +240,16 @@ class CableRobot: public QObject,
   vect<id_t> GetActiveMotorsID() const { return active_actuators_id_; }
   /**
    * @brief Clear any motor's fault.
+   *
+   * Fault reset commands are issued to all faulted drives at once, then their
+   * completion is awaited in parallel. The outcome of each drive and the total recovery
+   * latency are logged.
    */
   void ClearFaults();
 
   /**
-   * @brief Collect current cable robot measurents without locking the RT-thread mutex.
+   * @brief Collect current cable robot measurents into a single frame without locking
+   * the RT-thread mutex.
    */
   void CollectMeasRt();
   /**
@@ -225,22 +257,22 @@ class CableRobot: public QObject,
    */
   void CollectMeas();
   /**
-   * @brief Dump latest collected cable robot measurements onto data.log file.
+   * @brief Dump latest collected cable robot measurements onto binary data log.
    */
-  void DumpMeas() const;
+  void DumpMeas();
   /**
-   * @brief Collect and dump current cable robot measurements onto data.log file without
+   * @brief Collect and dump current cable robot measurements onto binary data log without
    * locking the RT-thread mutex.
    */
   void CollectAndDumpMeasRt();
   /**
-   * @brief Collect and dump current cable robot measurements onto data.log file locking
+   * @brief Collect and dump current cable robot measurements onto binary data log locking
    * the RT-thread mutex.
    */
   void CollectAndDumpMeas();
   /**
    * @brief Collect and dump current cable robot measurements of a single actuator onto
-   * data.log file.
+   * binary data log.
    * @param[in] actuator_id ID of inquired actuator.
    */
   void CollectAndDumpMeas(const id_t actuator_id);
@@ -258,6 +290,11 @@ class CableRobot: public QObject,
    * @brief Flush data logs up to now.
    */
   void FlushDataLogs();
+  /**
+   * @brief Manually trigger the flight recorder, dumping the latest real-time cycles.
+   * @see FlightRecorder
+   */
+  void TriggerFlightRecorder();
 
   /**
    * @brief Go to home position.
@@ -275,6 +312,29 @@ class CableRobot: public QObject,
    * condition.
    */
   void SetController(ControllerBase* controller);
+  /**
+   * @brief Get the safety pipeline applied to the actions of any controller.
+   *
+   * Its stages, i.e. LimitClampStage and RateLimitStage, process the control actions of
+   * all motors at every cycle, after ControllerBase::CalcCtrlActions() and before they
+   * are applied. Their execution time is accumulated and reported at shutdown.
+   * @return A reference to the safety pipeline.
+   * @note Stages are used by the real time thread, so they must be configured while
+   * holding robot mutex.
+   */
+  SafetyPipeline& GetCtrlPipeline() { return ctrl_pipeline_; }
+  /**
+   * @brief Get the monitor of controller computational time.
+   *
+   * Every call to ControllerBase::CalcCtrlActions() is timed against a budget, by default
+   * of 500us. The first overrun of a sequence is reported as a warning, while 5
+   * consecutive overruns replace the controller with a preallocated one holding all
+   * motors in their current position, aborting any ongoing wait. Statistics are reset
+   * whenever a new controller is set, so that they can be used to certify it.
+   * @return A reference to the controller budget monitor.
+   * @see ControllerBudget
+   */
+  ControllerBudget& GetCtrlBudget() { return ctrl_budget_; }
   /**
    * @brief Wait until controller target is reached.
    * @return 0 if target was reached, a positive number otherwise, yielding the error
@@ -364,11 +424,6 @@ class CableRobot: public QObject,
    */
   void actuatorStatus(const ActuatorStatus&) const;
 
-  /**
-   * @brief Signal including a serialized message to be logged.
-   */
-  void sendMsg(const QByteArray) const;
-
   /**
    * @brief Signal including a message to any QConsole, for instance a QTextBrowser.
    */
@@ -388,6 +443,8 @@ class CableRobot: public QObject,
   void forwardPrintToQConsole(const QString&) const;
   void emitMotorStatus();
   void emitActuatorStatus();
+  void adoptWorkspace();
+  void checkCtrlBudget();
 
  private:
   //-------- Pseudo-signals from EthercatMaster base class (live in RT thread) --------//
@@ -401,20 +458,37 @@ class CableRobot: public QObject,
   grabcdpr::RobotVars cdpr_status_;
   grabcdpr::RobotParams params_;
 
+  // Wrench-feasible workspace, loaded from cache or computed offline at startup
+  static constexpr double kWorkspaceResolution_ = 0.05; // [m]
+  WorkspaceGrid workspace_;
+  WorkspaceAnalyzer* workspace_analyzer_ = nullptr;
+
   // Timers for status updates
   static constexpr int kMotorStatusIntervalMsec_    = 100;
   static constexpr int kActuatorStatusIntervalMsec_ = 10;
   QTimer* motor_status_timer_                       = nullptr;
   QTimer* actuator_status_timer_                    = nullptr;
+  // Timer for controller budget reports, always running
+  static constexpr int kCtrlBudgetIntervalMsec_ = 100;
+  QTimer* ctrl_budget_timer_                    = nullptr;
 
   void StopTimers();
 
   // Data logging
-  vect<ActuatorStatusMsg> meas_;
+  ActuatorsFrameMsg frame_;
   LogBuffer log_buffer_;
   grabrt::Clock clock_;
   bool rt_logging_enabled_;
   uint rt_logging_mod_;
+  uint32_t rt_cycle_counter_ = 0;
+
+  // Always-on flight recorder, capturing cycles before and after a fault, as many as
+  // fit in these time windows at the configured real-time cycle time
+  static constexpr double kFlightRecorderPreTime_  = 2.0; // [sec]
+  static constexpr double kFlightRecorderPostTime_ = 1.0; // [sec]
+  FlightRecorder flight_recorder_;
+  ControlActionsFrame ctrl_actions_frame_;
+  uint32_t faults_mask_ = 0; // bit i set if i-th active actuator was in fault
 
   // Ethercat related
 #if INCLUDE_EASYCAT
@@ -428,6 +502,8 @@ class CableRobot: public QObject,
   bool ec_network_valid_ = false;
   bool rt_thread_active_ = false;
 
+  bool DisableDrives(const vect<Actuator*>& actuators_ptrs, const bool fault_reset);
+
   void EcWorkFun() override final;      // lives in the RT thread
   void EcEmergencyFun() override final; // lives in the RT thread
 
@@ -438,6 +514,16 @@ class CableRobot: public QObject,
 
   // Control related
   ControllerBase* controller_ = nullptr;
+  SafetyPipeline ctrl_pipeline_;
+  ActuatorStatus ctrl_status_[kMaxActuators]; // status of each motor in control frame
+
+  // Controller computational time budget, with fallback on hold position when exhausted
+  static constexpr uint64_t kCtrlBudgetNsec_  = 500000; // [nsec]
+  static constexpr uint32_t kCtrlMaxOverruns_ = 5;
+  ControllerBudget ctrl_budget_;
+  ControllerMultiDrive hold_controller_;
+
+  void EngageHoldController();
 
   void ControlStep();
 
@@ -461,6 +547,7 @@ class CableRobot: public QObject,
   // clang-format on
 
   States prev_state_;
+  TraceTrack trace_track_{"CableRobot"};
 
   // Define the state machine state functions with event data type
   STATE_DECLARE(CableRobot, Idle, NoEventData)
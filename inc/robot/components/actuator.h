@@ -16,6 +16,7 @@
 #include "libgrabrt/inc/clocks.h"
 
 #include "pulleys_system.h"
+#include "utils/tracer.h"
 #include "winch.h"
 
 using GSWDStates = grabec::GoldSoloWhistleDriveStates; /**< Shortcut for GSWD states. */
@@ -61,6 +62,16 @@ class Actuator: public QObject, public StateMachine
     ST_MAX_STATES
   };
 
+  /**
+   * @brief The progress of a non-blocking drive state sequence.
+   */
+  enum SequenceStatus : BYTE
+  {
+    SEQ_IN_PROGRESS,
+    SEQ_DONE,
+    SEQ_FAILED
+  };
+
  public:
   /**
    * @brief Return actuator ID.
@@ -160,6 +171,47 @@ class Actuator: public QObject, public StateMachine
    */
   bool IsInFault() { return GetCurrentState() == ST_FAULT; }
 
+  /**
+   * @brief Start the CiA-402 enable sequence of the drive, without waiting for it.
+   *
+   * The sequence is then carried on by repeated calls to AdvanceEnableSequence(), so
+   * that several drives can be enabled in parallel by a single waiting loop. Once the
+   * sequence is done, enable() completes immediately.
+   * @see AdvanceEnableSequence()
+   */
+  void StartEnableSequence();
+  /**
+   * @brief Advance the CiA-402 enable sequence of the drive by at most one step.
+   *
+   * The command leading to next drive state (shutdown, switch on, enable operation) is
+   * issued as soon as the drive reaches the previous one. This function never blocks.
+   * @return SEQ_DONE if drive operation is enabled, SEQ_FAILED if drive is in fault or
+   * took too long to complete a step, SEQ_IN_PROGRESS otherwise.
+   * @see StartEnableSequence()
+   */
+  SequenceStatus AdvanceEnableSequence();
+  /**
+   * @brief Issue the command disabling the drive completely, without waiting for it.
+   *
+   * No command is issued if drive is already disabled. Completion is then checked by
+   * repeated calls to AdvanceDisableSequence(), so that several drives can be disabled
+   * or reset in parallel by a single waiting loop. Once the sequence is done, disable()
+   * and faultReset() complete immediately.
+   * @param[in] fault_reset If _true_, a fault reset is issued, which also clears any
+   * fault, otherwise drive voltage is simply disabled.
+   * @see AdvanceDisableSequence()
+   */
+  void StartDisableSequence(const bool fault_reset);
+  /**
+   * @brief Check the progress of the disable sequence of the drive.
+   *
+   * This function never blocks and does not print any warning on failure.
+   * @return SEQ_DONE if drive is disabled, SEQ_FAILED if drive took too long to be
+   * disabled, SEQ_IN_PROGRESS otherwise.
+   * @see StartDisableSequence()
+   */
+  SequenceStatus AdvanceDisableSequence();
+
   /**
    * @brief Map DriveState to ActuatorState.
    * @param[in] drive_state
@@ -238,6 +290,11 @@ class Actuator: public QObject, public StateMachine
 
   States prev_state_;
   grabrt::ThreadClock clock_;
+  TraceTrack trace_track_;
+
+  // Non-blocking drive state sequences
+  int seq_drive_state_ = -1; // drive state when last command was issued
+  timespec seq_step_t0_;
 
   // Define the state machine state functions with event data type
   GUARD_DECLARE(Actuator, GuardIdle, NoEventData)
@@ -0,0 +1,233 @@
+/**
+ * @file trajectory_checker.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing an offline checker of cable tensions and interferences along a
+ * whole trajectory and the thread class which runs it.
+ */
+
+#ifndef CABLE_ROBOT_TRAJECTORY_CHECKER_H
+#define CABLE_ROBOT_TRAJECTORY_CHECKER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+#include <atomic>
+
+#include "robot/workspace_grid.h"
+#include "utils/types.h"
+
+/**
+ * @brief A structure collecting the parameters of a trajectory check.
+ */
+struct TrajectoryCheckParams
+{
+  /**
+   * Gravity and tension bounds of the static equilibrium, as well as the platform
+   * orientation of trajectories which only give platform position. Grid box and
+   * resolution are not used.
+   */
+  WorkspaceGridParams wrench;
+  double min_clearance = 0.005; /**< [m] Minimum distance between cables and platform. */
+  double sample_period = 0.01;  /**< [sec] Resampling period of Hermite trajectories. */
+  double fk_tolerance  = 1e-5;  /**< [m] Cable length tolerance of forward kinematics. */
+};
+
+/**
+ * @brief The checks performed on each trajectory sample.
+ */
+enum TrajectoryCheckType : uint8_t
+{
+  TENSION_CHECK,        /**< Tensions within bounds for static equilibrium. */
+  CABLE_CABLE_CHECK,    /**< No cable-cable interference. */
+  CABLE_PLATFORM_CHECK, /**< No cable-platform interference. */
+  KINEMATICS_CHECK,     /**< Platform pose found from cable lengths. */
+  CHECKS_NUM
+};
+
+/**
+ * @brief The first trajectory sample failing a check.
+ */
+struct CheckViolation
+{
+  bool found    = false; /**< _True_ if any sample fails the check. */
+  size_t sample = 0;     /**< Index of the first failing sample. */
+  double time   = 0.0;   /**< [sec] Absolute time of the first failing sample. */
+  id_t cable_a  = 0;     /**< ID of the cable involved, if any. */
+  id_t cable_b  = 0;     /**< ID of the other cable or platform cable involved, if any. */
+};
+
+/**
+ * @brief The outcome of a trajectory check.
+ */
+struct TrajectoryCheckReport
+{
+  size_t samples_num = 0;     /**< Number of checked samples. */
+  bool from_cache    = false; /**< _True_ if report was found in cache. */
+  /** First failing sample of each check. */
+  CheckViolation violations[CHECKS_NUM];
+
+  /**
+   * @brief Check if all samples passed all checks.
+   * @return _True_ if trajectory is safe, _false_ otherwise.
+   */
+  bool IsSafe() const;
+  /**
+   * @brief Get a human readable summary of the first failing sample of each check.
+   * @return The summary, which is empty if trajectory is safe.
+   */
+  QString Summary() const;
+};
+
+/**
+ * @brief An offline checker of cable tensions and interferences along a whole
+ * trajectory, using the robot model of the loaded configuration.
+ *
+ * At each sample, the platform pose is either given, or found from cable lengths by
+ * damped Gauss-Newton iterations on the inverse kinematics model, each one starting from
+ * the pose of the previous sample. Then the pose is checked for:
+ * - static equilibrium with all tensions within bounds, as in
+ * WorkspaceGrid::IsPoseFeasible();
+ * - cable-cable interference, i.e. any two cables closer than minimum clearance;
+ * - cable-platform interference, i.e. any cable closer than minimum clearance to an edge
+ * of the convex hull of the attachment points, or crossing one of its faces.
+ *
+ * Samples are swept in chunks by a pool of worker threads, each skipping the chunks
+ * after a failing sample of all checks, so that only the first failing sample of each
+ * check is reported. Reports are cached in memory by trajectory content, so that
+ * checking the same trajectory again is immediate.
+ */
+class TrajectoryChecker
+{
+ public:
+  /**
+   * @brief Constructor.
+   * @param[in] robot_params Robot configuration parameters.
+   * @param[in] params Check parameters.
+   */
+  TrajectoryChecker(const grabcdpr::RobotParams& robot_params,
+                    const TrajectoryCheckParams& params = TrajectoryCheckParams());
+
+  /**
+   * @brief Check a platform trajectory.
+   * @param[in] traj_platform Platform trajectory, given as 3 position components in
+   * global coordinates, with fixed orientation, or 6 pose components.
+   * @param[out] report The check report.
+   * @param[in] threads_num Number of worker threads. If 0, a quarter of available cores
+   * is used, see BackgroundWorkersNum().
+   * @param[in] abort_flag Optional flag to be set from outside to abort the check.
+   * @return _True_ if check was completed, _false_ if aborted or trajectory is not valid.
+   */
+  bool CheckPlatform(const vect<TrajectoryD>& traj_platform,
+                     TrajectoryCheckReport& report, const uint threads_num = 0,
+                     const std::atomic<bool>* abort_flag = nullptr);
+  /**
+   * @brief Check a cable lengths trajectory.
+   * @param[in] traj_cables_len Cable lengths trajectories, one per active actuator, in
+   * any order.
+   * @param[out] report The check report.
+   * @param[in] threads_num Number of worker threads. If 0, a quarter of available cores
+   * is used, see BackgroundWorkersNum().
+   * @param[in] abort_flag Optional flag to be set from outside to abort the check.
+   * @return _True_ if check was completed, _false_ if aborted or trajectories do not
+   * cover all active actuators.
+   * @note Robots with less than 6 active cables are checked at the fixed platform
+   * orientation of check parameters, since their pose is not fully constrained.
+   */
+  bool CheckCablesLength(const vect<TrajectoryD>& traj_cables_len,
+                         TrajectoryCheckReport& report, const uint threads_num = 0,
+                         const std::atomic<bool>* abort_flag = nullptr);
+
+  /**
+   * @brief Remove all cached reports.
+   */
+  void ClearCache();
+
+ private:
+  static constexpr int kMaxCachedReports_ = 256;
+  static constexpr size_t kChunkSize_     = 256;
+
+  enum InputType : uint8_t
+  {
+    PLATFORM_POSE,
+    CABLES_LENGTH
+  };
+
+  grabcdpr::RobotParams robot_params_;
+  TrajectoryCheckParams params_;
+  vect<id_t> active_ids_;
+  quint64 fingerprint_;
+
+  QMutex cache_mutex_;
+  QHash<QByteArray, TrajectoryCheckReport> cache_;
+
+  bool Check(const InputType input_type, const vect<const TrajectoryD*>& trajectories,
+             TrajectoryCheckReport& report, const uint threads_num,
+             const std::atomic<bool>* abort_flag);
+  QByteArray CacheKey(const InputType input_type,
+                      const vect<const TrajectoryD*>& trajectories) const;
+  bool SolveForwardKinematics(const vectD& lengths, grabnum::Vector6d& pose,
+                              grabcdpr::RobotVars& vars) const;
+  void CheckInterference(const grabnum::Vector6d& pose, const grabcdpr::RobotVars& vars,
+                         CheckViolation& cable_cable,
+                         CheckViolation& cable_platform) const;
+};
+
+/**
+ * @brief A trajectory to be checked by TrajectoryCheckAnalyzer.
+ *
+ * The platform trajectory is checked if not empty, the cable lengths one otherwise.
+ */
+struct TrajectoryCheckJob
+{
+  vect<TrajectoryD> traj_platform;   /**< Platform trajectory. */
+  vect<TrajectoryD> traj_cables_len; /**< Cable lengths trajectories. */
+};
+
+/**
+ * @brief A thread class to run trajectory checks offline, without blocking the GUI.
+ */
+class TrajectoryCheckAnalyzer: public QThread
+{
+  Q_OBJECT
+ public:
+  /**
+   * @brief TrajectoryCheckAnalyzer full constructor.
+   * @param[in] parent The parent Qt object, from which the new thread is forked.
+   * @param[in] checker The checker, which must outlive this thread.
+   * @param[in] jobs The trajectories to be checked, in order.
+   */
+  TrajectoryCheckAnalyzer(QObject* parent, TrajectoryChecker* checker,
+                          const vect<TrajectoryCheckJob>& jobs);
+  ~TrajectoryCheckAnalyzer() override;
+
+  /**
+   * @brief Get resulting reports.
+   * @return One report per job, in order, which are not valid until resultsReady() is
+   * emitted. A job which could not be checked has a report with no samples.
+   */
+  const vect<TrajectoryCheckReport>& GetReports() const { return reports_; }
+
+  /**
+   * @brief Abort a running analysis.
+   */
+  void Abort() { abort_ = true; }
+
+ signals:
+  /**
+   * @brief Results ready notice.
+   */
+  void resultsReady() const;
+
+ private:
+  TrajectoryChecker* checker_;
+  vect<TrajectoryCheckJob> jobs_;
+  vect<TrajectoryCheckReport> reports_;
+  std::atomic<bool> abort_;
+
+  void run() override;
+};
+
+#endif // CABLE_ROBOT_TRAJECTORY_CHECKER_H
@@ -0,0 +1,258 @@
+/**
+ * @file workspace_grid.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a precomputed wrench-feasible workspace grid of the cable robot
+ * and the offline analyser which generates it.
+ */
+
+#ifndef CABLE_ROBOT_WORKSPACE_GRID_H
+#define CABLE_ROBOT_WORKSPACE_GRID_H
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+
+#include <atomic>
+
+#include "easylogging++.h"
+#include "libcdpr/inc/kinematics.h"
+#include "libgrabrt/inc/clocks.h"
+#include "matrix.h"
+
+#include "utils/background_workers.h"
+#include "utils/types.h"
+
+/**
+ * @brief A structure collecting the parameters defining a workspace grid.
+ *
+ * The grid spans a box in global coordinates with a uniform resolution along each axis,
+ * while platform orientation is kept fixed to the given value.
+ */
+struct WorkspaceGridParams
+{
+  grabnum::Vector3d min_pos;     /**< [m] Lower corner of the grid box. */
+  grabnum::Vector3d max_pos;     /**< [m] Upper corner of the grid box. */
+  grabnum::Vector3d orientation; /**< [rad] Fixed platform orientation. */
+  grabnum::Vector3d gravity;     /**< [m/s^2] Gravity acceleration in global frame. */
+  double resolution  = 0.05;     /**< [m] Grid step along each axis. */
+  double min_tension = 5.0;      /**< [N] Minimum admissible cable tension. */
+  double max_tension = 1000.0;   /**< [N] Maximum admissible cable tension. */
+
+  /**
+   * @brief Default constructor.
+   *
+   * Gravity is directed along negative global Z-axis and the grid box is empty.
+   */
+  WorkspaceGridParams();
+
+  /**
+   * @brief Build grid parameters spanning the box enclosing all active pulleys.
+   * @param[in] params Robot configuration parameters.
+   * @param[in] resolution [m] Grid step along each axis.
+   * @return Grid parameters with default tension bounds and null orientation.
+   */
+  static WorkspaceGridParams FromRobotParams(const grabcdpr::RobotParams& params,
+                                             const double resolution = 0.05);
+};
+
+/**
+ * @brief A precomputed grid of wrench-feasible platform positions.
+ *
+ * Each node of the grid stores a single bit telling whether the platform, placed at that
+ * position with the fixed orientation given by the grid parameters, can be statically
+ * balanced with all cable tensions within admissible bounds. Feasibility is evaluated
+ * once and offline by Compute() or WorkspaceAnalyzer, stored on disk with Save() and
+ * reloaded with Load(), so that online checks reduce to a constant-time lookup with
+ * IsFeasible().
+ *
+ * Each cache file is tagged with a fingerprint of the robot configuration it was
+ * computed for, so that a stale cache is rejected instead of being silently used.
+ */
+class WorkspaceGrid
+{
+ public:
+  /**
+   * @brief Default constructor, yielding an empty (invalid) grid.
+   */
+  WorkspaceGrid() {}
+
+  /**
+   * @brief Check if grid has been computed or loaded.
+   * @return _True_ if grid is valid, _false_ otherwise.
+   */
+  bool IsValid() const { return !bits_.empty(); }
+  /**
+   * @brief Get grid parameters.
+   * @return Grid parameters.
+   */
+  const WorkspaceGridParams& GetParams() const { return params_; }
+  /**
+   * @brief Get the fingerprint of the robot configuration this grid was computed for.
+   * @return Robot configuration fingerprint.
+   */
+  quint64 GetFingerprint() const { return fingerprint_; }
+  /**
+   * @brief Get the number of feasible nodes.
+   * @return The number of feasible nodes.
+   */
+  size_t FeasibleNodesNum() const;
+  /**
+   * @brief Get the total number of nodes.
+   * @return The total number of nodes.
+   */
+  size_t NodesNum() const { return nx_ * ny_ * nz_; }
+
+  /**
+   * @brief Check if given platform position is wrench-feasible.
+   *
+   * The position is snapped to the nearest grid node. Positions outside grid box are
+   * always unfeasible.
+   * @param[in] pos [m] Platform position in global coordinates.
+   * @return _True_ if position is feasible, _false_ otherwise.
+   * @note This is a constant-time lookup which does not allocate, so it can safely be
+   * called within the real-time thread.
+   */
+  bool IsFeasible(const grabnum::Vector3d& pos) const;
+  /**
+   * @brief Clamp a target position along the segment starting from a feasible one.
+   * @param[in] from [m] Starting platform position, supposedly feasible.
+   * @param[in] to [m] Desired target platform position.
+   * @return The farthest feasible position on the segment from _from_ to _to_, which is
+   * _to_ itself if this is feasible or _from_ if no further position is.
+   */
+  grabnum::Vector3d Clamp(const grabnum::Vector3d& from,
+                          const grabnum::Vector3d& to) const;
+
+  /**
+   * @brief Evaluate wrench-feasibility of the whole grid.
+   * @param[in] robot_params Robot configuration parameters.
+   * @param[in] grid_params Grid parameters.
+   * @param[in] threads_num Number of worker threads. If 0, a quarter of available cores
+   * is used, see BackgroundWorkersNum().
+   * @param[in] abort_flag Optional flag to be set from outside to abort computation.
+   * @return _True_ if computation was completed, _false_ if aborted.
+   */
+  bool Compute(const grabcdpr::RobotParams& robot_params,
+               const WorkspaceGridParams& grid_params, const uint threads_num = 0,
+               const std::atomic<bool>* abort_flag = nullptr);
+
+  /**
+   * @brief Save grid onto a binary file.
+   * @param[in] filepath Destination file path. Missing directories are created.
+   * @return _True_ if file was written successfully, _false_ otherwise.
+   */
+  bool Save(const QString& filepath) const;
+  /**
+   * @brief Load grid from a binary file.
+   * @param[in] filepath Source file path.
+   * @param[in] fingerprint Expected robot configuration fingerprint. If not 0, a file
+   * computed for a different configuration is rejected.
+   * @return _True_ if file was loaded successfully, _false_ otherwise.
+   */
+  bool Load(const QString& filepath, const quint64 fingerprint = 0);
+
+  /**
+   * @brief Compute a fingerprint of robot configuration and grid parameters.
+   *
+   * The fingerprint combines robot topology, winches transmission ratios, platform mass
+   * and cable lengths at a few probe poses, so that any relevant change in the
+   * configuration file yields a different value.
+   * @param[in] robot_params Robot configuration parameters.
+   * @param[in] grid_params Grid parameters.
+   * @return A 64-bit fingerprint.
+   */
+  static quint64 Fingerprint(const grabcdpr::RobotParams& robot_params,
+                             const WorkspaceGridParams& grid_params);
+  /**
+   * @brief Get default cache file location for given fingerprint.
+   * @param[in] fingerprint Robot configuration fingerprint.
+   * @return Default cache file path.
+   */
+  static QString DefaultCacheFilepath(const quint64 fingerprint);
+
+  /**
+   * @brief Check if given platform pose is wrench-feasible.
+   *
+   * Platform static equilibrium is solved as a non-negative least-squares problem on
+   * cable tensions. If the robot has less than 6 active cables, only the force balance
+   * is considered, i.e. platform is treated as a point mass.
+   * @param[in] pose Platform pose (position and orientation).
+   * @param[in] robot_params Robot configuration parameters.
+   * @param[in] grid_params Grid parameters, providing gravity and tension bounds.
+   * @param[out] vars Robot variables, used as workspace for inverse kinematics.
+   * @return _True_ if pose is feasible, _false_ otherwise.
+   */
+  static bool IsPoseFeasible(const grabnum::Vector6d& pose,
+                             const grabcdpr::RobotParams& robot_params,
+                             const WorkspaceGridParams& grid_params,
+                             grabcdpr::RobotVars& vars);
+
+ private:
+  static constexpr quint32 kMagicNumber_ = 0x57534752; // "WSGR"
+  static constexpr quint32 kVersion_     = 1;
+
+  WorkspaceGridParams params_;
+  quint64 fingerprint_ = 0;
+  size_t nx_           = 0;
+  size_t ny_           = 0;
+  size_t nz_           = 0;
+  vect<quint64> bits_;
+
+  inline bool NodeIndex(const grabnum::Vector3d& pos, size_t& index) const;
+};
+
+/**
+ * @brief A thread class to run workspace analysis offline, without blocking the GUI.
+ *
+ * Once started, it looks for a valid cache file of the given configuration first and
+ * computes the grid on low-priority background workers only if none is found, saving the
+ * result for next time.
+ */
+class WorkspaceAnalyzer: public QThread
+{
+  Q_OBJECT
+ public:
+  /**
+   * @brief WorkspaceAnalyzer full constructor.
+   * @param[in] parent The parent Qt object, from which the new thread is forked.
+   * @param[in] robot_params Robot configuration parameters.
+   * @param[in] grid_params Grid parameters.
+   */
+  WorkspaceAnalyzer(QObject* parent, const grabcdpr::RobotParams& robot_params,
+                    const WorkspaceGridParams& grid_params);
+  ~WorkspaceAnalyzer() override;
+
+  /**
+   * @brief Get resulting grid.
+   * @return The resulting grid, which is invalid until resultsReady() is emitted.
+   */
+  const WorkspaceGrid& GetGrid() const { return grid_; }
+
+  /**
+   * @brief Abort a running analysis.
+   */
+  void Abort() { abort_ = true; }
+
+ signals:
+  /**
+   * @brief Results ready notice.
+   */
+  void resultsReady() const;
+  /**
+   * @brief Signal including a message to any QConsole, for instance a QTextBrowser.
+   */
+  void printToQConsole(const QString&) const;
+
+ private:
+  grabcdpr::RobotParams robot_params_;
+  WorkspaceGridParams grid_params_;
+  WorkspaceGrid grid_;
+  std::atomic<bool> abort_;
+
+  void run() override;
+};
+
+#endif // CABLE_ROBOT_WORKSPACE_GRID_H
@@ -0,0 +1,40 @@
+/**
+ * @file background_workers.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing helpers to run background analyses on several worker threads,
+ * without starving the threads operating the robot.
+ */
+
+#ifndef CABLE_ROBOT_BACKGROUND_WORKERS_H
+#define CABLE_ROBOT_BACKGROUND_WORKERS_H
+
+#include <functional>
+#include <stddef.h>
+
+/**
+ * @brief Get the number of worker threads of a background analysis.
+ *
+ * Since analyses run while the robot is operated, possibly two at once, by default each
+ * one takes at most a quarter of available cores, so that real time, GUI and logging
+ * threads are never starved.
+ * @param[in] threads_num Requested number of worker threads. If 0, the default one is
+ * used.
+ * @param[in] max_useful Maximum number of workers which can share the analysis.
+ * @return The number of worker threads, at least 1.
+ */
+unsigned int BackgroundWorkersNum(const unsigned int threads_num,
+                                  const size_t max_useful = static_cast<size_t>(-1));
+
+/**
+ * @brief Run a function on several worker threads at once, and wait for all of them.
+ *
+ * Workers run at the highest niceness, since the priority of a QThread, e.g.
+ * QThread::LowPriority, is not inherited by the threads it starts.
+ * @param[in] workers_num Number of worker threads.
+ * @param[in] worker The function run by each thread, which must share work with others.
+ */
+void RunBackgroundWorkers(const unsigned int workers_num,
+                          const std::function<void()>& worker);
+
+#endif // CABLE_ROBOT_BACKGROUND_WORKERS_H
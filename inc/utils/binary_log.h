@@ -0,0 +1,401 @@
+/**
+ * @file binary_log.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing the implementation of a compact binary data log format, together
+ * with its writer and reader.
+ *
+ * A binary log file is made of a self-describing header followed by a sequence of
+ * records, all encoded in little-endian byte order:
+ *
+ * | Item           | Encoding                                                       |
+ * |----------------|----------------------------------------------------------------|
+ * | magic          | 8 chars, "CRBINLOG"                                            |
+ * | format version | uint16                                                         |
+ * | schemas number | uint16                                                         |
+ * | each schema    | uint32 type, string name, uint16 fields num, fields, group     |
+ * | group          | string name, uint16 fields num, fields (since version 2)       |
+ * | each field     | uint8 field type, string name                                  |
+ * | each record    | uint32 type, float64 timestamp, fields packed in schema order, |
+ * |                | then uint8 items num and items if schema has a group           |
+ * | each item      | group fields packed in schema order                            |
+ *
+ * where a string is encoded as its uint16 length followed by its UTF-8 characters.
+ * Records of a message type without a group all have the same size, while those with a
+ * group, such as a frame collecting the status of all actuators, only include the items
+ * actually present.
+ * Since the header fully describes the layout of each record, readers do not need to
+ * know anything about the application which wrote the file.
+ * @note This file depends on Qt core only, so that it can be shared with offline tools.
+ */
+
+#ifndef CABLE_ROBOT_BINARY_LOG_H
+#define CABLE_ROBOT_BINARY_LOG_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QtEndian>
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+static constexpr char kBinLogMagic[]         = "CRBINLOG"; /**< File magic string. */
+static constexpr size_t kBinLogMagicSize      = 8;          /**< File magic length. */
+static constexpr quint16 kBinLogFormatVersion = 2; /**< Current file format version. */
+
+/**
+ * @brief The list of scalar types a logged field can be made of.
+ */
+enum BinLogFieldType : quint8
+{
+  FIELD_INT8,
+  FIELD_UINT8,
+  FIELD_INT16,
+  FIELD_UINT16,
+  FIELD_INT32,
+  FIELD_UINT32,
+  FIELD_INT64,
+  FIELD_UINT64,
+  FIELD_FLOAT32,
+  FIELD_FLOAT64,
+  FIELD_TYPES_NUM
+};
+
+/**
+ * @brief Get the size of a field type.
+ * @param[in] type Field type.
+ * @return The size in bytes of given field type, or 0 if type is not valid.
+ */
+size_t BinLogFieldSize(const BinLogFieldType type);
+
+// @cond DO_NOT_DOCUMENT
+template <typename T, typename Enable = void> struct BinLogFieldTypeOf;
+// Enumerations are logged as their underlying type.
+template <typename T>
+struct BinLogFieldTypeOf<T, typename std::enable_if<std::is_enum<T>::value>::type>
+  : BinLogFieldTypeOf<typename std::underlying_type<T>::type>
+{};
+template <> struct BinLogFieldTypeOf<int8_t>
+{
+  static constexpr BinLogFieldType value = FIELD_INT8;
+};
+template <> struct BinLogFieldTypeOf<uint8_t>
+{
+  static constexpr BinLogFieldType value = FIELD_UINT8;
+};
+template <> struct BinLogFieldTypeOf<int16_t>
+{
+  static constexpr BinLogFieldType value = FIELD_INT16;
+};
+template <> struct BinLogFieldTypeOf<uint16_t>
+{
+  static constexpr BinLogFieldType value = FIELD_UINT16;
+};
+template <> struct BinLogFieldTypeOf<int32_t>
+{
+  static constexpr BinLogFieldType value = FIELD_INT32;
+};
+template <> struct BinLogFieldTypeOf<uint32_t>
+{
+  static constexpr BinLogFieldType value = FIELD_UINT32;
+};
+template <> struct BinLogFieldTypeOf<int64_t>
+{
+  static constexpr BinLogFieldType value = FIELD_INT64;
+};
+template <> struct BinLogFieldTypeOf<uint64_t>
+{
+  static constexpr BinLogFieldType value = FIELD_UINT64;
+};
+template <> struct BinLogFieldTypeOf<float>
+{
+  static constexpr BinLogFieldType value = FIELD_FLOAT32;
+};
+template <> struct BinLogFieldTypeOf<double>
+{
+  static constexpr BinLogFieldType value = FIELD_FLOAT64;
+};
+// @endcond
+
+/**
+ * @brief A structure describing a logged field.
+ */
+struct BinLogField
+{
+  QString name;         /**< Field name. */
+  BinLogFieldType type; /**< Field scalar type. */
+  size_t offset;        /**< Field offset within message body, if any. */
+
+  /**
+   * @brief Default constructor.
+   */
+  BinLogField() : type(FIELD_FLOAT64), offset(0) {}
+  /**
+   * @brief Full constructor.
+   * @param[in] _name Field name.
+   * @param[in] _type Field scalar type.
+   * @param[in] _offset Field offset within message body.
+   */
+  BinLogField(const QString& _name, const BinLogFieldType _type, const size_t _offset = 0)
+    : name(_name), type(_type), offset(_offset)
+  {}
+};
+
+/**
+ * @brief A structure describing a group of repeated fields within a message.
+ *
+ * A group is a fixed-capacity array of items with the same layout, of which only the
+ * first ones are valid according to an item counter. Only valid items are logged.
+ */
+struct BinLogGroup
+{
+  QString name;                    /**< Group name. */
+  std::vector<BinLogField> fields; /**< Item fields, with offsets within an item. */
+  size_t count_offset = 0;         /**< Offset of uint8 items counter within body. */
+  size_t items_offset = 0;         /**< Offset of first item within body. */
+  size_t item_stride  = 0;         /**< Distance between consecutive items in body. */
+
+  /**
+   * @brief Default constructor, yielding an empty group.
+   */
+  BinLogGroup() {}
+  /**
+   * @brief Full constructor.
+   * @param[in] _name Group name.
+   * @param[in] _fields Item fields, with offsets within an item.
+   * @param[in] _count_offset Offset of uint8 valid items counter within message body.
+   * @param[in] _items_offset Offset of first item within message body.
+   * @param[in] _item_stride Distance between consecutive items in message body.
+   */
+  BinLogGroup(const QString& _name, const std::vector<BinLogField>& _fields,
+              const size_t _count_offset, const size_t _items_offset,
+              const size_t _item_stride)
+    : name(_name), fields(_fields), count_offset(_count_offset),
+      items_offset(_items_offset), item_stride(_item_stride)
+  {}
+
+  /**
+   * @brief Check if group is empty, i.e. message has no repeated fields.
+   * @return _True_ if group is empty, _false_ otherwise.
+   */
+  bool isEmpty() const { return fields.empty(); }
+  /**
+   * @brief Get the packed size of an item.
+   * @return The size in bytes of an item in a record.
+   */
+  size_t itemSize() const;
+};
+
+/**
+ * @brief A structure describing the layout of a logged message type.
+ */
+struct BinLogSchema
+{
+  quint32 msg_type = 0;            /**< Message type ID, unique within a log file. */
+  QString name;                    /**< Message type name. */
+  std::vector<BinLogField> fields; /**< Message body fields, in logging order. */
+  BinLogGroup group;               /**< Optional group of repeated fields. */
+
+  /**
+   * @brief Default constructor.
+   */
+  BinLogSchema() {}
+  /**
+   * @brief Full constructor.
+   * @param[in] _msg_type Message type ID.
+   * @param[in] _name Message type name.
+   * @param[in] _fields Message body fields, in logging order.
+   * @param[in] _group Optional group of repeated fields, logged after all other fields.
+   */
+  BinLogSchema(const quint32 _msg_type, const QString& _name,
+               const std::vector<BinLogField>& _fields,
+               const BinLogGroup& _group = BinLogGroup())
+    : msg_type(_msg_type), name(_name), fields(_fields), group(_group)
+  {}
+
+  /**
+   * @brief Get the packed size of message body fields, excluding group.
+   * @return The size in bytes of message body fields in a record.
+   */
+  size_t bodySize() const;
+  /**
+   * @brief Get the size of the fixed part of a record of this message type.
+   * @return The size in bytes of a record, including record header and excluding group
+   * items and their counter.
+   */
+  size_t recordSize() const;
+};
+
+/**
+ * @brief A structure holding a single decoded field value.
+ */
+struct BinLogValue
+{
+  BinLogFieldType type = FIELD_FLOAT64; /**< Original field type. */
+  union
+  {
+    qint64 i;  /**< Value of signed integer fields. */
+    quint64 u; /**< Value of unsigned integer fields. */
+    double f;  /**< Value of floating point fields. */
+  };
+
+  /**
+   * @brief Default constructor.
+   */
+  BinLogValue() : u(0) {}
+
+  /**
+   * @brief Get field value as a double, regardless of its type.
+   * @return Field value as a double.
+   */
+  double toDouble() const;
+  /**
+   * @brief Get field value as a string, with full precision.
+   * @return Field value as a string.
+   */
+  QString toString() const;
+};
+
+/**
+ * @brief A structure holding a decoded record.
+ */
+struct BinLogRecord
+{
+  size_t schema_index = 0;               /**< Index of record schema within schemas. */
+  double timestamp    = 0.0;             /**< [sec] Record timestamp. */
+  std::vector<BinLogValue> values;       /**< Decoded fields, in schema order. */
+  size_t items_num = 0;                  /**< Number of group items. */
+  std::vector<BinLogValue> items_values; /**< Decoded items fields, item after item. */
+};
+
+/**
+ * @brief A writer of binary log files.
+ *
+ * Records are encoded into an internal buffer, which is written onto file only when it
+ * grows large or on explicit flush(), so that very few system calls are made.
+ * @note This class is not thread safe.
+ */
+class BinaryLogWriter
+{
+ public:
+  /**
+   * @brief Full constructor.
+   * @param[in] filepath Destination file path. Missing directories are created on open.
+   * @param[in] schemas Schemas of all message types which can be logged.
+   */
+  BinaryLogWriter(const QString& filepath, const std::vector<BinLogSchema>& schemas);
+  ~BinaryLogWriter();
+
+  /**
+   * @brief Get destination file path.
+   * @return Destination file path.
+   */
+  QString filepath() const { return file_.fileName(); }
+
+  /**
+   * @brief Open destination file, discarding any previous content, and write header.
+   * @return _True_ if file was opened successfully, _false_ otherwise.
+   */
+  bool open();
+  /**
+   * @brief Flush and close destination file.
+   */
+  void close();
+  /**
+   * @brief Check if destination file is open.
+   * @return _True_ if destination file is open, _false_ otherwise.
+   */
+  bool isOpen() const { return file_.isOpen(); }
+
+  /**
+   * @brief Log a message.
+   * @param[in] msg_type Message type ID, which must match one of the schemas.
+   * @param[in] timestamp [sec] Message timestamp.
+   * @param[in] body Pointer to message body, whose fields are located according to the
+   * offsets of corresponding schema.
+   * @return _True_ if message was encoded, _false_ if its type is unknown or file is not
+   * open.
+   */
+  bool write(const quint32 msg_type, const double timestamp, const void* body);
+  /**
+   * @brief Write any buffered record onto file.
+   * @return _True_ if buffered records were written successfully, _false_ otherwise.
+   */
+  bool flush();
+  /**
+   * @brief Discard any buffered or written record, leaving only the header on file.
+   * @return _True_ if file was reset successfully, _false_ otherwise.
+   */
+  bool reset();
+
+ private:
+  static constexpr int kFlushThresholdBytes_ = 1 << 16;
+
+  QFile file_;
+  std::vector<BinLogSchema> schemas_;
+  QHash<quint32, size_t> schema_index_;
+  QByteArray buffer_;
+
+  bool writeHeader();
+};
+
+/**
+ * @brief A reader of binary log files.
+ */
+class BinaryLogReader
+{
+ public:
+  /**
+   * @brief Open a log file and parse its header.
+   * @param[in] filepath Source file path.
+   * @return _True_ if file was opened and its header is valid, _false_ otherwise.
+   * @see errorString()
+   */
+  bool open(const QString& filepath);
+  /**
+   * @brief Close source file.
+   */
+  void close() { file_.close(); }
+
+  /**
+   * @brief Get the format version of the open file.
+   * @return The format version of the open file.
+   * @note Files with a newer format version than kBinLogFormatVersion are rejected.
+   */
+  quint16 fileFormatVersion() const { return file_version_; }
+  /**
+   * @brief Get the schemas declared in the open file.
+   * @return The schemas declared in the open file.
+   */
+  const std::vector<BinLogSchema>& schemas() const { return schemas_; }
+  /**
+   * @brief Get a description of last error.
+   * @return A description of last error.
+   */
+  const QString& errorString() const { return error_str_; }
+
+  /**
+   * @brief Read next record.
+   * @param[out] record Decoded record. Its buffers are reused across calls.
+   * @return _True_ if a record was read, _false_ at the end of file or if file is
+   * corrupted.
+   * @see errorString()
+   */
+  bool readNext(BinLogRecord& record);
+
+ private:
+  QFile file_;
+  quint16 file_version_ = 0;
+  std::vector<BinLogSchema> schemas_;
+  QHash<quint32, size_t> schema_index_;
+  QByteArray record_;
+  QString error_str_;
+
+  bool readHeader();
+  bool readFields(const QString& schema_name, std::vector<BinLogField>& fields);
+};
+
+#endif // CABLE_ROBOT_BINARY_LOG_H
@@ -9,53 +9,35 @@
 #ifndef CABLE_ROBOT_EASYLOG_WRAPPER_H
 #define CABLE_ROBOT_EASYLOG_WRAPPER_H
 
-#include <QCoreApplication>
-#include <QMutex>
+#include <QFile>
 #include <QThread>
-#include <QWaitCondition>
+
+#include <atomic>
 
 #include "easylogging++.h"
 
+#include "utils/binary_log.h"
 #include "utils/msgs.h"
+#include "utils/spsc_ring_buffer.h"
+#include "utils/tracer.h"
 #include "utils/types.h"
 
-//---------------------- MESSAGE LOG FUNCTIONS ---------------------------------------//
-
-/**
- * @brief Log MotorStatusMsg.
- * @param[in] data_logger Pointer to easylogger employed.
- * @param[in] msg Motor status message to be logged.
- */
-void LogMotorStatusMsg(el::Logger* data_logger, const MotorStatusMsg& msg);
-/**
- * @brief Log WinchStatusMsg.
- * @param[in] data_logger Pointer to easylogger employed.
- * @param[in] msg Winch status message to be logged.
- */
-void LogWinchStatusMsg(el::Logger* data_logger, const WinchStatusMsg& msg);
 /**
- * @brief Log ActuatorStatusMsg.
- * @param[in] data_logger Pointer to easylogger employed.
- * @param[in] msg Actuator status message to be logged.
- */
-void LogActuatorStatusMsg(el::Logger* data_logger, const ActuatorStatusMsg& msg);
-
-// ... add new message log function declaration here
-
-/**
- * @brief A log buffer to log data using easylogging++ in a thread safe way.
+ * @brief A log buffer to log data onto a binary file in a thread safe way.
+ *
+ * Logging takes some time, which can be critical in real time thread with short cycle
+ * periods. To account for this, this log buffer has been developed.
+ * Messages are copied as fixed-size records into a preallocated lock-free ring buffer,
+ * which never blocks nor allocates on the producer side, and are dumped onto the log file
+ * in batches by this thread whenever it can, without clogging the more demanding source
+ * thread. If the ring buffer is full, new messages are dropped and a warning is logged.
  *
- * Logging, despite being made very easy thanks to easylogging++ package, still takes some
- * time, which can be critical in real time thread with short cycle periods.
- * To account for this, this log buffer has been developed.
- * It takes serialized information, which are thus received and copied very fast at high
- * rates, and dumps them onto the log file whenever it can, without clogging the more
- * demanding source thread.
+ * Data is stored in the compact binary format described in binary_log.h, which can be
+ * converted to CSV files offline with the _log_converter_ tool.
  *
- * @note To the developer: the queued message needs to be serialized, have a _deserialize_
- * option and for each message a new message-specific log function must be present, such
- * as LogActuatorStatusMsg. Moreover a new case to LogData private function must be add,
- * with the new message enum value.
+ * @warning The ring buffer supports a single producer at a time: calls to push() from
+ * different threads must be serialized, e.g. by holding the real-time thread mutex.
+ * @note To the developer: new messages only need to be declared in MSG_LIST.
  */
 class LogBuffer: public QThread
 {
@@ -63,52 +45,65 @@ class LogBuffer: public QThread
  public:
   /**
    * @brief LogBuffer constructor.
-   * @param[in] data_logger Pointer to easylogger employed.
-   * @param[in] buffer_size Maximum buffer size, i.e. maximum queued messages number.
+   * @param[in] filepath Binary data log file path.
+   * @param[in] buffer_size Minimum buffer size, i.e. maximum queued messages number.
    */
-  LogBuffer(el::Logger* data_logger, const size_t buffer_size = 2000)
-    : logger_(data_logger), stop_requested_(false),
-      buffer_(buffer_size, QByteArray(static_cast<int>(kMaxMsgSize), 0)), circular_cnt_(0)
+  LogBuffer(const QString& filepath, const size_t buffer_size = 16384)
+    : writer_(filepath, MsgSchemas()), stop_requested_(false), flush_requested_(false),
+      ring_(buffer_size), batch_(kBatchSize_), reported_drops_num_(0)
   {}
 
+  template <class MsgT>
+  /**
+   * @brief Queue a message to be logged.
+   *
+   * This function is lock-free and does not allocate, so it can be safely called within
+   * the real-time thread.
+   * @param[in] msg The message to be logged.
+   * @return _True_ if message was queued, _false_ if it was dropped because buffer is
+   * full.
+   */
+  bool push(const MsgT& msg)
+  {
+    MsgRecord record;
+    MsgToRecord(msg, record);
+    return ring_.TryPush(record);
+  }
+
+  /**
+   * @brief Get the number of messages dropped so far because buffer was full.
+   * @return The number of dropped messages.
+   */
+  size_t droppedNum() const { return ring_.DroppedNum(); }
+
   /**
    * @brief Flush data log up to now.
+   *
+   * All messages logged or queued so far are discarded, leaving an empty data log.
+   * This function returns once the request has been served by the logging thread.
    */
   void flush();
 
   /**
    * @brief Stop logging command.
+   *
+   * All messages queued so far are logged before the thread quits.
    */
   void stop();
 
- public slots:
-  /**
-   * @brief Collect an incoming message to be logged.
-   * @param[in] msg The serialized message to be logged
-   */
-  void collectMsg(QByteArray msg);
-
  private:
-  el::Logger* logger_ = nullptr;
+  static constexpr size_t kBatchSize_            = 256;
+  static constexpr unsigned long kIdleSleepUsec_ = 1000;
 
-  QMutex mutex_;
-  QWaitCondition buffer_not_empty;
-  QWaitCondition buffer_not_full;
-  bool stop_requested_;
+  BinaryLogWriter writer_;
+  std::atomic<bool> stop_requested_;
+  std::atomic<bool> flush_requested_;
 
-  std::vector<QByteArray> buffer_;
-  quint16 circular_cnt_;
-
-  HeaderMsg header_;
-  // Full messages
-  MotorStatusMsg motor_status_;
-  WinchStatusMsg winch_status_;
-  ActuatorStatusMsg actuator_status_;
-  // ... add new message here
+  SpscRingBuffer<MsgRecord> ring_;
+  vect<MsgRecord> batch_;
+  size_t reported_drops_num_;
 
   void run() override;
-
-  void logData(const quint16 index);
 };
 
 #endif // CABLE_ROBOT_EASYLOG_WRAPPER_H
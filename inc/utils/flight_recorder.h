@@ -0,0 +1,146 @@
+/**
+ * @file flight_recorder.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing an always-on in-memory recorder of real-time cycles, which dumps
+ * the cycles around a trigger event onto a binary log file.
+ */
+
+#ifndef CABLE_ROBOT_FLIGHT_RECORDER_H
+#define CABLE_ROBOT_FLIGHT_RECORDER_H
+
+#include <QThread>
+
+#include <atomic>
+
+#include "easylogging++.h"
+
+#include "utils/binary_log.h"
+#include "utils/msgs.h"
+#include "utils/tracer.h"
+#include "utils/types.h"
+
+/**
+ * @brief A single real-time cycle as stored by the flight recorder, in wire format.
+ */
+struct FlightRecorderEntry
+{
+  double timestamp;                     /**< [sec] Cycle timestamp. */
+  ActuatorsFrameWire actuators;         /**< Status of all active actuators. */
+  ControlActionsFrameWire ctrl_actions; /**< Control actions applied in the cycle. */
+};
+
+/**
+ * @brief An always-on, fixed-memory circular recorder of real-time cycles.
+ *
+ * Every cycle the full actuators status and applied control actions are copied into a
+ * circular buffer allocated once at construction, holding the latest _pre_cycles_ +
+ * _post_cycles_ cycles. Recording neither locks nor allocates nor makes any system call,
+ * so Record() can be called at every cycle of the real-time thread.
+ *
+ * When a trigger occurs, for instance upon a drive fault, recording goes on for
+ * _post_cycles_ more cycles and then the buffer is frozen, so that it holds the window
+ * of cycles around the trigger event. The frozen window is then dumped asynchronously by
+ * this thread onto a binary log file in the format described in binary_log.h, after
+ * which recording resumes. Triggers occurring while a window is being captured or dumped
+ * are ignored, since the event is already covered.
+ *
+ * @warning Record() must be called by a single thread only, i.e. the real-time one.
+ */
+class FlightRecorder: public QThread
+{
+  Q_OBJECT
+ public:
+  /**
+   * @brief Possible trigger reasons, reported in the dump file name.
+   */
+  enum TriggerReason : int
+  {
+    MANUAL,
+    DRIVE_FAULT,
+    ROBOT_ERROR
+  };
+
+  /**
+   * @brief FlightRecorder constructor.
+   * @param[in] dir Directory where dump files are written.
+   * @param[in] pre_cycles Number of cycles to be kept before the trigger event.
+   * @param[in] post_cycles Number of cycles to be recorded after the trigger event.
+   */
+  FlightRecorder(const QString& dir, const size_t pre_cycles, const size_t post_cycles);
+
+  /**
+   * @brief Record a real-time cycle.
+   *
+   * This function is lock-free and does not allocate, so it can be safely called within
+   * the real-time thread.
+   * @param[in] timestamp [sec] Cycle timestamp.
+   * @param[in] actuators Status of all active actuators.
+   * @param[in] ctrl_actions Control actions applied in the cycle.
+   */
+  void Record(const double timestamp, const ActuatorsFrame& actuators,
+              const ControlActionsFrame& ctrl_actions);
+
+  /**
+   * @brief Trigger the capture of the current window of cycles.
+   *
+   * This function is lock-free, so it can be called from any thread, including the
+   * real-time one. The trigger is served at next recorded cycle.
+   * @param[in] reason The trigger reason.
+   */
+  void Trigger(const TriggerReason reason);
+
+  /**
+   * @brief Stop dumping thread.
+   *
+   * A window already frozen is dumped before the thread quits.
+   */
+  void stop();
+
+ signals:
+  /**
+   * @brief Signal including the path of a newly written dump file.
+   */
+  void dumpReady(const QString&) const;
+
+  /**
+   * @brief Signal including a message to any QConsole, for instance a QTextBrowser.
+   */
+  void printToQConsole(const QString&) const;
+
+ private:
+  enum RecorderState : int
+  {
+    RECORDING,
+    TRIGGERED,
+    FROZEN
+  };
+
+  static constexpr int kNoRequest_               = -1;
+  static constexpr unsigned long kIdleSleepUsec_ = 10000;
+  // clang-format off
+  static constexpr char* kReasonsStr_[] = {
+    const_cast<char*>("manual"),
+    const_cast<char*>("drive_fault"),
+    const_cast<char*>("robot_error")};
+  // clang-format on
+
+  QString dir_;
+  size_t post_cycles_;
+  vect<FlightRecorderEntry> entries_;
+
+  // Owned by real-time thread while recording, by this thread while frozen.
+  size_t head_           = 0; // index of next entry to be written
+  size_t recorded_num_   = 0; // entries recorded since last dump
+  size_t post_countdown_ = 0;
+  TriggerReason reason_  = MANUAL;
+
+  std::atomic<int> state_;
+  std::atomic<int> requested_reason_;
+  std::atomic<bool> stop_requested_;
+
+  void run() override;
+  void Dump();
+};
+
+#endif // CABLE_ROBOT_FLIGHT_RECORDER_H
@@ -0,0 +1,27 @@
+/**
+ * @file linear_system.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a solver of small dense linear systems, shared by offline
+ * analyses.
+ */
+
+#ifndef CABLE_ROBOT_LINEAR_SYSTEM_H
+#define CABLE_ROBOT_LINEAR_SYSTEM_H
+
+#include <stddef.h>
+
+#include "utils/types.h"
+
+/**
+ * @brief Solve a small dense linear system with Gaussian elimination and partial
+ * pivoting.
+ * @param[in,out] M Row-major square matrix of size _k_, overwritten.
+ * @param[in,out] v Right-hand side of size _k_, overwritten with the solution.
+ * @param[in] k System size.
+ * @return _True_ if system is not singular, i.e. no pivot is smaller than 1e-12 in
+ * absolute value, _false_ otherwise.
+ */
+bool SolveLinearSystem(vectD& M, vectD& v, const size_t k);
+
+#endif // CABLE_ROBOT_LINEAR_SYSTEM_H
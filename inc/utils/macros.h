@@ -10,19 +10,56 @@
 
 #include "grabcommon.h"
 
-//---------------------- DECLARATIONS ------------------------------------------------//
+//---------------------- MESSAGE GENERATORS ------------------------------------------//
+
+// Each message is declared once in msgs.h as an entry of MSG_LIST, in the form
+// _X(_MSG_TYPE, _BodyType, _FIELDS), where _FIELDS(_F) expands to _F(field) for each
+// body field to be logged. The generators below are applied to every entry.
 
 // @cond DO_NOT_DOCUMENT
-#ifndef MSG_SERIALIZATION_DECLARE
-#define MSG_SERIALIZATION_DECLARE(_MsgType)                                              \
-  QDataStream& operator<<(QDataStream& ostream, const _MsgType& data);                   \
-  QDataStream& operator>>(QDataStream& istream, _MsgType& data);                         \
-  QByteArray serialize(const _MsgType##Msg& data);
-#endif
 
+// Actions on single fields (WHAT)
+#define MSG_WIRE_FIELD_(_field) decltype(Body::_field) _field;
+#define MSG_WIRE_FIELD_SIZE_(_field) +sizeof(Body::_field)
+#define MSG_ENCODE_FIELD_(_field) wire._field = body._field;
+#define MSG_DECODE_FIELD_(_field) body._field = wire._field;
+#define MSG_SCHEMA_FIELD_(_field)                                                        \
+  BinLogField(#_field, BinLogFieldTypeOf<decltype(Wire::_field)>::value,                 \
+              offsetof(Wire, _field)),
+
+// Actions on whole messages (HOW)
+#define MSG_ENUM_ENTRY(_MSG_TYPE, _BodyType, _FIELDS) _MSG_TYPE,
+
+#define MSG_WIRE_SIZE(_MSG_TYPE, _BodyType, _FIELDS) , sizeof(_BodyType##Wire)
+
+#define MSG_WIRE_STRUCT_DECLARE(_MSG_TYPE, _BodyType, _FIELDS)                           \
+  struct _BodyType##Wire                                                                 \
+  {                                                                                      \
+    typedef _BodyType Body;                                                              \
+    _FIELDS(MSG_WIRE_FIELD_)                                                             \
+  };
+
+#define MSG_TRAITS_DECLARE(_MSG_TYPE, _BodyType, _FIELDS)                                \
+  template <> struct MsgTraits<_BodyType>                                                \
+  {                                                                                      \
+    typedef _BodyType Body;                                                              \
+    typedef _BodyType##Wire Wire;                                                        \
+    static_assert(std::is_trivially_copyable<Wire>::value,                               \
+                  #_BodyType "Wire must be trivially copyable");                         \
+    static_assert(std::is_standard_layout<Wire>::value,                                  \
+                  #_BodyType "Wire must be standard layout");                            \
+    static_assert(sizeof(Wire) == 0 _FIELDS(MSG_WIRE_FIELD_SIZE_),                       \
+                  #_BodyType "Wire must be packed");                                     \
+    static constexpr MsgType Type() { return _MSG_TYPE; }                                \
+    static void Encode(const _BodyType& body, Wire& wire) { _FIELDS(MSG_ENCODE_FIELD_) } \
+    static void Decode(const Wire& wire, _BodyType& body) { _FIELDS(MSG_DECODE_FIELD_) } \
+    static BinLogSchema Schema()                                                         \
+    {                                                                                    \
+      return BinLogSchema(_MSG_TYPE, #_BodyType, {_FIELDS(MSG_SCHEMA_FIELD_)});          \
+    }                                                                                    \
+  };
 
-#ifndef MSG_STRUCT_DECLARE
-#define MSG_STRUCT_DECLARE(_MSG_TYPE, _BodyType)                                         \
+#define MSG_STRUCT_DECLARE(_MSG_TYPE, _BodyType, _FIELDS)                                \
   struct _BodyType##Msg: BaseMsg                                                         \
   {                                                                                      \
     _BodyType##Msg() : BaseMsg(_MSG_TYPE) {}                                             \
@@ -30,58 +67,77 @@
     _BodyType##Msg(const double time_sec, const _BodyType& data)                         \
       : BaseMsg(time_sec, _MSG_TYPE), body(data)                                         \
     {}                                                                                   \
-    _BodyType##Msg(const QByteArray data) : BaseMsg(_MSG_TYPE) { deserialize(data); }    \
-    QByteArray serialized() const;                                                       \
-    void deserialize(QByteArray data);                                                   \
     _BodyType body;                                                                      \
   };
-#endif
 
-//---------------------- DEFINITIONS -------------------------------------------------//
+#define MSG_SCHEMA_ENTRY(_MSG_TYPE, _BodyType, _FIELDS) MsgTraits<_BodyType>::Schema(),
 
-// Actions (WHAT)
-#define OSTREAM_MSG_FIELD(_field) << data._field
-#define ISTREAM_MSG_FIELD(_field) >> data._field
+// Frames are declared in msgs.h as entries of MSG_FRAME_LIST, in the form
+// _X(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS), where _ItemType is a message
+// body declared in MSG_LIST and _FrameType has, besides _FIELDS, an array _ITEMS of
+// _ItemType and a uint8_t counter _ITEMS_num of its valid elements.
 
-#ifndef MSG_FIELDS_ORDER_DEFINE
-#define MSG_FIELDS_ORDER_DEFINE(_MsgType, ...)                                           \
-  QDataStream& operator<<(QDataStream& ostream, const _MsgType& data)                    \
-  {                                                                                      \
-    return ostream FOR_EACH(OSTREAM_MSG_FIELD, __VA_ARGS__);                             \
-  }                                                                                      \
-                                                                                         \
-  QDataStream& operator>>(QDataStream& istream, _MsgType& data)                          \
-  {                                                                                      \
-    istream FOR_EACH(ISTREAM_MSG_FIELD, __VA_ARGS__);                                    \
-    return istream;                                                                      \
-  }
-#endif
-
-#ifndef MSG_SERIALIZATION_DEFINE
-#define MSG_SERIALIZATION_DEFINE(_MSG_TYPE, _BodyType)                                   \
-  QByteArray _BodyType##Msg::serialized() const { return serialize(*this); }             \
-                                                                                         \
-  void _BodyType##Msg::deserialize(QByteArray data)                                      \
+#define MSG_FRAME_ENUM_ENTRY(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS) _MSG_TYPE,
+
+#define MSG_FRAME_WIRE_SIZE(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS)           \
+  , sizeof(_FrameType##Wire)
+
+#define MSG_FRAME_WIRE_STRUCT_DECLARE(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS) \
+  struct _FrameType##Wire                                                                \
   {                                                                                      \
-    QDataStream stream(&data, QIODevice::ReadOnly);                                      \
-    stream.setVersion(QDataStream::Qt_4_5);                                              \
-    HeaderMsg tmp_header;                                                                \
-    stream >> tmp_header;                                                                \
-    if (header.msg_type != _MSG_TYPE)                                                    \
-      return;                                                                            \
-    stream >> body;                                                                      \
-    header = tmp_header;                                                                 \
-  }                                                                                      \
-                                                                                         \
-  QByteArray serialize(const _BodyType##Msg& data)                                       \
+    typedef _FrameType Body;                                                             \
+    _FIELDS(MSG_WIRE_FIELD_)                                                             \
+    uint8_t _ITEMS##_num;                                                                \
+    _ItemType##Wire _ITEMS[std::extent<decltype(Body::_ITEMS)>::value];                  \
+  };
+
+#define MSG_FRAME_TRAITS_DECLARE(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS)      \
+  template <> struct MsgTraits<_FrameType>                                               \
   {                                                                                      \
-    QByteArray buf;                                                                      \
-    QDataStream strm(&buf, QIODevice::WriteOnly);                                        \
-    strm.setVersion(QDataStream::Qt_4_5);                                                \
-    strm << data.header << data.body;                                                    \
-    return buf;                                                                          \
-  }
-#endif
+    typedef _FrameType Body;                                                             \
+    typedef _FrameType##Wire Wire;                                                       \
+    typedef MsgTraits<_ItemType> ItemTraits;                                             \
+    static_assert(std::is_trivially_copyable<Wire>::value,                               \
+                  #_FrameType "Wire must be trivially copyable");                        \
+    static_assert(std::is_standard_layout<Wire>::value,                                  \
+                  #_FrameType "Wire must be standard layout");                           \
+    static_assert(std::is_same<decltype(Body::_ITEMS##_num), uint8_t>::value,            \
+                  #_FrameType " items counter must be uint8_t");                         \
+    static constexpr MsgType Type() { return _MSG_TYPE; }                                \
+    static constexpr size_t MaxItems()                                                   \
+    {                                                                                    \
+      return std::extent<decltype(Body::_ITEMS)>::value;                                 \
+    }                                                                                    \
+    static void Encode(const Body& body, Wire& wire)                                     \
+    {                                                                                    \
+      _FIELDS(MSG_ENCODE_FIELD_)                                                         \
+      wire._ITEMS##_num = static_cast<uint8_t>(                                          \
+        body._ITEMS##_num < MaxItems() ? body._ITEMS##_num : MaxItems());                \
+      for (size_t i = 0; i < wire._ITEMS##_num; i++)                                     \
+        ItemTraits::Encode(body._ITEMS[i], wire._ITEMS[i]);                              \
+    }                                                                                    \
+    static void Decode(const Wire& wire, Body& body)                                     \
+    {                                                                                    \
+      _FIELDS(MSG_DECODE_FIELD_)                                                         \
+      body._ITEMS##_num = wire._ITEMS##_num;                                             \
+      for (size_t i = 0; i < wire._ITEMS##_num; i++)                                     \
+        ItemTraits::Decode(wire._ITEMS[i], body._ITEMS[i]);                              \
+    }                                                                                    \
+    static BinLogSchema Schema()                                                         \
+    {                                                                                    \
+      return BinLogSchema(_MSG_TYPE, #_FrameType, {_FIELDS(MSG_SCHEMA_FIELD_)},          \
+                          BinLogGroup(#_ITEMS, ItemTraits::Schema().fields,              \
+                                      offsetof(Wire, _ITEMS##_num),                      \
+                                      offsetof(Wire, _ITEMS), sizeof(_ItemType##Wire))); \
+    }                                                                                    \
+  };
+
+#define MSG_FRAME_STRUCT_DECLARE(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS)      \
+  MSG_STRUCT_DECLARE(_MSG_TYPE, _FrameType, _FIELDS)
+
+#define MSG_FRAME_SCHEMA_ENTRY(_MSG_TYPE, _FrameType, _FIELDS, _ItemType, _ITEMS)        \
+  MSG_SCHEMA_ENTRY(_MSG_TYPE, _FrameType, _FIELDS)
+
 // @endcond
 
 #endif // CABLE_ROBOT_MACROS_H
@@ -8,23 +8,69 @@
 #ifndef CABLE_ROBOT_MSGS_H
 #define CABLE_ROBOT_MSGS_H
 
-#include <QDataStream>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
 
+#include "ctrl/controller_base.h"
+#include "utils/binary_log.h"
 #include "utils/macros.h"
 #include "utils/types.h"
 
 //----------------------  MESSAGE LIST -----------------------------------------------//
 
+// clang-format off
+// @cond DO_NOT_DOCUMENT
+#define MOTOR_STATUS_FIELDS(_F)                                                          \
+  _F(id) _F(op_mode) _F(motor_position) _F(motor_speed) _F(motor_torque)
+#define WINCH_STATUS_FIELDS(_F)                                                          \
+  MOTOR_STATUS_FIELDS(_F) _F(cable_length) _F(aux_position)
+#define ACTUATOR_STATUS_FIELDS(_F)                                                       \
+  WINCH_STATUS_FIELDS(_F) _F(state) _F(pulley_angle)
+#define CONTROL_ACTION_FIELDS(_F)                                                        \
+  _F(motor_id) _F(ctrl_mode) _F(cable_length) _F(motor_position) _F(motor_speed)       \
+  _F(motor_torque)
+#define ACTUATORS_FRAME_FIELDS(_F) _F(cycle_count)
+#define CONTROL_ACTIONS_FRAME_FIELDS(_F) _F(cycle_count)
+// ... add new message fields list here, e.g.
+// #define MY_TYPE_FIELDS(_F) _F(field1) _F(field2) ...
+// @endcond
+
+/**
+ * @brief The list of available loggable messages.
+ *
+ * This is the only place where a message is declared: each entry yields the message type
+ * enum value, a packed wire structure with the logged fields, encode/decode functions,
+ * its binary log schema and its full message structure _BodyTypeMsg.
+ * Fields are logged in the order given by the fields list of each entry.
+ */
+#define MSG_LIST(_X)                                                                     \
+  _X(MOTOR_STATUS,    MotorStatus,    MOTOR_STATUS_FIELDS)                               \
+  _X(WINCH_STATUS,    WinchStatus,    WINCH_STATUS_FIELDS)                               \
+  _X(ACTUATOR_STATUS, ActuatorStatus, ACTUATOR_STATUS_FIELDS)                            \
+  _X(CONTROL_ACTION,  ControlAction,  CONTROL_ACTION_FIELDS)
+  // ... add new message here, e.g. _X(MY_TYPE, MyTypeStruct, MY_TYPE_FIELDS)
+
+/**
+ * @brief The list of available loggable frames.
+ *
+ * A frame is a message collecting several items of the same type, declared in MSG_LIST,
+ * together with a few fields in common. Only valid items are logged.
+ */
+#define MSG_FRAME_LIST(_X)                                                               \
+  _X(ACTUATORS_FRAME, ActuatorsFrame, ACTUATORS_FRAME_FIELDS, ActuatorStatus, actuators) \
+  _X(CONTROL_ACTIONS_FRAME, ControlActionsFrame, CONTROL_ACTIONS_FRAME_FIELDS,           \
+     ControlAction, actions)
+// clang-format on
+
 /**
  * @brief The list of available loggable message types.
  */
 enum MsgType : quint32
 {
   NULL_MSG,
-  MOTOR_STATUS,
-  WINCH_STATUS,
-  ACTUATOR_STATUS,
-  // ... add new message type here, e.g. MY_TYPE, ...
+  MSG_LIST(MSG_ENUM_ENTRY)
+  MSG_FRAME_LIST(MSG_FRAME_ENUM_ENTRY)
 };
 
 //----------------------  MESSAGE HEADER ---------------------------------------------//
@@ -69,21 +115,6 @@ struct HeaderMsg
   MsgType msg_type; /**< Message type. */
 };
 
-/**
- * @brief operator << for serialization of HeaderMsg.
- * @param[out] ostream
- * @param[in] data Header message to be serialized.
- * @return Serialized HeaderMsg.
- */
-QDataStream& operator<<(QDataStream& ostream, const HeaderMsg& data);
-/**
- * @brief operator >> for deserialization of HeaderMsg.
- * @param[in] istream
- * @param[out] data Header message to be filled.
- * @return
- */
-QDataStream& operator>>(QDataStream& istream, HeaderMsg& data);
-
 //----------------------  MESSAGES ---------------------------------------------------//
 
 /**
@@ -111,16 +142,100 @@ struct BaseMsg
   HeaderMsg header; /**< Header message including timestamp and message type. */
 };
 
-extern const size_t kMaxMsgSize; /**< Maximum serialized message size in bytes. */
+MSG_LIST(MSG_STRUCT_DECLARE)
+MSG_FRAME_LIST(MSG_FRAME_STRUCT_DECLARE)
+
+//----------------------  WIRE FORMAT -----------------------------------------------//
+
+// @cond DO_NOT_DOCUMENT
+constexpr size_t MaxOf(const size_t value) { return value; }
+template <typename... Args>
+constexpr size_t MaxOf(const size_t value1, const size_t value2, const Args... values)
+{
+  return MaxOf(value1 > value2 ? value1 : value2, values...);
+}
+// @endcond
+
+#pragma pack(push, 1)
+MSG_LIST(MSG_WIRE_STRUCT_DECLARE)
+MSG_FRAME_LIST(MSG_FRAME_WIRE_STRUCT_DECLARE)
+#pragma pack(pop)
+
+template <class BodyT>
+/**
+ * @brief Compile-time properties of a message body, generated from MSG_LIST.
+ *
+ * Each specialization provides:
+ * - _Wire_: the packed, trivially copyable structure holding the logged fields;
+ * - _Type()_: the message type enum value;
+ * - _Encode()_ and _Decode()_: plain field-by-field copies between body and wire
+ * structures, which neither allocate nor lock;
+ * - _Schema()_: the binary log schema describing the wire structure.
+ */
+struct MsgTraits;
 
-MSG_STRUCT_DECLARE(MOTOR_STATUS, MotorStatus)
-MSG_STRUCT_DECLARE(WINCH_STATUS, WinchStatus)
-MSG_STRUCT_DECLARE(ACTUATOR_STATUS, ActuatorStatus)
-// ... and here, e.g. MSG_STRUCT_DECLARE(MY_TYPE, MyTypeStruct), ...
+MSG_LIST(MSG_TRAITS_DECLARE)
+MSG_FRAME_LIST(MSG_FRAME_TRAITS_DECLARE)
 
-MSG_SERIALIZATION_DECLARE(MotorStatus)
-MSG_SERIALIZATION_DECLARE(WinchStatus)
-MSG_SERIALIZATION_DECLARE(ActuatorStatus)
-// ... and here, e.g. MSG_SERIALIZATION_DECLARE(MyTypeStruct)
+/**
+ * @brief Maximum message body size in bytes, in wire format.
+ */
+static constexpr size_t kMaxMsgBodySize = MaxOf(0 MSG_LIST(MSG_WIRE_SIZE)
+                                                  MSG_FRAME_LIST(MSG_FRAME_WIRE_SIZE));
+
+/**
+ * @brief Maximum logged message size in bytes, including type and timestamp.
+ */
+static constexpr size_t kMaxMsgSize = sizeof(quint32) + sizeof(double) + kMaxMsgBodySize;
+
+/**
+ * @brief A fixed-size, trivially copyable record able to hold any loggable message.
+ *
+ * Records are used to pass messages between threads by plain copy, without any
+ * serialization or allocation. Message body is stored in wire format.
+ * @see MsgToRecord() RecordToMsg()
+ */
+struct MsgRecord
+{
+  HeaderMsg header;            /**< Header message including timestamp and type. */
+  uchar body[kMaxMsgBodySize]; /**< Message body in wire format. */
+};
+
+template <class MsgT>
+/**
+ * @brief Encode a message into a record.
+ * @param[in] msg Message to be encoded.
+ * @param[out] record Destination record.
+ */
+inline void MsgToRecord(const MsgT& msg, MsgRecord& record)
+{
+  typedef MsgTraits<decltype(msg.body)> Traits;
+  typename Traits::Wire wire;
+  Traits::Encode(msg.body, wire);
+  record.header = msg.header;
+  memcpy(record.body, &wire, sizeof(wire));
+}
+
+template <class MsgT>
+/**
+ * @brief Decode a record into a message.
+ * @param[in] record Source record, whose type must match the destination message.
+ * @param[out] msg Destination message.
+ */
+inline void RecordToMsg(const MsgRecord& record, MsgT& msg)
+{
+  typedef MsgTraits<decltype(msg.body)> Traits;
+  typename Traits::Wire wire;
+  memcpy(&wire, record.body, sizeof(wire));
+  Traits::Decode(wire, msg.body);
+  msg.header = record.header;
+}
+
+/**
+ * @brief Get the binary log schemas of all loggable messages.
+ * @return The binary log schemas of all loggable messages, one per message type.
+ * @see BinaryLogWriter
+ */
+const vect<BinLogSchema>& MsgSchemas();
 
 #endif // CABLE_ROBOT_MSGS_H
@@ -0,0 +1,142 @@
+/**
+ * @file spsc_ring_buffer.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing the implementation of a lock-free single-producer
+ * single-consumer ring buffer.
+ */
+
+#ifndef CABLE_ROBOT_SPSC_RING_BUFFER_H
+#define CABLE_ROBOT_SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+/**
+ * @brief A lock-free, wait-free single-producer single-consumer ring buffer.
+ *
+ * All the storage is allocated at construction, so that neither pushing nor popping
+ * allocate, lock or make any system call. This makes TryPush() safe to be called within
+ * the real-time thread.
+ *
+ * Only one thread at a time may push and only one thread at a time may pop. Several
+ * producer threads are allowed as long as they are serialized by an external mutex,
+ * which also provides the necessary memory ordering between them.
+ *
+ * When the buffer is full new items are dropped rather than blocking the producer. The
+ * number of dropped items can be inquired with DroppedNum().
+ */
+class SpscRingBuffer
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscRingBuffer item type must be trivially copyable");
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param[in] min_capacity Minimum buffer capacity, rounded up to the next power of two.
+   */
+  explicit SpscRingBuffer(const size_t min_capacity)
+    : head_(0), tail_(0), dropped_(0)
+  {
+    size_t capacity = 2;
+    while (capacity < min_capacity)
+      capacity <<= 1;
+    mask_ = capacity - 1;
+    buffer_.resize(capacity);
+  }
+
+  /**
+   * @brief Get buffer capacity.
+   * @return The maximum number of items the buffer can hold.
+   */
+  size_t Capacity() const { return mask_ + 1; }
+  /**
+   * @brief Get an estimate of the number of items currently held by the buffer.
+   * @return The number of items currently held by the buffer.
+   */
+  size_t Size() const
+  {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  /**
+   * @brief Check if buffer is empty.
+   * @return _True_ if buffer is empty, _false_ otherwise.
+   */
+  bool Empty() const { return Size() == 0; }
+  /**
+   * @brief Get the number of items dropped so far because buffer was full.
+   * @return The number of dropped items.
+   */
+  size_t DroppedNum() const { return dropped_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Push an item, to be called by the producer only.
+   * @param[in] item The item to be pushed.
+   * @return _True_ if item was pushed, _false_ if buffer was full and item was dropped.
+   */
+  bool TryPush(const T& item)
+  {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ > mask_)
+    {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ > mask_)
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    buffer_[head & mask_] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pop up to a given number of items at once, to be called by the consumer only.
+   * @param[out] items Destination array, with room for at least _max_items_.
+   * @param[in] max_items Maximum number of items to be popped.
+   * @return The number of items actually popped.
+   */
+  size_t PopBatch(T* items, const size_t max_items)
+  {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (cached_head_ == tail)
+      cached_head_ = head_.load(std::memory_order_acquire);
+    size_t count = cached_head_ - tail;
+    if (count > max_items)
+      count = max_items;
+    for (size_t i = 0; i < count; i++)
+      items[i] = buffer_[(tail + i) & mask_];
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Discard all items currently in the buffer, to be called by the consumer only.
+   */
+  void Clear()
+  {
+    cached_head_ = head_.load(std::memory_order_acquire);
+    tail_.store(cached_head_, std::memory_order_release);
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize_ = 64;
+
+  // Producer and consumer indexes live on separate cache lines to avoid false sharing.
+  std::atomic<size_t> head_;
+  size_t cached_tail_ = 0; // producer-side copy of tail_
+  char pad0_[kCacheLineSize_ - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+  std::atomic<size_t> tail_;
+  size_t cached_head_ = 0; // consumer-side copy of head_
+  char pad1_[kCacheLineSize_ - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+  std::atomic<size_t> dropped_;
+  size_t mask_;
+  std::vector<T> buffer_;
+};
+
+#endif // CABLE_ROBOT_SPSC_RING_BUFFER_H
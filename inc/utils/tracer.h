@@ -0,0 +1,189 @@
+/**
+ * @file tracer.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a low-overhead tracing facility recording timed spans, which can
+ * be exported in Chrome trace format.
+ *
+ * Spans are recorded with the macros below, which compile to nothing unless
+ * ENABLE_TRACING is set to 1 in the project file:
+ * - TRACE_SCOPE(category, name) records a span lasting until the end of current scope;
+ * - TRACE_STATE(track, state) records, on a dedicated TraceTrack, a span for each state
+ * of a state machine, from its entry to the entry of the next one;
+ * - TRACE_THREAD_NAME(name) labels the calling thread in the exported trace.
+ *
+ * Names and categories must be string literals, or strings with static storage in
+ * general, since only their pointers are stored.
+ *
+ * Each thread records onto its own preallocated circular buffer, holding its latest
+ * spans, so that recording a span never locks nor allocates, except for the very first
+ * span of each thread. The exported JSON file can be opened with _chrome://tracing_ or
+ * _ui.perfetto.dev_.
+ */
+
+#ifndef CABLE_ROBOT_TRACER_H
+#define CABLE_ROBOT_TRACER_H
+
+#include <QString>
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+#ifndef ENABLE_TRACING
+#define ENABLE_TRACING 0
+#endif
+
+/**
+ * @brief A timed span, as recorded by the tracer.
+ */
+struct TraceEvent
+{
+  const char* category; /**< Span category, e.g. _state_ or _wait_. */
+  const char* name;     /**< Span name. */
+  uint64_t start_nsec;  /**< [nsec] Span start time. */
+  uint64_t dur_nsec;    /**< [nsec] Span duration. */
+  uint32_t track_id;    /**< ID of the thread or track the span belongs to. */
+};
+
+/**
+ * @brief A static-only class collecting spans from all threads and exporting them.
+ *
+ * Tracing must be started with Start() to record any span. Export() must be called
+ * after Stop(), when no more spans are being recorded.
+ */
+class Tracer
+{
+ public:
+  /**
+   * @brief Start a new tracing session, discarding spans of previous ones.
+   */
+  static void Start();
+  /**
+   * @brief Stop current tracing session.
+   */
+  static void Stop();
+  /**
+   * @brief Check if a tracing session is active.
+   * @return _True_ if a tracing session is active, _false_ otherwise.
+   */
+  static bool IsActive() { return active_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Get current monotonic time.
+   * @return [nsec] Current monotonic time.
+   */
+  static uint64_t NowNsec();
+
+  /**
+   * @brief Label the calling thread in the exported trace.
+   * @param[in] name Thread label.
+   */
+  static void SetThreadName(const char* name);
+  /**
+   * @brief Register a new track, i.e. a timeline not bound to any thread.
+   * @param[in] name Track label.
+   * @return The ID of the new track.
+   */
+  static uint32_t RegisterTrack(const std::string& name);
+
+  /**
+   * @brief Record a span onto the buffer of the calling thread.
+   * @param[in] category Span category.
+   * @param[in] name Span name.
+   * @param[in] start_nsec [nsec] Span start time.
+   * @param[in] end_nsec [nsec] Span end time.
+   * @param[in] track_id ID of the track the span belongs to. If 0, the span belongs to
+   * the calling thread.
+   */
+  static void Record(const char* category, const char* name, const uint64_t start_nsec,
+                     const uint64_t end_nsec, const uint32_t track_id = 0);
+
+  /**
+   * @brief Export spans of current session onto a Chrome trace JSON file.
+   * @param[in] filepath Destination file path. Missing directories are created.
+   * @return _True_ if file was written successfully, _false_ otherwise.
+   */
+  static bool Export(const QString& filepath);
+
+ private:
+  static std::atomic<bool> active_;
+  static std::atomic<uint32_t> session_;
+  static std::atomic<uint64_t> session_start_nsec_;
+};
+
+/**
+ * @brief A scoped span, recorded upon destruction if tracing is active.
+ * @see TRACE_SCOPE
+ */
+class TraceScope
+{
+ public:
+  /**
+   * @brief TraceScope constructor, starting the span.
+   * @param[in] category Span category.
+   * @param[in] name Span name.
+   */
+  TraceScope(const char* category, const char* name)
+    : category_(category), name_(name),
+      start_nsec_(Tracer::IsActive() ? Tracer::NowNsec() : 0)
+  {}
+  ~TraceScope()
+  {
+    if (start_nsec_ > 0 && Tracer::IsActive())
+      Tracer::Record(category_, name_, start_nsec_, Tracer::NowNsec());
+  }
+
+ private:
+  const char* category_;
+  const char* name_;
+  uint64_t start_nsec_;
+};
+
+/**
+ * @brief A timeline of the states of a state machine.
+ *
+ * Each state machine instance owns a track, so that its states are shown as consecutive
+ * spans on a dedicated row of the exported trace, regardless of the thread triggering
+ * each transition.
+ * @see TRACE_STATE
+ */
+class TraceTrack
+{
+ public:
+  /**
+   * @brief TraceTrack constructor.
+   * @param[in] name Track label, e.g. the state machine name.
+   */
+  explicit TraceTrack(const std::string& name) : id_(Tracer::RegisterTrack(name)) {}
+
+  /**
+   * @brief Close the span of current state, if any, and open the one of a new state.
+   * @param[in] state New state name.
+   */
+  void Enter(const char* state) const;
+
+ private:
+  uint32_t id_;
+  // Tracking state entries has no effect on the traced object itself.
+  mutable const char* state_         = nullptr;
+  mutable uint64_t state_enter_nsec_ = 0;
+};
+
+// @cond DO_NOT_DOCUMENT
+#define TRACE_CONCAT_(_a, _b) _a##_b
+#define TRACE_CONCAT(_a, _b) TRACE_CONCAT_(_a, _b)
+// @endcond
+
+#if ENABLE_TRACING
+#define TRACE_SCOPE(_category, _name)                                                    \
+  TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(_category, _name)
+#define TRACE_STATE(_track, _state) (_track).Enter(_state)
+#define TRACE_THREAD_NAME(_name) Tracer::SetThreadName(_name)
+#else
+#define TRACE_SCOPE(_category, _name)
+#define TRACE_STATE(_track, _state)
+#define TRACE_THREAD_NAME(_name)
+#endif
+
+#endif // CABLE_ROBOT_TRACER_H
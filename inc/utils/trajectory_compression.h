@@ -0,0 +1,124 @@
+/**
+ * @file trajectory_compression.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing a tolerance-bounded compression of dense trajectories into
+ * piecewise cubic Hermite segments.
+ */
+
+#ifndef CABLE_ROBOT_TRAJECTORY_COMPRESSION_H
+#define CABLE_ROBOT_TRAJECTORY_COMPRESSION_H
+
+#include <type_traits>
+
+#include "utils/types.h"
+
+/**
+ * @brief Outcome of a trajectory compression.
+ */
+struct CompressionReport
+{
+  size_t samples_num      = 0;   /**< Number of samples of the dense trajectory. */
+  size_t knots_num        = 0;   /**< Number of waypoints kept. */
+  size_t dense_bytes      = 0;   /**< Memory held by the dense trajectory. */
+  size_t compressed_bytes = 0;   /**< Memory held by the compressed trajectory. */
+  double max_error        = 0.0; /**< Largest error at dense samples, in value units. */
+
+  /**
+   * @brief Get the compression ratio in terms of memory.
+   * @return The compression ratio, i.e. dense over compressed size.
+   */
+  double Ratio() const
+  {
+    return compressed_bytes > 0 ? static_cast<double>(dense_bytes) / compressed_bytes
+                                : 1.0;
+  }
+
+  /**
+   * @brief Accumulate another report, e.g. of a different motor of the same file.
+   * @param[in] other Report to be accumulated.
+   * @return A reference to this report.
+   */
+  CompressionReport& operator+=(const CompressionReport& other)
+  {
+    samples_num += other.samples_num;
+    knots_num += other.knots_num;
+    dense_bytes += other.dense_bytes;
+    compressed_bytes += other.compressed_bytes;
+    if (other.max_error > max_error)
+      max_error = other.max_error;
+    return *this;
+  }
+};
+
+/**
+ * @brief Select the waypoints of a dense trajectory which make a piecewise cubic Hermite
+ * interpolation of it within given tolerance.
+ *
+ * Velocities at waypoints are estimated by finite differences on dense samples. Then,
+ * starting from the first sample, each segment is greedily stretched to the farthest
+ * sample such that Hermite interpolation between its ends stays within tolerance at
+ * every dense sample in between. The farthest end is bracketed by doubling the segment
+ * length and then refined by bisection.
+ * @param[in] times Strictly increasing timestamps of dense trajectory.
+ * @param[in] values Values of dense trajectory.
+ * @param[in] tolerance Maximum absolute error allowed at dense samples.
+ * @param[in] integral If _True_, interpolated values are truncated to integers before
+ * measuring their error, as it happens when evaluating integral trajectories.
+ * @param[out] knots Indexes of selected waypoints, including first and last sample.
+ * @param[out] velocities Estimated velocities at selected waypoints.
+ * @return The largest interpolation error at dense samples.
+ */
+double SelectHermiteKnots(const vectD& times, const vectD& values, const double tolerance,
+                          const bool integral, vect<size_t>& knots, vectD& velocities);
+
+/**
+ * @brief Compress a dense trajectory into a PVT one within given tolerance.
+ *
+ * The resulting trajectory is made of a subset of original samples, together with their
+ * velocities, so that it is evaluated directly by Trajectory::waypointFromAbsTime.
+ * Trajectories which are already PVT ones, too short or not strictly increasing in time
+ * are left untouched.
+ * @param[in,out] traj Trajectory to be compressed.
+ * @param[in] tolerance Maximum absolute error allowed at dense samples, in value units.
+ * @return The compression report.
+ */
+template <typename T>
+CompressionReport CompressTrajectory(Trajectory<T>& traj, const double tolerance)
+{
+  CompressionReport report;
+  const size_t size    = std::min(traj.timestamps.size(), traj.values.size());
+  report.samples_num   = size;
+  report.knots_num     = size;
+  report.dense_bytes   = size * (sizeof(double) + sizeof(T));
+  report.compressed_bytes =
+    report.dense_bytes + (traj.hasVelocities() ? size * sizeof(double) : 0);
+  if (size < 3 || tolerance <= 0.0 || traj.hasVelocities())
+    return report;
+  for (size_t i = 1; i < size; i++)
+    if (traj.timestamps[i] <= traj.timestamps[i - 1])
+      return report;
+
+  const vectD values(traj.values.begin(), traj.values.begin() + size);
+  vect<size_t> knots;
+  vectD velocities;
+  report.max_error = SelectHermiteKnots(traj.timestamps, values, tolerance,
+                                        std::is_integral<T>::value, knots, velocities);
+
+  vectD timestamps(knots.size());
+  vect<T> knot_values(knots.size());
+  for (size_t i = 0; i < knots.size(); i++)
+  {
+    timestamps[i]  = traj.timestamps[knots[i]];
+    knot_values[i] = traj.values[knots[i]];
+  }
+  traj.timestamps.swap(timestamps);
+  traj.values.swap(knot_values);
+  traj.velocities.swap(velocities);
+
+  report.knots_num        = knots.size();
+  report.compressed_bytes = knots.size() * (2 * sizeof(double) + sizeof(T));
+  return report;
+}
+
+#endif // CABLE_ROBOT_TRAJECTORY_COMPRESSION_H
@@ -0,0 +1,156 @@
+/**
+ * @file trajectory_validation.h
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing the feasibility validation of trajectories, with per-sample
+ * diagnostics.
+ */
+
+#ifndef CABLE_ROBOT_TRAJECTORY_VALIDATION_H
+#define CABLE_ROBOT_TRAJECTORY_VALIDATION_H
+
+#include <limits>
+#include <string>
+
+#include "utils/types.h"
+
+/**
+ * @brief Limits a trajectory must comply with, in its own units.
+ *
+ * Speed and acceleration refer to the first and second time derivatives of trajectory
+ * values, e.g. motor acceleration and jerk for a motor speed trajectory. Since they are
+ * computed by finite differences, values resolution is taken into account, so that the
+ * rounding of integral values does not show up as a fault on densely sampled
+ * trajectories.
+ */
+struct TrajectoryLimits
+{
+  double min_value = std::numeric_limits<double>::lowest(); /**< Minimum value. */
+  double max_value = std::numeric_limits<double>::max();    /**< Maximum value. */
+  double max_speed = std::numeric_limits<double>::max(); /**< Max absolute speed, /s. */
+  double max_acc   = std::numeric_limits<double>::max(); /**< Max absolute acc, /s^2. */
+  double resolution = 0.0; /**< Values resolution, e.g. 1 for integral values. */
+};
+
+/**
+ * @brief Faults a trajectory sample may have, as bit flags.
+ */
+enum TrajectoryFault : uint8_t
+{
+  NOT_FINITE   = 0x01, /**< Time, value or velocity is NaN or infinite. */
+  TIME_STALLED = 0x02, /**< Time does not increase up to next sample. */
+  BELOW_MIN    = 0x04, /**< Value is below minimum. */
+  ABOVE_MAX    = 0x08, /**< Value is above maximum. */
+  OVER_SPEED   = 0x10, /**< Speed exceeds its limit. */
+  OVER_ACC     = 0x20  /**< Acceleration exceeds its limit. */
+};
+
+/**
+ * @brief A fault found at a trajectory sample.
+ */
+struct TrajectoryIssue
+{
+  size_t sample;        /**< Sample index. */
+  TrajectoryFault type; /**< Fault type. */
+  double time;          /**< [sec] Sample timestamp. */
+  double value;         /**< Offending quantity, e.g. speed for an over-speed fault. */
+};
+
+/**
+ * @brief Outcome of a trajectory validation.
+ */
+struct ValidationReport
+{
+  id_t id             = 0; /**< ID of the validated trajectory. */
+  size_t samples_num  = 0; /**< Number of samples of the validated trajectory. */
+  uint8_t faults      = 0; /**< Bitwise OR of all faults found. */
+  size_t faults_num   = 0; /**< Total number of faults, i.e. of fault flags raised by all
+                                samples, so a sample may count more than once. */
+  vect<TrajectoryIssue> issues; /**< First issues found, in sample order. */
+
+  /**
+   * @brief Check if trajectory is valid.
+   * @return _True_ if no fault was found, _False_ otherwise.
+   */
+  bool IsValid() const { return faults == 0; }
+  /**
+   * @brief Get a human readable summary of the faults found.
+   * @return The summary, empty if trajectory is valid.
+   */
+  std::string Summary() const;
+};
+
+/**
+ * @brief Get the name of a trajectory fault.
+ * @param[in] fault Trajectory fault.
+ * @return The name of the fault.
+ */
+const char* TrajectoryFaultName(const TrajectoryFault fault);
+
+/**
+ * @brief Validate a sampled trajectory, stored as arrays of doubles.
+ *
+ * Samples are checked in a single branchless pass, which the compiler vectorizes,
+ * counting faults of each type. Speed and acceleration
+ * are computed by finite differences on consecutive samples or, if velocities are given,
+ * as the exact derivatives of the cubic Hermite segments in between, whose acceleration
+ * peaks at their ends. Only if some fault is found, samples are scanned again to collect
+ * detailed issues.
+ * @param[in] times Timestamps, in seconds.
+ * @param[in] values Values.
+ * @param[in] velocities Velocities at samples, or _nullptr_ if not available.
+ * @param[in] size Number of samples.
+ * @param[in] limits Limits to comply with.
+ * @param[in] max_issues Maximum number of detailed issues to be collected.
+ * @return The validation report.
+ */
+ValidationReport ValidateSamples(const double* times, const double* values,
+                                 const double* velocities, const size_t size,
+                                 const TrajectoryLimits& limits,
+                                 const size_t max_issues = 10);
+
+/**
+ * @brief Validate a trajectory.
+ * @param[in] traj Trajectory to be validated.
+ * @param[in] limits Limits to comply with.
+ * @param[in] max_issues Maximum number of detailed issues to be collected.
+ * @return The validation report.
+ * @see ValidateSamples
+ */
+template <typename T>
+ValidationReport ValidateTrajectory(const Trajectory<T>& traj,
+                                    const TrajectoryLimits& limits,
+                                    const size_t max_issues = 10)
+{
+  const size_t size = std::min(traj.timestamps.size(), traj.values.size());
+  const vectD values(traj.values.begin(), traj.values.begin() + size);
+  ValidationReport report =
+    ValidateSamples(traj.timestamps.data(), values.data(),
+                    traj.hasVelocities() ? traj.velocities.data() : nullptr, size,
+                    limits, max_issues);
+  report.id = traj.id;
+  return report;
+}
+
+/**
+ * @brief Validate a trajectory of doubles, without copying its values.
+ * @param[in] traj Trajectory to be validated.
+ * @param[in] limits Limits to comply with.
+ * @param[in] max_issues Maximum number of detailed issues to be collected.
+ * @return The validation report.
+ * @see ValidateSamples
+ */
+inline ValidationReport ValidateTrajectory(const TrajectoryD& traj,
+                                           const TrajectoryLimits& limits,
+                                           const size_t max_issues = 10)
+{
+  ValidationReport report =
+    ValidateSamples(traj.timestamps.data(), traj.values.data(),
+                    traj.hasVelocities() ? traj.velocities.data() : nullptr,
+                    std::min(traj.timestamps.size(), traj.values.size()), limits,
+                    max_issues);
+  report.id = traj.id;
+  return report;
+}
+
+#endif // CABLE_ROBOT_TRAJECTORY_VALIDATION_H
@@ -161,6 +161,31 @@ struct ActuatorStatus: WinchStatus
   double pulley_angle; /**< [rad] */
 };
 
+/**
+ * @brief Maximum number of active actuators, whose status can be collected in a single
+ * frame.
+ *
+ * Frames have a fixed size to be exchanged by the real-time thread without allocations.
+ * Configurations with more active actuators are refused when loaded.
+ */
+static constexpr size_t kMaxActuators = 8;
+
+/**
+ * @brief A structure collecting the status of all active actuators at the same instant.
+ *
+ * Only the first _actuators_num_ elements of _actuators_ are valid.
+ */
+struct ActuatorsFrame
+{
+  /**
+   * @brief ActuatorsFrame default constructor, yielding an empty frame.
+   */
+  ActuatorsFrame() : cycle_count(0), actuators_num(0) {}
+
+  uint32_t cycle_count;                    /**< Real-time cycle counter. */
+  uint8_t actuators_num;                   /**< Number of valid actuators status. */
+  ActuatorStatus actuators[kMaxActuators]; /**< Status of each active actuator. */
+};
 
 template <typename T>
 /**
@@ -191,12 +216,18 @@ template <typename T>
 /**
  * @brief A convenient structure to describe a trajectory, that is an array of scalar with
  * an array of timestamps of equal length.
+ *
+ * Values are linearly interpolated between timestamps, unless velocities are given too,
+ * one per value, in which case the trajectory is a position-velocity-time (PVT) one and
+ * values are interpolated by cubic Hermite splines. The latter is smooth up to velocity,
+ * so that waypoints can be much sparser than the real-time cycle.
  */
 struct Trajectory
 {
   id_t id = 0;      /**< The ID of the trajectory, for example of the relative motor. */
   vectD timestamps; /**< An array of timestamps in seconds. */
   vect<T> values;   /**< An array of generic scalar values. */
+  vectD velocities; /**< An optional array of values time derivatives, per second. */
 
   /**
    * @brief Default constructor.
@@ -236,6 +267,15 @@ struct Trajectory
     assert(times.size() == _values.size());
   }
 
+  /**
+   * @brief Check if trajectory is a PVT one, i.e. if it includes velocities.
+   * @return _True_ if there is one velocity per value, _False_ otherwise.
+   */
+  bool hasVelocities() const
+  {
+    return !velocities.empty() && velocities.size() == values.size();
+  }
+
   /**
    * @brief Get a waypoint from given index.
    * @param[in] index The index of the desired waypoint.
@@ -252,7 +292,8 @@ struct Trajectory
   /**
    * @brief Get a waypoint from given absolute time.
    * @param[in] time An absolute time in seconds.
-   * @param[in] eps The tolerance used to avoid numerical issues.
+   * @param[in] eps The tolerance used to avoid numerical issues. In linear
+   * interpolation, a sample closer than this to given time is returned as is.
    * @return The closes waypoint to given time.
    * @see waypointFromRelTime waypointFromIndex
    */
@@ -280,7 +321,22 @@ struct Trajectory
     double dt_left  = time - timestamps[lower_idx];
     double dt_right = timestamps[upper_idx] - time;
     double value;
-    if (std::min(dt_left, dt_right) <= eps)
+    if (hasVelocities())
+    {
+      // Cubic Hermite interpolation, exact at samples
+      const double h   = timestamps[upper_idx] - timestamps[lower_idx];
+      const double s   = h > 0.0 ? dt_left / h : 0.0;
+      const double s2  = s * s;
+      const double s3  = s2 * s;
+      const double h00 = 2. * s3 - 3. * s2 + 1.;
+      const double h10 = s3 - 2. * s2 + s;
+      const double h01 = -2. * s3 + 3. * s2;
+      const double h11 = s3 - s2;
+
+      value = h00 * values[lower_idx] + h10 * h * velocities[lower_idx] +
+              h01 * values[upper_idx] + h11 * h * velocities[upper_idx];
+    }
+    else if (std::min(dt_left, dt_right) <= eps)
     {
       if (dt_left < dt_right)
         value = values[lower_idx];
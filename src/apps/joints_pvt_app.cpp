@@ -7,6 +7,12 @@
 
 #include "apps/joints_pvt_app.h"
 
+#include <QDataStream>
+#include <QStringList>
+
+#include "apps/trajectory_loader.h"
+#include "utils/trajectory_compression.h"
+
 //------------------------------------------------------------------------------------//
 //--------- Joints PVT App Data class ------------------------------------------------//
 //------------------------------------------------------------------------------------//
@@ -25,7 +31,8 @@ constexpr char* JointsPVTApp::kStatesStr[];
 JointsPVTApp::JointsPVTApp(QObject* parent, CableRobot* robot,
                            const vect<grabcdpr::ActuatorParams>& params)
   : QObject(parent), StateMachine(ST_MAX_STATES), robot_ptr_(robot),
-    controller_(params, robot->GetRtCycleTimeNsec(), this)
+    controller_(params, robot->GetRtCycleTimeNsec(), this), loader_(new TrajectoryLoader),
+    checker_(robot->GetRobotParams())
 {
   connect(&controller_, SIGNAL(trajectoryProgressStatus(int, double)), this,
           SLOT(progressUpdate(int, double)), Qt::ConnectionType::QueuedConnection);
@@ -34,6 +41,9 @@ JointsPVTApp::JointsPVTApp(QObject* parent, CableRobot* robot,
   connect(this, SIGNAL(printToQConsole(QString)), this, SLOT(logInfo(QString)),
           Qt::ConnectionType::DirectConnection);
   connect(this, SIGNAL(stopWaitingCmd()), robot_ptr_, SLOT(stopWaiting()));
+  connect(loader_, SIGNAL(progress(int, int)), this,
+          SIGNAL(trajectoriesReadProgress(int, int)));
+  connect(loader_, SIGNAL(completed(bool)), this, SLOT(handleTrajectoriesLoaded(bool)));
 
   controller_.SetMotorsID(robot_ptr_->GetActiveMotorsID());
   robot->SetController(&controller_);
@@ -44,6 +54,9 @@ JointsPVTApp::JointsPVTApp(QObject* parent, CableRobot* robot,
 
 JointsPVTApp::~JointsPVTApp()
 {
+  // Loader workers use this object, so they must be over before anything is destroyed
+  delete loader_;
+  delete check_analyzer_;
   clearAllTrajectories();
 
   disconnect(&controller_, SIGNAL(trajectoryProgressStatus(int, double)), this,
@@ -76,6 +89,61 @@ const TrajectorySet& JointsPVTApp::getTrajectorySet(const int traj_idx) const
   return traj_sets_[traj_idx];
 }
 
+void JointsPVTApp::setCompressionTolerances(const double cable_len_tol,
+                                            const double motor_pos_tol)
+{
+  cable_len_tol_ = cable_len_tol;
+  motor_pos_tol_ = motor_pos_tol;
+}
+
+void JointsPVTApp::clearTrajectoryCache() const { cache_.clear(); }
+
+bool JointsPVTApp::startReadingTrajectories(const QVector<QString>& ifilepaths)
+{
+  CLOG(TRACE, "event") << "from " << ifilepaths.size() << " files";
+  // Robot dependent data are taken once here, so that workers do not access robot state
+  const vect<JointLimits> limits = jointsLimits();
+  const vectD ratios             = transmissionRatios();
+  const QByteArray context       = cacheContext(limits, ratios);
+  // Same for tolerances, which may be changed while workers run
+  const double cable_len_tol = cable_len_tol_;
+  const double motor_pos_tol = motor_pos_tol_;
+  return loader_->start(
+    ifilepaths, [this, context, limits, ratios, cable_len_tol, motor_pos_tol](
+                  const QString& ifilepath, TrajectorySet& traj_set, bool& relative,
+                  QString& error) {
+      return loadTrajectorySet(ifilepath, context, limits, ratios, cable_len_tol,
+                               motor_pos_tol, traj_set, relative, error);
+    });
+}
+
+void JointsPVTApp::cancelReadingTrajectories()
+{
+  CLOG(TRACE, "event");
+  loader_->cancel();
+}
+
+bool JointsPVTApp::isReadingTrajectories() const { return loader_->isRunning(); }
+
+bool JointsPVTApp::startCheckingTrajectories()
+{
+  if (traj_sets_.isEmpty())
+    return false;
+
+  vect<TrajectoryCheckJob> jobs(static_cast<size_t>(traj_sets_.size()));
+  for (int i = 0; i < traj_sets_.size(); i++)
+  {
+    jobs[i].traj_platform   = traj_sets_[i].traj_platform;
+    jobs[i].traj_cables_len = traj_sets_[i].traj_cables_len;
+  }
+  delete check_analyzer_; // aborts any outdated check, which then notifies nothing
+  check_analyzer_ = new TrajectoryCheckAnalyzer(this, &checker_, jobs);
+  connect(check_analyzer_, SIGNAL(resultsReady()), this,
+          SLOT(handleTrajectoriesChecked()), Qt::ConnectionType::QueuedConnection);
+  check_analyzer_->start(QThread::LowPriority);
+  return true;
+}
+
 //--------- External Events ---------------------------------------------------------//
 
 void JointsPVTApp::clearAllTrajectories()
@@ -94,43 +162,30 @@ void JointsPVTApp::clearAllTrajectories()
 bool JointsPVTApp::readTrajectories(const QString& ifilepath)
 {
   CLOG(TRACE, "event") << "from '" << ifilepath << "'";
-  QFile ifile(ifilepath);
-  if (!ifile.open(QIODevice::ReadOnly | QIODevice::Text))
+  const vect<JointLimits> limits = jointsLimits();
+  const vectD ratios             = transmissionRatios();
+  TrajectorySet traj_set;
+  bool relative;
+  QString error;
+  if (!loadTrajectorySet(ifilepath, cacheContext(limits, ratios), limits, ratios,
+                         cable_len_tol_, motor_pos_tol_, traj_set, relative, error))
   {
+    CLOG(WARNING, "event") << "Trajectory file '" << ifilepath << "' is not valid"
+                           << (error.isEmpty() ? "" : ": ") << error;
     ExternalEvent(ST_IDLE);
     return false;
   }
-
-  // Read header yielding information about trajectory type and involved motors
-  QTextStream s(&ifile);
-  QStringList header = s.readLine().split(" ");
-  TrajectorySet traj_set;
-  traj_set.traj_type = header[0].toUShort();
-  bool relative      = static_cast<bool>(header[1].toUShort());
-  vect<id_t> motors_id;
-  for (int i = 2; i < header.size(); i++)
-    motors_id.push_back(header[i].toUInt());
-
-  // Fill trajectories accordingly reading text body line-by-line
-  switch (traj_set.traj_type)
+  if (relative)
   {
-    case TrajectoryType::CABLE_LENGTH:
-      setCablesLenTraj(relative, motors_id, s, traj_set);
-      break;
-    case TrajectoryType::CABLE_SPEED:
-      setCablesVelTraj(motors_id, s, traj_set);
-      break;
-    case TrajectoryType::MOTOR_POSITION:
-      setMotorsPosTraj(relative, motors_id, s, traj_set);
-      break;
-    case TrajectoryType::MOTOR_SPEED:
-      setMotorsVelTraj(motors_id, s, traj_set);
-      break;
-    case TrajectoryType::MOTOR_TORQUE:
-      setMotorsTorqueTraj(relative, motors_id, s, traj_set);
-      break;
-    case TrajectoryType::NONE:
+    applyRelativeOffsets(traj_set);
+    // Bounds are checked only now that trajectories are absolute
+    if (!validateTrajectorySet(traj_set, limits, true, false, error))
+    {
+      CLOG(WARNING, "event") << "Trajectory file '" << ifilepath
+                             << "' is not valid: " << error;
+      ExternalEvent(ST_IDLE);
       return false;
+    }
   }
   traj_sets_.append(traj_set);
   CLOG(INFO, "event") << "Trajectory parsed";
@@ -198,6 +253,71 @@ void JointsPVTApp::progressUpdate(const int progress_value, const double timesta
   emit trajectoryProgress(progress_value, timestamp);
 }
 
+void JointsPVTApp::handleTrajectoriesLoaded(const bool success)
+{
+  QVector<TrajectorySet> traj_sets;
+  QVector<bool> relative;
+  loader_->takeResults(traj_sets, relative);
+  QString failed_filepath = loader_->failedFilepath();
+  QString error           = loader_->failedError();
+
+  // Live offsets are cheap, hence applied here all at once before hand over, together
+  // with the bounds check they postpone
+  const vect<JointLimits> limits = jointsLimits();
+  for (int i = 0; success && i < traj_sets.size(); i++)
+  {
+    if (!relative[i])
+      continue;
+    applyRelativeOffsets(traj_sets[i]);
+    if (!validateTrajectorySet(traj_sets[i], limits, true, false, error))
+    {
+      failed_filepath = loader_->filepath(i);
+      break;
+    }
+  }
+  if (!success || !failed_filepath.isEmpty())
+  {
+    if (failed_filepath.isEmpty())
+      CLOG(INFO, "event") << "Trajectories reading canceled";
+    else
+      CLOG(WARNING, "event") << "Trajectory file '" << failed_filepath
+                             << "' is not valid" << (error.isEmpty() ? "" : ": ")
+                             << error;
+    ExternalEvent(ST_IDLE);
+    emit trajectoriesReadComplete(false, failed_filepath, error);
+    return;
+  }
+
+  for (const TrajectorySet& traj_set : traj_sets)
+    traj_sets_.append(traj_set);
+  CLOG(INFO, "event") << traj_sets.size() << " trajectories parsed";
+  if (!traj_sets.isEmpty())
+    ExternalEvent(ST_READY);
+  emit trajectoriesReadComplete(true, QString(), QString());
+}
+
+void JointsPVTApp::handleTrajectoriesChecked()
+{
+  // Skip a notice of an outdated check, queued before a new one started
+  if (sender() != check_analyzer_)
+    return;
+  const vect<TrajectoryCheckReport>& reports = check_analyzer_->GetReports();
+  bool safe                                  = true;
+  QStringList summaries;
+  for (size_t i = 0; i < reports.size(); i++)
+  {
+    if (reports[i].samples_num == 0)
+      CLOG(INFO, "event") << "Trajectory #" << i << " not checked";
+    else if (!reports[i].IsSafe())
+    {
+      safe = false;
+      summaries.append(QString("Trajectory #%1: %2").arg(i).arg(reports[i].Summary()));
+      CLOG(WARNING, "event") << summaries.last();
+    }
+  }
+  emit trajectoriesCheckComplete(safe, summaries.join("\n"));
+}
+
 void JointsPVTApp::logInfo(const QString& text) const
 {
   if (text.contains("warning", Qt::CaseSensitivity::CaseInsensitive))
@@ -246,6 +366,7 @@ STATE_DEFINE(JointsPVTApp, Transition, JointsPVTAppData)
       double target_cable_len = transition_traj.values.front();
       transition_traj.timestamps.clear();
       transition_traj.values.clear();
+      transition_traj.velocities.clear();
       // Current cable length becomes start point of transition.
       double current_cable_len =
         robot_ptr_->GetActuatorStatus(transition_traj.id).cable_length;
@@ -280,6 +401,7 @@ STATE_DEFINE(JointsPVTApp, Transition, JointsPVTAppData)
       int target_motor_pos = transition_trajectories[i].values.front();
       transition_trajectories[i].timestamps.clear();
       transition_trajectories[i].values.clear();
+      transition_trajectories[i].velocities.clear();
       double max_motor_speed = robot_ptr_->GetActuator(transition_trajectories[i].id)
                                  ->GetWinch()
                                  .LengthToCounts(kMaxCableSpeed); // [counts/s]
@@ -347,36 +469,140 @@ STATE_DEFINE(JointsPVTApp, TrajectoryFollow, JointsPVTAppData)
 
 //--------- Private functions -------------------------------------------------------//
 
-void JointsPVTApp::setCablesLenTraj(const bool relative, const vect<id_t>& motors_id,
-                                    QTextStream& s, TrajectorySet& traj_set)
+bool JointsPVTApp::loadTrajectorySet(const QString& ifilepath, const QByteArray& context,
+                                     const vect<JointLimits>& limits, const vectD& ratios,
+                                     const double cable_len_tol,
+                                     const double motor_pos_tol, TrajectorySet& traj_set,
+                                     bool& relative, QString& error) const
+{
+  QFile ifile(ifilepath);
+  if (!ifile.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    error = "file could not be opened";
+    return false;
+  }
+  const QByteArray content = ifile.readAll();
+
+  // Parse file only if its content was never seen before within current context, which
+  // includes limits, so that cached sets are valid ones
+  const QString key = TrajectoryCache::makeKey(content, context);
+  if (cache_.load(key, traj_set, relative))
+  {
+    CLOG(INFO, "event") << "Trajectory '" << ifilepath << "' loaded from cache";
+    return true;
+  }
+  if (!parseTrajectories(content, ratios, traj_set, relative, error))
+    return false;
+  // Dense samples are validated before compression. Bounds of relative trajectories
+  // depend on live offsets instead, so they are checked only once those are applied.
+  if (!validateTrajectorySet(traj_set, limits, !relative, true, error))
+    return false;
+  // Splines through compressed waypoints may overshoot between them, hence they are
+  // validated as well, and dense samples are kept if they do not comply
+  TrajectorySet compressed_set = traj_set;
+  if (compressTrajectories(compressed_set, cable_len_tol, motor_pos_tol))
+  {
+    QString compression_error;
+    if (validateTrajectorySet(compressed_set, limits, !relative, true, compression_error))
+      traj_set = std::move(compressed_set);
+    else
+      CLOG(WARNING, "event") << "Compressed trajectory '" << ifilepath
+                             << "' exceeds limits, dense one is kept instead:\n"
+                             << compression_error;
+  }
+  if (!cache_.store(key, traj_set, relative))
+    CLOG(WARNING, "event") << "Could not store trajectory in cache";
+  return true;
+}
+
+bool JointsPVTApp::parseTrajectories(const QByteArray& content, const vectD& ratios,
+                                     TrajectorySet& traj_set, bool& relative,
+                                     QString& error) const
 {
-  CLOG(INFO, "event") << QString("File contains %1 cables length trajectories")
-                           .arg(relative ? "relative" : "absolute");
+  // Read header yielding information about trajectory type and involved motors
+  QTextStream s(content);
+  QStringList header = s.readLine().split(" ");
+  traj_set.traj_type = header[0].toUShort();
+  relative           = static_cast<bool>(header[1].toUShort());
+  vect<id_t> motors_id;
+  for (int i = 2; i < header.size(); i++)
+    motors_id.push_back(header[i].toUInt());
+
+  // Fill trajectories accordingly reading text body line-by-line
+  switch (traj_set.traj_type)
+  {
+    case TrajectoryType::CABLE_LENGTH:
+      setCablesLenTraj(motors_id, s, traj_set);
+      break;
+    case TrajectoryType::CABLE_SPEED:
+      // Conversion to motor speed needs the transmission ratio of each motor
+      for (const id_t id : motors_id)
+        if (id >= ratios.size() || ratios[id] == 0.0)
+        {
+          error = QString("motor %1 is not active").arg(id);
+          return false;
+        }
+      setCablesVelTraj(motors_id, ratios, s, traj_set);
+      break;
+    case TrajectoryType::MOTOR_POSITION:
+      setMotorsPosTraj(motors_id, s, traj_set);
+      break;
+    case TrajectoryType::MOTOR_SPEED:
+      setMotorsVelTraj(motors_id, s, traj_set);
+      break;
+    case TrajectoryType::MOTOR_TORQUE:
+      setMotorsTorqueTraj(motors_id, s, traj_set);
+      break;
+    case TrajectoryType::CABLE_LENGTH_PVT:
+      // Sparse waypoints with velocities, then handled as any cable length trajectory
+      setCablesLenTraj(motors_id, s, traj_set, true);
+      traj_set.traj_type = TrajectoryType::CABLE_LENGTH;
+      break;
+    case TrajectoryType::MOTOR_POSITION_PVT:
+      // Sparse waypoints with velocities, then handled as any motor position trajectory
+      setMotorsPosTraj(motors_id, s, traj_set, true);
+      traj_set.traj_type = TrajectoryType::MOTOR_POSITION;
+      break;
+    case TrajectoryType::NONE:
+      error = "unknown trajectory type";
+      return false;
+  }
+  return true;
+}
+
+void JointsPVTApp::setCablesLenTraj(const vect<id_t>& motors_id, QTextStream& s,
+                                    TrajectorySet& traj_set,
+                                    const bool with_velocities /*= false*/) const
+{
+  CLOG(INFO, "event") << QString("File contains cables length%1 trajectories")
+                           .arg(with_velocities ? "-velocity" : "");
   traj_set.traj_cables_len.resize(motors_id.size());
-  vectD current_cables_len(traj_set.traj_cables_len.size());
   for (size_t i = 0; i < motors_id.size(); i++)
-  {
     traj_set.traj_cables_len[i].id = motors_id[i];
-    current_cables_len[i] = robot_ptr_->GetActuatorStatus(motors_id[i]).cable_length;
-  }
   while (!s.atEnd())
   {
     QStringList line = s.readLine().split(" ");
     for (auto& traj : traj_set.traj_cables_len)
       traj.timestamps.push_back(line[0].toDouble());
-    for (int i = 1; i < line.size(); i++)
+    if (with_velocities)
     {
+      // Each cable length is followed by its velocity
+      for (int i = 1; i + 1 < line.size(); i += 2)
+      {
+        TrajectoryD& traj = traj_set.traj_cables_len[static_cast<size_t>(i - 1) / 2];
+        traj.values.push_back(line[i].toDouble());
+        traj.velocities.push_back(line[i + 1].toDouble());
+      }
+      continue;
+    }
+    for (int i = 1; i < line.size(); i++)
       traj_set.traj_cables_len[static_cast<size_t>(i) - 1].values.push_back(
         line[i].toDouble());
-      if (relative)
-        traj_set.traj_cables_len[static_cast<size_t>(i) - 1].values.back() +=
-          current_cables_len[static_cast<size_t>(i) - 1];
-    }
   }
 }
 
-void JointsPVTApp::setCablesVelTraj(const vect<id_t>& motors_id, QTextStream& s,
-                                    TrajectorySet& traj_set)
+void JointsPVTApp::setCablesVelTraj(const vect<id_t>& motors_id, const vectD& ratios,
+                                    QTextStream& s, TrajectorySet& traj_set) const
 {
   CLOG(INFO, "event") << "File contains cables velocity trajectories";
   traj_set.traj_motors_vel.resize(motors_id.size());
@@ -389,44 +615,47 @@ void JointsPVTApp::setCablesVelTraj(const vect<id_t>& motors_id, QTextStream& s,
       traj.timestamps.push_back(line[0].toDouble());
     for (int i = 1; i < line.size(); i++)
     {
-      int motor_vel = robot_ptr_->GetActuator(motors_id[static_cast<size_t>(i)])
-                        ->GetWinch()
-                        .LengthToCounts(line[i].toDouble()); // m/s --> counts/s
-      traj_set.traj_motors_vel[static_cast<size_t>(i) - 1].values.push_back(motor_vel);
+      const size_t j = static_cast<size_t>(i) - 1;
+      // m/s --> counts/s, as in Winch::LengthToCounts()
+      int motor_vel = static_cast<int>(line[i].toDouble() / ratios[motors_id[j]]);
+      traj_set.traj_motors_vel[j].values.push_back(motor_vel);
     }
   }
 }
 
-void JointsPVTApp::setMotorsPosTraj(const bool relative, const vect<id_t>& motors_id,
-                                   QTextStream& s, TrajectorySet& traj_set)
+void JointsPVTApp::setMotorsPosTraj(const vect<id_t>& motors_id, QTextStream& s,
+                                   TrajectorySet& traj_set,
+                                   const bool with_velocities /*= false*/) const
 {
-  CLOG(INFO, "event") << QString("File contains %1 motors position trajectories")
-                           .arg(relative ? "relative" : "absolute");
+  CLOG(INFO, "event") << QString("File contains motors position%1 trajectories")
+                           .arg(with_velocities ? "-velocity" : "");
   traj_set.traj_motors_pos.resize(motors_id.size());
-  vectI current_motors_pos(traj_set.traj_cables_len.size());
   for (size_t i = 0; i < motors_id.size(); i++)
-  {
     traj_set.traj_motors_pos[i].id = motors_id[i];
-    current_motors_pos[i] = robot_ptr_->GetActuatorStatus(motors_id[i]).motor_position;
-  }
   while (!s.atEnd())
   {
     QStringList line = s.readLine().split(" ");
     for (auto& traj : traj_set.traj_motors_pos)
       traj.timestamps.push_back(line[0].toDouble());
-    for (int i = 1; i < line.size(); i++)
+    if (with_velocities)
     {
+      // Each motor position is followed by its velocity
+      for (int i = 1; i + 1 < line.size(); i += 2)
+      {
+        TrajectoryI& traj = traj_set.traj_motors_pos[static_cast<size_t>(i - 1) / 2];
+        traj.values.push_back(line[i].toInt());
+        traj.velocities.push_back(line[i + 1].toDouble());
+      }
+      continue;
+    }
+    for (int i = 1; i < line.size(); i++)
       traj_set.traj_motors_pos[static_cast<size_t>(i) - 1].values.push_back(
         line[i].toInt());
-      if (relative)
-        traj_set.traj_cables_len[static_cast<size_t>(i) - 1].values.back() +=
-          current_motors_pos[static_cast<size_t>(i) - 1];
-    }
   }
 }
 
 void JointsPVTApp::setMotorsVelTraj(const vect<id_t>& motors_id, QTextStream& s,
-                                   TrajectorySet& traj_set)
+                                   TrajectorySet& traj_set) const
 {
   CLOG(INFO, "event") << "File contains motors velocity trajectories";
   traj_set.traj_motors_vel.resize(motors_id.size());
@@ -443,39 +672,209 @@ void JointsPVTApp::setMotorsVelTraj(const vect<id_t>& motors_id, QTextStream& s,
   }
 }
 
-void JointsPVTApp::setMotorsTorqueTraj(const bool relative, const vect<id_t>& motors_id,
-                                      QTextStream& s, TrajectorySet& traj_set)
+void JointsPVTApp::setMotorsTorqueTraj(const vect<id_t>& motors_id, QTextStream& s,
+                                      TrajectorySet& traj_set) const
 {
-  CLOG(INFO, "event") << QString("File contains %1 motors torque trajectories")
-                           .arg(relative ? "relative" : "absolute");
+  CLOG(INFO, "event") << "File contains motors torque trajectories";
   traj_set.traj_motors_torque.resize(motors_id.size());
-  vectS current_motors_torque(traj_set.traj_cables_len.size());
   for (size_t i = 0; i < motors_id.size(); i++)
-  {
     traj_set.traj_motors_torque[i].id = motors_id[i];
-    current_motors_torque[i] = robot_ptr_->GetActuatorStatus(motors_id[i]).motor_torque;
-  }
   while (!s.atEnd())
   {
     QStringList line = s.readLine().split(" ");
     for (auto& traj : traj_set.traj_motors_torque)
       traj.timestamps.push_back(line[0].toDouble());
     for (int i = 1; i < line.size(); i++)
-    {
       traj_set.traj_motors_torque[static_cast<size_t>(i) - 1].values.push_back(
         line[i].toShort());
-      if (relative)
-        traj_set.traj_cables_len[static_cast<size_t>(i) - 1].values.back() +=
-          current_motors_torque[static_cast<size_t>(i) - 1];
-    }
   }
 }
 
+bool JointsPVTApp::compressTrajectories(TrajectorySet& traj_set,
+                                        const double cable_len_tol,
+                                        const double motor_pos_tol) const
+{
+  CompressionReport report;
+  QString units;
+  if (traj_set.traj_type == TrajectoryType::CABLE_LENGTH && cable_len_tol > 0.0)
+  {
+    for (auto& traj : traj_set.traj_cables_len)
+      report += CompressTrajectory(traj, cable_len_tol);
+    units = "m";
+  }
+  else if (traj_set.traj_type == TrajectoryType::MOTOR_POSITION && motor_pos_tol > 0.0)
+  {
+    for (auto& traj : traj_set.traj_motors_pos)
+      report += CompressTrajectory(traj, motor_pos_tol);
+    units = "counts";
+  }
+  if (report.knots_num == report.samples_num)
+    return false;
+
+  CLOG(INFO, "event") << QString("Trajectories compressed from %1 to %2 waypoints "
+                                 "(ratio %3:1), max error %4 %5")
+                           .arg(report.samples_num)
+                           .arg(report.knots_num)
+                           .arg(report.Ratio(), 0, 'f', 1)
+                           .arg(report.max_error)
+                           .arg(units);
+  return true;
+}
+
+void JointsPVTApp::applyRelativeOffsets(TrajectorySet& traj_set) const
+{
+  CLOG(INFO, "event") << "Trajectories are relative to current robot state";
+  for (auto& traj : traj_set.traj_cables_len)
+  {
+    const double offset = robot_ptr_->GetActuatorStatus(traj.id).cable_length;
+    for (double& value : traj.values)
+      value += offset;
+  }
+  for (auto& traj : traj_set.traj_motors_pos)
+  {
+    const int offset = robot_ptr_->GetActuatorStatus(traj.id).motor_position;
+    for (int& value : traj.values)
+      value += offset;
+  }
+  for (auto& traj : traj_set.traj_motors_torque)
+  {
+    const short offset = robot_ptr_->GetActuatorStatus(traj.id).motor_torque;
+    for (short& value : traj.values)
+      value = static_cast<short>(value + offset);
+  }
+}
+
+QByteArray JointsPVTApp::cacheContext(const vect<JointLimits>& limits,
+                                      const vectD& ratios) const
+{
+  // Everything parsed trajectories depend on, besides file content
+  QByteArray context;
+  QDataStream stream(&context, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_4_5);
+  stream << cable_len_tol_ << motor_pos_tol_;
+  for (size_t id = 0; id < ratios.size(); id++)
+    if (ratios[id] != 0.0)
+      stream << static_cast<quint32>(id) << ratios[id];
+  for (const JointLimits& joint_limits : limits)
+    for (const TrajectoryLimits* type_limits :
+         {&joint_limits.cable_len, &joint_limits.motor_pos, &joint_limits.motor_vel,
+          &joint_limits.motor_torque})
+      stream << type_limits->min_value << type_limits->max_value
+             << type_limits->max_speed << type_limits->max_acc
+             << type_limits->resolution;
+  return context;
+}
+
+vectD JointsPVTApp::transmissionRatios() const
+{
+  // Indexed by motor ID: inactive motors have a null ratio
+  const vect<id_t> motors_id = robot_ptr_->GetActiveMotorsID();
+  vectD ratios(
+    motors_id.empty() ? 0 : *std::max_element(motors_id.begin(), motors_id.end()) + 1,
+    0.0);
+  for (const id_t id : motors_id)
+    ratios[id] = robot_ptr_->GetActuator(id)->GetWinch().CountsToLength(1); // [m/counts]
+  return ratios;
+}
+
+vect<JointLimits> JointsPVTApp::jointsLimits() const
+{
+  static constexpr double kInf = std::numeric_limits<double>::max();
+
+  // Indexed by motor ID: inactive motors keep unbounded limits, as they are not driven
+  const vect<id_t> motors_id = robot_ptr_->GetActiveMotorsID();
+  vect<JointLimits> limits(
+    motors_id.empty() ? 0 : *std::max_element(motors_id.begin(), motors_id.end()) + 1);
+  pthread_mutex_lock(&robot_ptr_->Mutex());
+  const LimitClampStage& clamp = robot_ptr_->GetCtrlPipeline().GetStage<0>();
+  for (const id_t id : motors_id)
+  {
+    const double max_speed = clamp.GetMotorSpeedLimit(id); // [counts/s]
+    const double max_acc   = clamp.GetMotorAccLimit(id);   // [counts/s^2]
+    const double ratio     = std::abs(
+      robot_ptr_->GetActuator(id)->GetWinch().CountsToLength(1)); // [m/counts]
+    JointLimits& joint     = limits[id];
+
+    clamp.GetCableLenLimits(id, joint.cable_len.min_value, joint.cable_len.max_value);
+    joint.cable_len.min_value = std::max(joint.cable_len.min_value, 0.0);
+    joint.cable_len.max_speed  = max_speed * ratio;
+    joint.cable_len.max_acc    = max_acc * ratio;
+    joint.cable_len.resolution = ratio;
+
+    int32_t min_pos, max_pos;
+    clamp.GetMotorPosLimits(id, min_pos, max_pos);
+    joint.motor_pos.min_value  = min_pos;
+    joint.motor_pos.max_value  = max_pos;
+    joint.motor_pos.max_speed  = max_speed;
+    joint.motor_pos.max_acc    = max_acc;
+    joint.motor_pos.resolution = 1.0;
+
+    // For a speed trajectory, its speed is motor acceleration
+    joint.motor_vel.min_value  = -max_speed;
+    joint.motor_vel.max_value  = max_speed;
+    joint.motor_vel.max_speed  = max_acc;
+    joint.motor_vel.max_acc    = kInf;
+    joint.motor_vel.resolution = 1.0;
+
+    joint.motor_torque.min_value  = -clamp.GetMotorTorqueLimit(id);
+    joint.motor_torque.max_value  = clamp.GetMotorTorqueLimit(id);
+    joint.motor_torque.resolution = 1.0;
+  }
+  pthread_mutex_unlock(&robot_ptr_->Mutex());
+  return limits;
+}
+
+bool JointsPVTApp::validateTrajectorySet(const TrajectorySet& traj_set,
+                                         const vect<JointLimits>& limits,
+                                         const bool with_bounds,
+                                         const bool with_derivatives,
+                                         QString& error) const
+{
+  static constexpr double kInf = std::numeric_limits<double>::max();
+
+  // Pick the limits of each trajectory according to type and checks to be done
+  auto select = [&](const id_t id, TrajectoryLimits JointLimits::*type) {
+    TrajectoryLimits traj_limits =
+      id < limits.size() ? limits[id].*type : JointLimits().*type;
+    if (!with_bounds)
+    {
+      traj_limits.min_value = -kInf;
+      traj_limits.max_value = kInf;
+    }
+    if (!with_derivatives)
+    {
+      traj_limits.max_speed = kInf;
+      traj_limits.max_acc   = kInf;
+    }
+    return traj_limits;
+  };
+  vect<ValidationReport> reports;
+  for (const TrajectoryD& traj : traj_set.traj_cables_len)
+    reports.push_back(ValidateTrajectory(traj, select(traj.id, &JointLimits::cable_len)));
+  for (const TrajectoryI& traj : traj_set.traj_motors_pos)
+    reports.push_back(ValidateTrajectory(traj, select(traj.id, &JointLimits::motor_pos)));
+  for (const TrajectoryI& traj : traj_set.traj_motors_vel)
+    reports.push_back(ValidateTrajectory(traj, select(traj.id, &JointLimits::motor_vel)));
+  for (const TrajectoryS& traj : traj_set.traj_motors_torque)
+    reports.push_back(
+      ValidateTrajectory(traj, select(traj.id, &JointLimits::motor_torque)));
+
+  QStringList summaries;
+  for (const ValidationReport& report : reports)
+    if (!report.IsValid())
+      summaries.append(QString::fromStdString(report.Summary()));
+  if (summaries.isEmpty())
+    return true;
+  error = summaries.join("\n");
+  return false;
+}
+
 void JointsPVTApp::printStateTransition(const States current_state,
                                         const States new_state) const
 {
   if (current_state == new_state)
     return;
+  TRACE_STATE(trace_track_, kStatesStr[new_state]);
   QString msg;
   if (current_state != ST_MAX_STATES)
     msg = QString("Joints PVT app state transition: %1 --> %2")
@@ -25,13 +25,63 @@ const grabnum::Vector3d& ManualControlApp::getActualPos() const
   return actual_pos_;
 }
 
-void ManualControlApp::setTarget(const Coordinates coord, const double value)
+bool ManualControlApp::setTarget(const Coordinates coord, const double value)
 {
-  target_pos_(coord) = value;
+  grabnum::Vector3d new_target = target_pos_;
+  new_target(coord)            = value;
+
+  const WorkspaceGrid& workspace = robot_ptr_->GetWorkspace();
+  if (!workspace.IsValid())
+  {
+    // No grid yet (analysis still running, aborted or failed): check this pose only
+    if (!isPoseFeasible(new_target))
+    {
+      emit printToQConsole(
+        "WARNING: Target out of wrench-feasible workspace: target rejected");
+      return false;
+    }
+    target_pos_ = new_target;
+    // TODO: set new updated controller target
+    return true;
+  }
+
+  bool accepted = workspace.IsFeasible(new_target);
+  if (!accepted)
+  {
+    new_target = workspace.Clamp(target_pos_, new_target);
+    emit printToQConsole(
+      QString("WARNING: Target out of wrench-feasible workspace: clamped to [%1, %2, %3]")
+        .arg(new_target(Coordinates::X))
+        .arg(new_target(Coordinates::Y))
+        .arg(new_target(Coordinates::Z)));
+  }
+  target_pos_ = new_target;
   // TODO: set new updated controller target
+  return accepted;
 }
 
 void ManualControlApp::resetTarget()
 {
+  target_pos_ = getActualPos();
   // TODO: set controller target position with current platform position
 }
+
+//--------- Private functions --------------------------------------------------------//
+
+bool ManualControlApp::isPoseFeasible(const grabnum::Vector3d& position) const
+{
+  const grabcdpr::RobotParams& robot_params = robot_ptr_->GetRobotParams();
+  const WorkspaceGridParams grid_params =
+    WorkspaceGridParams::FromRobotParams(robot_params);
+
+  grabcdpr::RobotVars vars;
+  vars.platform = grabcdpr::PlatformVars(grabcdpr::TILT_TORSION);
+  vars.cables.resize(robot_params.actuators.size());
+  grabnum::Vector6d pose;
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    pose(i)     = position(i);
+    pose(i + 3) = grid_params.orientation(i);
+  }
+  return WorkspaceGrid::IsPoseFeasible(pose, robot_params, grid_params, vars);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file trajectory_cache.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in trajectory_cache.h.
+ */
+
+#include "apps/trajectory_cache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+
+#include "apps/joints_pvt_app.h"
+
+namespace {
+
+template <typename T, typename S>
+void writeTrajectoryList(QDataStream& stream, const vect<Trajectory<T>>& trajectories)
+{
+  stream << static_cast<quint32>(trajectories.size());
+  for (const Trajectory<T>& traj : trajectories)
+  {
+    stream << static_cast<quint32>(traj.id) << static_cast<quint32>(traj.values.size())
+           << static_cast<quint32>(traj.velocities.size());
+    for (const double time : traj.timestamps)
+      stream << time;
+    for (const T& value : traj.values)
+      stream << static_cast<S>(value);
+    for (const double velocity : traj.velocities)
+      stream << velocity;
+  }
+}
+
+template <typename T, typename S>
+void readTrajectoryList(QDataStream& stream, vect<Trajectory<T>>& trajectories)
+{
+  quint32 size;
+  stream >> size;
+  // Reject sizes which cannot fit in the rest of the entry, given the header of each
+  // trajectory (ID and sizes)
+  static constexpr qint64 kHeaderSize = 3 * sizeof(quint32);
+  if (stream.status() != QDataStream::Ok ||
+      size * kHeaderSize > stream.device()->bytesAvailable())
+  {
+    stream.setStatus(QDataStream::ReadCorruptData);
+    return;
+  }
+  trajectories.resize(size);
+  for (Trajectory<T>& traj : trajectories)
+  {
+    quint32 id, values_num, velocities_num;
+    stream >> id >> values_num >> velocities_num;
+    // Reject sizes which cannot fit in the rest of the entry, given that each sample
+    // holds a timestamp and a value
+    static constexpr qint64 kSampleSize = sizeof(double) + sizeof(S);
+    if (stream.status() != QDataStream::Ok ||
+        values_num * kSampleSize + velocities_num * qint64(sizeof(double)) >
+          stream.device()->bytesAvailable())
+    {
+      stream.setStatus(QDataStream::ReadCorruptData);
+      return;
+    }
+    traj.id = static_cast<id_t>(id);
+    traj.timestamps.resize(values_num);
+    traj.values.resize(values_num);
+    traj.velocities.resize(velocities_num);
+    for (double& time : traj.timestamps)
+      stream >> time;
+    for (T& value : traj.values)
+    {
+      S stored;
+      stream >> stored;
+      value = static_cast<T>(stored);
+    }
+    for (double& velocity : traj.velocities)
+      stream >> velocity;
+  }
+}
+
+} // end namespace
+
+constexpr quint32 TrajectoryCache::kMagicNumber_;
+constexpr quint32 TrajectoryCache::kVersion_;
+
+TrajectoryCache::TrajectoryCache(const QString& dirpath /*= QString()*/)
+  : dirpath_(dirpath.isEmpty() ? QDir::homePath() + "/.cache/cable_robot/trajectories"
+                               : dirpath)
+{}
+
+//--------- Public functions ---------------------------------------------------------//
+
+QString TrajectoryCache::makeKey(const QByteArray& content, const QByteArray& context)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(context);
+  hash.addData(content);
+  return QString::fromLatin1(hash.result().toHex());
+}
+
+bool TrajectoryCache::load(const QString& key, TrajectorySet& traj_set,
+                           bool& relative) const
+{
+  QFile file(entryFilepath(key));
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_5);
+  quint32 magic_number;
+  quint32 version;
+  stream >> magic_number >> version;
+  if (magic_number != kMagicNumber_ || version != kVersion_)
+    return false;
+
+  TrajectorySet cached_set;
+  quint16 traj_type;
+  bool cached_relative;
+  stream >> traj_type >> cached_relative;
+  cached_set.traj_type = traj_type;
+  readTrajectoryList<double, double>(stream, cached_set.traj_platform);
+  readTrajectoryList<double, double>(stream, cached_set.traj_cables_len);
+  readTrajectoryList<int, qint32>(stream, cached_set.traj_motors_pos);
+  readTrajectoryList<int, qint32>(stream, cached_set.traj_motors_vel);
+  readTrajectoryList<short, qint16>(stream, cached_set.traj_motors_torque);
+  if (stream.status() != QDataStream::Ok)
+    return false;
+
+  traj_set = std::move(cached_set);
+  relative = cached_relative;
+  return true;
+}
+
+bool TrajectoryCache::store(const QString& key, const TrajectorySet& traj_set,
+                            const bool relative) const
+{
+  QDir().mkpath(dirpath_);
+  // Entry is written aside and renamed once complete, so that it is never seen partial
+  QSaveFile file(entryFilepath(key));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_5);
+  stream << kMagicNumber_ << kVersion_;
+  stream << static_cast<quint16>(traj_set.traj_type) << relative;
+  writeTrajectoryList<double, double>(stream, traj_set.traj_platform);
+  writeTrajectoryList<double, double>(stream, traj_set.traj_cables_len);
+  writeTrajectoryList<int, qint32>(stream, traj_set.traj_motors_pos);
+  writeTrajectoryList<int, qint32>(stream, traj_set.traj_motors_vel);
+  writeTrajectoryList<short, qint16>(stream, traj_set.traj_motors_torque);
+  if (stream.status() != QDataStream::Ok)
+  {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
+void TrajectoryCache::clear() const { QDir(dirpath_).removeRecursively(); }
+
+//--------- Private functions --------------------------------------------------------//
+
+QString TrajectoryCache::entryFilepath(const QString& key) const
+{
+  return QString("%1/%2.bin").arg(dirpath_, key);
+}
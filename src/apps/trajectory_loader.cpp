@@ -0,0 +1,148 @@
+/**
+ * @file trajectory_loader.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in trajectory_loader.h.
+ */
+
+#include "apps/trajectory_loader.h"
+
+#include <QRunnable>
+#include <QThread>
+
+/**
+ * @brief The task loading a single file of a TrajectoryLoader.
+ */
+class TrajectoryLoadTask: public QRunnable
+{
+ public:
+  TrajectoryLoadTask(TrajectoryLoader* loader, const int index)
+    : loader_(loader), index_(index)
+  {}
+
+  void run() override { loader_->loadFile(index_); }
+
+ private:
+  TrajectoryLoader* loader_;
+  int index_;
+};
+
+TrajectoryLoader::TrajectoryLoader(QObject* parent /*= nullptr*/) : QObject(parent)
+{
+  pool_.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+TrajectoryLoader::~TrajectoryLoader()
+{
+  cancel();
+  wait();
+}
+
+//--------- Public functions ---------------------------------------------------------//
+
+bool TrajectoryLoader::start(const QVector<QString>& filepaths,
+                             const LoadFunction& load_fun)
+{
+  if (running_)
+    return false;
+  // Wait for skipped tasks of a previously canceled loading, if any
+  pool_.waitForDone();
+
+  // Results are unshared containers, so that workers can write their slots without
+  // triggering a detach
+  load_fun_   = load_fun;
+  filepaths_  = filepaths;
+  traj_sets_  = QVector<TrajectorySet>(filepaths.size());
+  relative_   = QVector<bool>(filepaths.size(), false);
+  errors_     = QVector<QString>(filepaths.size());
+  abort_      = false;
+  canceled_   = false;
+  files_done_ = 0;
+  failed_idx_ = -1;
+  if (filepaths.isEmpty())
+  {
+    emit completed(true);
+    return true;
+  }
+
+  running_ = true;
+  for (int i = 0; i < filepaths.size(); i++)
+    pool_.start(new TrajectoryLoadTask(this, i)); // auto-deleted by the pool
+  return true;
+}
+
+void TrajectoryLoader::cancel()
+{
+  if (!running_)
+    return;
+  canceled_ = true;
+  abort_    = true;
+}
+
+void TrajectoryLoader::wait() { pool_.waitForDone(); }
+
+QString TrajectoryLoader::failedFilepath() const
+{
+  return failed_idx_ < 0 ? QString() : filepaths_[failed_idx_];
+}
+
+QString TrajectoryLoader::failedError() const
+{
+  return failed_idx_ < 0 ? QString() : errors_[failed_idx_];
+}
+
+void TrajectoryLoader::takeResults(QVector<TrajectorySet>& traj_sets,
+                                   QVector<bool>& relative)
+{
+  traj_sets = std::move(traj_sets_);
+  relative  = std::move(relative_);
+  traj_sets_.clear();
+  relative_.clear();
+}
+
+//--------- Private slots ------------------------------------------------------------//
+
+void TrajectoryLoader::handleFileDone(const int index, const int status)
+{
+  if (!running_)
+    return;
+  if (status == FAILED && (failed_idx_ < 0 || index < failed_idx_))
+    failed_idx_ = index;
+  emit progress(++files_done_, filepaths_.size());
+  if (files_done_ < filepaths_.size())
+    return;
+
+  running_ = false;
+  if (canceled_ || failed_idx_ >= 0)
+  {
+    traj_sets_.clear();
+    relative_.clear();
+    emit completed(false);
+  }
+  else
+    emit completed(true);
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+void TrajectoryLoader::loadFile(const int index)
+{
+  // Runs on a worker thread, touching only its own slot of results
+  TaskStatus status = SKIPPED;
+  if (!abort_)
+  {
+    bool relative;
+    if (load_fun_(filepaths_.at(index), traj_sets_[index], relative, errors_[index]))
+    {
+      relative_[index] = relative;
+      status           = LOADED;
+    }
+    else
+    {
+      status = FAILED;
+      abort_ = true; // no point in loading the rest
+    }
+  }
+  QMetaObject::invokeMethod(this, "handleFileDone", Qt::QueuedConnection,
+                            Q_ARG(int, index), Q_ARG(int, status));
+}
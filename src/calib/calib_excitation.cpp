@@ -7,6 +7,13 @@
 
 #include "calib/calib_excitation.h"
 
+#include <fstream>
+#include <map>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
 //------------------------------------------------------------------------------------//
 //--------- CalibExcitationData class ------------------------------------------------//
 //------------------------------------------------------------------------------------//
@@ -27,25 +34,27 @@ std::ostream& operator<<(std::ostream& stream, const CalibExcitationData& data)
 
 // For static constexpr passed by reference we need a dummy definition no matter what
 constexpr char* CalibExcitation::kStatesStr[];
-const QString CalibExcitation::kExcitationTrajFilepath_ =
-  SRCDIR "resources/trajectories/excitation_traj.txt";
 
-CalibExcitation::CalibExcitation(QObject* parent, CableRobot* robot, const vect<grabcdpr::ActuatorParams>& params)
+CalibExcitation::CalibExcitation(QObject* parent, CableRobot* robot)
   : QObject(parent), StateMachine(ST_MAX_STATES), robot_ptr_(robot),
-    controller_single_drive_(robot->GetRtCycleTimeNsec())
+    controller_multi_drive_(robot->GetActiveMotorsID(), robot->GetRtCycleTimeNsec()),
+    controller_excitation_(robot->GetActiveMotorsID(), robot->GetRtCycleTimeNsec())
 {
   prev_state_ = ST_MAX_STATES;
   ExternalEvent(ST_IDLE);
 
-  controller_single_drive_.SetMotorTorqueSsErrTol(kTorqueSsErrTol_);
+  controller_multi_drive_.SetMotorTorqueSsErrTol(kTorqueSsErrTol_);
   active_actuators_id_ = robot_ptr_->GetActiveMotorsID();
   connect(this, SIGNAL(stopWaitingCmd()), robot_ptr_, SLOT(stopWaiting()));
 
-  traj_cables_len_.clear();
-  controller_joints_ptv_ =
-    new ControllerJointsPVT(params, robot->GetRtCycleTimeNsec(), this);
-  controller_joints_ptv_->SetMotorsID(active_actuators_id_);
-  connect(controller_joints_ptv_, SIGNAL(trajectoryCompleted()), this,
+  // By default, a gentle pulse on one cable after another, so that the robot is never
+  // over-constrained by simultaneous excitations
+  for (size_t i = 0; i < active_actuators_id_.size(); i++)
+  {
+    excitation_params_.push_back(ExcitationParams());
+    excitation_params_.back().delay = i * excitation_params_.back().duration;
+  }
+  connect(&controller_excitation_, SIGNAL(excitationCompleted()), this,
           SLOT(stopLogging()), Qt::ConnectionType::QueuedConnection);
 
   robot_ptr_->FlushDataLogs();
@@ -54,8 +63,8 @@ CalibExcitation::CalibExcitation(QObject* parent, CableRobot* robot, const vect<
 CalibExcitation::~CalibExcitation()
 {
   disconnect(this, SIGNAL(stopWaitingCmd()), robot_ptr_, SLOT(stopWaiting()));
-  if (controller_joints_ptv_ != nullptr)
-    delete controller_joints_ptv_;
+  disconnect(&controller_excitation_, SIGNAL(excitationCompleted()), this,
+             SLOT(stopLogging()));
 }
 
 //--------- External events ----------------------------------------------------------//
@@ -108,6 +117,100 @@ void CalibExcitation::changeControlMode(CalibExcitationData* data)
   // clang-format on
 }
 
+bool CalibExcitation::setExcitationParams(const vect<ExcitationParams>& params)
+{
+  CLOG(TRACE, "event") << "for " << params.size() << " cables";
+  if (params.size() != active_actuators_id_.size())
+  {
+    CLOG(WARNING, "event") << "Invalid excitations!";
+    return false;
+  }
+  excitation_params_ = params;
+  return true;
+}
+
+bool CalibExcitation::loadExcitationParams(const QString& filepath)
+{
+  CLOG(TRACE, "event") << "from '" << filepath << "'";
+  std::ifstream ifile(filepath.toStdString());
+  if (!ifile.is_open())
+  {
+    emit printToQConsole("ERROR: Could not open file '" + filepath + "'");
+    return false;
+  }
+
+  static const std::map<std::string, ExcitationType> kTypes = {
+    {"pulse", PULSE}, {"multisine", MULTISINE}, {"chirp", CHIRP}, {"prbs", PRBS}};
+  vect<ExcitationParams> params;
+  try
+  {
+    json root;
+    ifile >> root;
+    for (const json& excitation : root.at("excitations"))
+    {
+      // Missing fields keep their default value
+      ExcitationParams design;
+      design.type      = kTypes.at(excitation.value("type", std::string("pulse")));
+      design.amplitude = excitation.value("amplitude", design.amplitude);
+      design.offset    = excitation.value("offset", design.offset);
+      design.min_freq  = excitation.value("min_freq", design.min_freq);
+      design.max_freq  = excitation.value("max_freq", design.max_freq);
+      design.duration  = excitation.value("duration", design.duration);
+      design.fade_time = excitation.value("fade_time", design.fade_time);
+      design.rest_time = excitation.value("rest_time", design.rest_time);
+      design.delay     = excitation.value("delay", design.delay);
+      design.seed      = excitation.value("seed", design.seed);
+      params.push_back(design);
+    }
+  }
+  catch (json::exception&)
+  {
+    emit printToQConsole("ERROR: Invalid excitation file '" + filepath + "'");
+    return false;
+  }
+  catch (std::out_of_range&)
+  {
+    emit printToQConsole("ERROR: Unknown excitation type in file '" + filepath + "'");
+    return false;
+  }
+  if (!setExcitationParams(params))
+  {
+    emit printToQConsole(QString("ERROR: Excitation file must hold one excitation per "
+                                 "active cable, i.e. %1")
+                           .arg(active_actuators_id_.size()));
+    return false;
+  }
+  emit printToQConsole("Excitations loaded from '" + filepath + "'");
+  return true;
+}
+
+bool CalibExcitation::identifyWinchesFriction(const QString& log_filepath)
+{
+  CLOG(TRACE, "event") << "from '" << log_filepath << "'";
+  WinchesTorqueControl winches_controller(robot_ptr_->GetRobotParams().actuators);
+  const vect<id_t> identified =
+    winches_controller.identifyFrictionParams(log_filepath.toStdString());
+  if (identified.empty())
+  {
+    emit printToQConsole("ERROR: Could not identify winches friction from '" +
+                         log_filepath + "'");
+    return false;
+  }
+  const std::string& filepath = WinchesTorqueControl::kDefaultFrictionFilepath;
+  if (!winches_controller.saveFrictionParams(filepath))
+  {
+    emit printToQConsole("ERROR: Could not save winches friction to '" +
+                         QString::fromStdString(filepath) + "'");
+    return false;
+  }
+  QStringList ids;
+  for (const id_t id : identified)
+    ids << QString::number(id);
+  emit printToQConsole(QString("Friction of winches %1 identified and saved to '%2'")
+                         .arg(ids.join(", "), QString::fromStdString(filepath)));
+  return true;
+}
+
 void CalibExcitation::exciteAndLog()
 {
   CLOG(TRACE, "event");
@@ -178,6 +281,7 @@ STATE_DEFINE(CalibExcitation, Idle, NoEventData)
 
 GUARD_DEFINE(CalibExcitation, GuardEnabled, NoEventData)
 {
+  TRACE_SCOPE("guard", "CalibExcitation::GuardEnabled");
   robot_ptr_->EnableMotors();
 
   grabrt::ThreadClock clock(grabrt::Sec2NanoSec(CableRobot::kCycleWaitTimeSec));
@@ -204,7 +308,7 @@ STATE_DEFINE(CalibExcitation, Enabled, NoEventData)
     InternalEvent(ST_IDLE);
   qmutex_.unlock();
 
-  robot_ptr_->SetController(&controller_single_drive_);
+  robot_ptr_->SetController(&controller_multi_drive_);
   emit stateChanged(ST_ENABLED);
 }
 
@@ -213,24 +317,17 @@ STATE_DEFINE(CalibExcitation, PosControl, NoEventData)
   printStateTransition(prev_state_, ST_POS_CONTROL);
   prev_state_ = ST_POS_CONTROL;
 
-  RetVal ret = RetVal::OK;
+  // Hold all motors in current position
+  vect<int32_t> motors_pos;
   for (const id_t id : active_actuators_id_)
-  {
-    int motor_pos = robot_ptr_->GetActuatorStatus(id).motor_position;
-    pthread_mutex_lock(&robot_ptr_->Mutex());
-    controller_single_drive_.SetMotorID(id);
-    controller_single_drive_.SetMode(ControlMode::MOTOR_POSITION);
-    controller_single_drive_.SetMotorPosTarget(motor_pos, false);
-    pthread_mutex_unlock(&robot_ptr_->Mutex());
-    // Wait until each motor reached user-given initial torque setpoint
-    ret = robot_ptr_->WaitUntilTargetReached();
-    if (ret != RetVal::OK)
-    {
-      emit printToQConsole(
-        QString("WARNING: Could not switch motor %1 to position control mode").arg(id));
-      break;
-    }
-  }
+    motors_pos.push_back(robot_ptr_->GetActuatorStatus(id).motor_position);
+  pthread_mutex_lock(&robot_ptr_->Mutex());
+  controller_multi_drive_.SetMode(ControlMode::MOTOR_POSITION);
+  controller_multi_drive_.SetMotorsPosTarget(motors_pos, false);
+  pthread_mutex_unlock(&robot_ptr_->Mutex());
+  // Wait until all motors switched to position control mode
+  if (robot_ptr_->WaitUntilTargetReached() != RetVal::OK)
+    emit printToQConsole("WARNING: Could not switch all motors to position control mode");
 
   emit stateChanged(ST_POS_CONTROL);
 }
@@ -240,23 +337,14 @@ STATE_DEFINE(CalibExcitation, TorqueControl, CalibExcitationData)
   printStateTransition(prev_state_, ST_TORQUE_CONTROL);
   prev_state_ = ST_TORQUE_CONTROL;
 
-  RetVal ret = RetVal::OK;
-  for (const id_t id : active_actuators_id_)
-  {
-    pthread_mutex_lock(&robot_ptr_->Mutex());
-    controller_single_drive_.SetMotorID(id);
-    controller_single_drive_.SetMode(ControlMode::MOTOR_TORQUE);
-    controller_single_drive_.SetMotorTorqueTarget(data->torque);
-    pthread_mutex_unlock(&robot_ptr_->Mutex());
-    // Wait until each motor reached user-given initial torque setpoint
-    ret = robot_ptr_->WaitUntilTargetReached();
-    if (ret != RetVal::OK)
-    {
-      emit printToQConsole(
-        QString("WARNING: Could not switch motor %1 to torque control mode").arg(id));
-      break;
-    }
-  }
+  pthread_mutex_lock(&robot_ptr_->Mutex());
+  controller_multi_drive_.SetMode(ControlMode::MOTOR_TORQUE);
+  controller_multi_drive_.SetMotorsTorqueTarget(
+    vect<int16_t>(active_actuators_id_.size(), data->torque));
+  pthread_mutex_unlock(&robot_ptr_->Mutex());
+  // Wait until all motors reached user-given initial torque setpoint
+  if (robot_ptr_->WaitUntilTargetReached() != RetVal::OK)
+    emit printToQConsole("WARNING: Could not switch all motors to torque control mode");
 
   emit stateChanged(ST_TORQUE_CONTROL);
 }
@@ -267,85 +355,34 @@ STATE_DEFINE(CalibExcitation, Logging, NoEventData)
   prev_state_ = ST_LOGGING;
   emit stateChanged(ST_LOGGING);
 
-  traj_cables_len_.clear();
-  if (!readTrajectories(kExcitationTrajFilepath_))
+  if (!controller_excitation_.SetExcitations(excitation_params_))
   {
-    printToQConsole("WARNING: Could not read trjectories file");
+    emit printToQConsole("WARNING: Could not set excitation signals");
     InternalEvent(ST_POS_CONTROL);
     return;
   }
 
-  controller_joints_ptv_->setCablesLenTrajectories(traj_cables_len_);
   robot_ptr_->StartRtLogging(kRtCycleMultiplier_);
-  robot_ptr_->SetController(controller_joints_ptv_);
-  emit printToQConsole("Start logging...");
+  robot_ptr_->SetController(&controller_excitation_);
+  emit printToQConsole(QString("Start logging for %1 sec...")
+                         .arg(controller_excitation_.GetDuration()));
 }
 
 EXIT_DEFINE(CalibExcitation, ExitLogging)
 {
   robot_ptr_->StopRtLogging();
-  robot_ptr_->SetController(&controller_single_drive_);
+  robot_ptr_->SetController(&controller_multi_drive_);
   emit printToQConsole("Logging stopped");
 }
 
 //--------- Private functions --------------------------------------------------------//
 
-bool CalibExcitation::readTrajectories(const QString& ifilepath)
-{
-  CLOG(TRACE, "event") << "from '" << ifilepath << "'";
-  QFile ifile(ifilepath);
-  if (!ifile.open(QIODevice::ReadOnly | QIODevice::Text))
-  {
-    CLOG(ERROR, "event") << "Could not open trajectory file";
-    return false;
-  }
-
-  // Read header yielding information about trajectory type and involved motors
-  QTextStream s(&ifile);
-  QStringList header = s.readLine().split(" ");
-  bool relative      = static_cast<bool>(header[1].toUShort());
-  vect<id_t> motors_id;
-  for (int i = 2; i < header.size(); i++)
-    motors_id.push_back(header[i].toUInt());
-
-  // Fill trajectories accordingly reading text body line-by-line
-  setCablesLenTraj(relative, motors_id, s);
-  CLOG(INFO, "event") << "Trajectory parsed";
-  return true;
-}
-
-void CalibExcitation::setCablesLenTraj(const bool relative, const vect<id_t>& motors_id,
-                                       QTextStream& s)
-{
-  CLOG(INFO, "event") << QString("File contains %1 cables length trajectories")
-                           .arg(relative ? "relative" : "absolute");
-  traj_cables_len_.resize(motors_id.size());
-  vectD current_cables_len(traj_cables_len_.size());
-  for (size_t i = 0; i < motors_id.size(); i++)
-  {
-    traj_cables_len_[i].id = motors_id[i];
-    current_cables_len[i]  = robot_ptr_->GetActuatorStatus(motors_id[i]).cable_length;
-  }
-  while (!s.atEnd())
-  {
-    QStringList line = s.readLine().split(" ");
-    for (auto& traj : traj_cables_len_)
-      traj.timestamps.push_back(line[0].toDouble());
-    for (int i = 1; i < line.size(); i++)
-    {
-      traj_cables_len_[static_cast<size_t>(i) - 1].values.push_back(line[i].toDouble());
-      if (relative)
-        traj_cables_len_[static_cast<size_t>(i) - 1].values.back() +=
-          current_cables_len[static_cast<size_t>(i) - 1];
-    }
-  }
-}
-
 void CalibExcitation::printStateTransition(const States current_state,
                                            const States new_state) const
 {
   if (current_state == new_state)
     return;
+  TRACE_STATE(trace_track_, kStatesStr[new_state]);
   QString msg;
   if (current_state != ST_MAX_STATES)
     msg = QString("Manual control app state transition: %1 --> %2")
@@ -0,0 +1,312 @@
+/**
+ * @file control_stages.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of classes declared in control_stages.h.
+ */
+
+#include "ctrl/control_stages.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+const std::string LimitClampStage::kDefaultLimitsFilepath =
+  SRCDIR "config/joint_limits.json";
+
+//------------------------------------------------------------------------------------//
+//--------- MotorSlots class ---------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+MotorSlots::MotorSlots(const vect<id_t>& motors_id) : size_(motors_id.size())
+{
+  id_t max_id = 0;
+  for (const id_t motor_id : motors_id)
+    max_id = std::max(max_id, motor_id);
+  slots_.assign(motors_id.empty() ? 0 : max_id + 1, size_);
+  for (size_t i = 0; i < motors_id.size(); i++)
+    slots_[motors_id[i]] = i;
+}
+
+//------------------------------------------------------------------------------------//
+//--------- LimitClampStage class ----------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+LimitClampStage::LimitClampStage(const vect<id_t>& motors_id)
+  : slots_(motors_id),
+    min_length_(motors_id.size(), std::numeric_limits<double>::lowest()),
+    max_length_(motors_id.size(), std::numeric_limits<double>::max()),
+    min_pos_(motors_id.size(), INT32_MIN), max_pos_(motors_id.size(), INT32_MAX),
+    max_speed_(motors_id.size(), kAbsMaxMotorSpeed),
+    max_acc_(motors_id.size(), std::numeric_limits<double>::max()),
+    max_torque_(motors_id.size(), kAbsMaxMotorTorque)
+{}
+
+bool LimitClampStage::LoadLimits(const std::string& filepath)
+{
+  std::ifstream ifile(filepath);
+  if (!ifile.is_open())
+    return false;
+
+  try
+  {
+    json root;
+    ifile >> root;
+    for (const json& motor : root.at("motors"))
+    {
+      const id_t id = motor.at("id");
+      if (motor.count("cable_length"))
+        SetCableLenLimits(id, motor["cable_length"].at(0), motor["cable_length"].at(1));
+      if (motor.count("motor_position"))
+        SetMotorPosLimits(id, motor["motor_position"].at(0),
+                          motor["motor_position"].at(1));
+      if (motor.count("motor_speed"))
+        SetMotorSpeedLimit(id, motor["motor_speed"]);
+      if (motor.count("motor_acceleration"))
+        SetMotorAccLimit(id, motor["motor_acceleration"]);
+      if (motor.count("motor_torque"))
+        SetMotorTorqueLimit(id, motor["motor_torque"]);
+    }
+  }
+  catch (json::exception&)
+  {
+    return false;
+  }
+  return true;
+}
+
+void LimitClampStage::SetCableLenLimits(const id_t motor_id, const double min,
+                                        const double max)
+{
+  const size_t slot = slots_.Slot(motor_id);
+  if (slot == slots_.Size())
+    return;
+  min_length_[slot] = min;
+  max_length_[slot] = max;
+}
+
+void LimitClampStage::SetMotorPosLimits(const id_t motor_id, const int32_t min,
+                                        const int32_t max)
+{
+  const size_t slot = slots_.Slot(motor_id);
+  if (slot == slots_.Size())
+    return;
+  min_pos_[slot] = min;
+  max_pos_[slot] = max;
+}
+
+void LimitClampStage::SetMotorSpeedLimit(const id_t motor_id, const int32_t abs_max)
+{
+  const size_t slot = slots_.Slot(motor_id);
+  if (slot < slots_.Size())
+    max_speed_[slot] = std::abs(abs_max);
+}
+
+void LimitClampStage::SetMotorAccLimit(const id_t motor_id, const double abs_max)
+{
+  const size_t slot = slots_.Slot(motor_id);
+  if (slot < slots_.Size())
+    max_acc_[slot] = std::abs(abs_max);
+}
+
+void LimitClampStage::SetMotorTorqueLimit(const id_t motor_id, const int16_t abs_max)
+{
+  const size_t slot = slots_.Slot(motor_id);
+  if (slot < slots_.Size())
+    max_torque_[slot] = static_cast<int16_t>(std::abs(abs_max));
+}
+
+void LimitClampStage::GetCableLenLimits(const id_t motor_id, double& min,
+                                        double& max) const
+{
+  const size_t slot = slots_.Slot(motor_id);
+  min               = slot < slots_.Size() ? min_length_[slot] : 0.0;
+  max               = slot < slots_.Size() ? max_length_[slot] : 0.0;
+}
+
+void LimitClampStage::GetMotorPosLimits(const id_t motor_id, int32_t& min,
+                                        int32_t& max) const
+{
+  const size_t slot = slots_.Slot(motor_id);
+  min               = slot < slots_.Size() ? min_pos_[slot] : 0;
+  max               = slot < slots_.Size() ? max_pos_[slot] : 0;
+}
+
+int32_t LimitClampStage::GetMotorSpeedLimit(const id_t motor_id) const
+{
+  const size_t slot = slots_.Slot(motor_id);
+  return slot < slots_.Size() ? max_speed_[slot] : 0;
+}
+
+double LimitClampStage::GetMotorAccLimit(const id_t motor_id) const
+{
+  const size_t slot = slots_.Slot(motor_id);
+  return slot < slots_.Size() ? max_acc_[slot] : 0.0;
+}
+
+int16_t LimitClampStage::GetMotorTorqueLimit(const id_t motor_id) const
+{
+  const size_t slot = slots_.Slot(motor_id);
+  return slot < slots_.Size() ? max_torque_[slot] : 0;
+}
+
+void LimitClampStage::Apply(ControlAction* actions, const ActuatorStatus*,
+                            const size_t num)
+{
+  for (size_t i = 0; i < num; i++)
+  {
+    ControlAction& action = actions[i];
+    const size_t slot     = slots_.Slot(action.motor_id);
+    if (slot == slots_.Size())
+    {
+      action.ctrl_mode = NONE;
+      continue;
+    }
+    switch (action.ctrl_mode)
+    {
+      case CABLE_LENGTH:
+        action.cable_length =
+          std::min(std::max(action.cable_length, min_length_[slot]), max_length_[slot]);
+        break;
+      case MOTOR_POSITION:
+        action.motor_position =
+          std::min(std::max(action.motor_position, min_pos_[slot]), max_pos_[slot]);
+        break;
+      case MOTOR_SPEED:
+        action.motor_speed =
+          std::min(std::max(action.motor_speed, -max_speed_[slot]), max_speed_[slot]);
+        break;
+      case MOTOR_TORQUE:
+        action.motor_torque = std::min(
+          std::max(action.motor_torque, static_cast<int16_t>(-max_torque_[slot])),
+          max_torque_[slot]);
+        break;
+      case NONE:
+        break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+//--------- RateLimitStage class -----------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+RateLimitStage::RateLimitStage(const vect<id_t>& motors_id, const uint32_t period_nsec)
+  : slots_(motors_id), period_sec_(period_nsec * 0.000000001),
+    max_step_(motors_id.size()), prev_setpoint_(motors_id.size(), 0.0),
+    prev_mode_(motors_id.size(), NONE), prev_cycle_(motors_id.size(), 0)
+{
+  for (std::array<double, NONE>& max_step : max_step_)
+  {
+    max_step.fill(std::numeric_limits<double>::infinity());
+    max_step[MOTOR_POSITION] = kAbsMaxMotorSpeed * period_sec_;
+  }
+}
+
+void RateLimitStage::SetCableLenRate(const id_t motor_id, const double max_rate)
+{
+  SetRate(motor_id, CABLE_LENGTH, max_rate);
+}
+
+void RateLimitStage::SetMotorPosRate(const id_t motor_id, const double max_rate)
+{
+  SetRate(motor_id, MOTOR_POSITION, max_rate);
+}
+
+void RateLimitStage::SetMotorSpeedRate(const id_t motor_id, const double max_rate)
+{
+  SetRate(motor_id, MOTOR_SPEED, max_rate);
+}
+
+void RateLimitStage::SetMotorTorqueRate(const id_t motor_id, const double max_rate)
+{
+  SetRate(motor_id, MOTOR_TORQUE, max_rate);
+}
+
+void RateLimitStage::Apply(ControlAction* actions, const ActuatorStatus* status,
+                           const size_t num)
+{
+  cycle_++;
+  for (size_t i = 0; i < num; i++)
+  {
+    ControlAction& action = actions[i];
+    const size_t slot     = slots_.Slot(action.motor_id);
+    if (slot == slots_.Size())
+    {
+      action.ctrl_mode = NONE;
+      continue;
+    }
+    const ControlMode mode = action.ctrl_mode;
+    if (mode == NONE)
+    {
+      prev_mode_[slot] = NONE;
+      continue;
+    }
+
+    double setpoint = 0.0;
+    double measured = 0.0;
+    switch (mode)
+    {
+      case CABLE_LENGTH:
+        setpoint = action.cable_length;
+        measured = status[i].cable_length;
+        break;
+      case MOTOR_POSITION:
+        setpoint = action.motor_position;
+        measured = status[i].motor_position;
+        break;
+      case MOTOR_SPEED:
+        setpoint = action.motor_speed;
+        measured = status[i].motor_speed;
+        break;
+      case MOTOR_TORQUE:
+        setpoint = action.motor_torque;
+        measured = status[i].motor_torque;
+        break;
+      case NONE:
+        break;
+    }
+    // Restart from current motor status if control was just resumed
+    if (prev_mode_[slot] != mode || prev_cycle_[slot] + 1 != cycle_)
+      prev_setpoint_[slot] = measured;
+
+    const double max_step = max_step_[slot][mode];
+    setpoint              = prev_setpoint_[slot] +
+               std::min(std::max(setpoint - prev_setpoint_[slot], -max_step), max_step);
+    prev_setpoint_[slot] = setpoint;
+    prev_mode_[slot]     = mode;
+    prev_cycle_[slot]    = cycle_;
+
+    switch (mode)
+    {
+      case CABLE_LENGTH:
+        action.cable_length = setpoint;
+        break;
+      case MOTOR_POSITION:
+        action.motor_position = static_cast<int32_t>(round(setpoint));
+        break;
+      case MOTOR_SPEED:
+        action.motor_speed = static_cast<int32_t>(round(setpoint));
+        break;
+      case MOTOR_TORQUE:
+        action.motor_torque = static_cast<int16_t>(round(setpoint));
+        break;
+      case NONE:
+        break;
+    }
+  }
+}
+
+void RateLimitStage::SetRate(const id_t motor_id, const ControlMode mode,
+                             const double max_rate)
+{
+  const size_t slot = slots_.Slot(motor_id);
+  if (slot < slots_.Size() && mode < NONE)
+    max_step_[slot][mode] = std::abs(max_rate) * period_sec_;
+}
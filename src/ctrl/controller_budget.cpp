@@ -0,0 +1,119 @@
+/**
+ * @file controller_budget.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in controller_budget.h.
+ */
+
+#include "ctrl/controller_budget.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr size_t ControllerBudget::kWindowSize_;
+constexpr uint64_t ControllerBudget::kBinNsec_;
+constexpr size_t ControllerBudget::kBinsNum_;
+
+ControllerBudget::ControllerBudget(const uint64_t budget_nsec,
+                                   const uint32_t max_overruns)
+  : budget_nsec_(budget_nsec), max_overruns_(max_overruns > 0 ? max_overruns : 1)
+{
+  Reset();
+}
+
+//--------- Public functions ---------------------------------------------------------//
+
+ControllerBudget::Verdict ControllerBudget::Record(const uint64_t elapsed_nsec)
+{
+  // Update rolling window, dropping its oldest sample once full
+  const uint64_t calls = calls_.load(std::memory_order_relaxed);
+  const uint16_t bin =
+    static_cast<uint16_t>(std::min<uint64_t>(elapsed_nsec / kBinNsec_, kBinsNum_ - 1));
+  if (calls >= kWindowSize_)
+    histogram_[window_[window_head_]].fetch_sub(1, std::memory_order_relaxed);
+  window_[window_head_] = bin;
+  window_head_          = (window_head_ + 1) % kWindowSize_;
+  histogram_[bin].fetch_add(1, std::memory_order_relaxed);
+
+  calls_.store(calls + 1, std::memory_order_relaxed);
+  if (elapsed_nsec > max_nsec_.load(std::memory_order_relaxed))
+    max_nsec_.store(elapsed_nsec, std::memory_order_relaxed);
+
+  if (elapsed_nsec <= budget_nsec_.load(std::memory_order_relaxed))
+  {
+    streak_ = 0;
+    return WITHIN_BUDGET;
+  }
+
+  overruns_.fetch_add(1, std::memory_order_relaxed);
+  if (++streak_ > max_streak_.load(std::memory_order_relaxed))
+    max_streak_.store(streak_, std::memory_order_relaxed);
+  if (streak_ == 1)
+    overrun_warning_ = true;
+  if (streak_ == max_overruns_.load(std::memory_order_relaxed))
+  {
+    fallback_engaged_ = true;
+    fallback_notice_  = true;
+    return EXHAUSTED;
+  }
+  return OVERRUN;
+}
+
+void ControllerBudget::Reset()
+{
+  for (size_t i = 0; i < kBinsNum_; i++)
+    histogram_[i] = 0;
+  window_head_ = 0;
+  calls_       = 0;
+  overruns_    = 0;
+  max_streak_  = 0;
+  max_nsec_    = 0;
+  streak_      = 0;
+
+  fallback_engaged_ = false;
+  overrun_warning_  = false;
+  fallback_notice_  = false;
+}
+
+BudgetStats ControllerBudget::GetStats() const
+{
+  BudgetStats stats;
+  stats.calls            = calls_;
+  stats.overruns         = overruns_;
+  stats.max_streak       = max_streak_;
+  stats.max_nsec         = max_nsec_;
+  stats.budget_nsec      = budget_nsec_;
+  stats.fallback_engaged = fallback_engaged_;
+
+  // Percentiles are given as upper edge of the bin they fall in
+  uint64_t window_count = 0;
+  size_t max_bin        = 0;
+  for (size_t i = 0; i < kBinsNum_; i++)
+  {
+    const uint32_t count = histogram_[i].load(std::memory_order_relaxed);
+    window_count += count;
+    if (count > 0)
+      max_bin = i;
+  }
+  if (window_count == 0)
+    return stats;
+
+  const uint64_t p99_rank = static_cast<uint64_t>(ceil(0.99 * window_count));
+  uint64_t cumulative     = 0;
+  for (size_t i = 0; i < kBinsNum_; i++)
+  {
+    cumulative += histogram_[i].load(std::memory_order_relaxed);
+    if (cumulative >= p99_rank)
+    {
+      stats.window_p99_nsec = (i + 1) * kBinNsec_;
+      break;
+    }
+  }
+  stats.window_max_nsec = (max_bin + 1) * kBinNsec_;
+  // Slowest bin is open-ended: the best estimate is the all-time worst case
+  if (max_bin == kBinsNum_ - 1)
+    stats.window_max_nsec = stats.max_nsec;
+  if (stats.window_p99_nsec > kBinsNum_ * kBinNsec_ - kBinNsec_)
+    stats.window_p99_nsec = stats.max_nsec;
+  return stats;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file controller_excitation.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class present in controller_excitation.h.
+ */
+
+#include "ctrl/controller_excitation.h"
+
+#include <algorithm>
+
+constexpr int ControllerExcitation::kProgressPollIntervalMsec_;
+
+ControllerExcitation::ControllerExcitation(const vect<id_t>& motors_id,
+                                           const uint32_t cycle_t_nsec, QObject* parent)
+  : QObject(parent), ControllerBase(motors_id), new_excitation_(false),
+    progress_timer_(this), completed_(true), completions_count_(0),
+    last_completions_count_(0)
+{
+  cycle_time_ = grabrt::NanoSec2Sec(cycle_t_nsec);
+
+  // Timer is started only while an excitation is being executed
+  connect(&progress_timer_, SIGNAL(timeout()), this, SLOT(pollProgress()));
+}
+
+ControllerExcitation::~ControllerExcitation()
+{
+  progress_timer_.stop();
+  disconnect(&progress_timer_, SIGNAL(timeout()), this, SLOT(pollProgress()));
+}
+
+//--------- Public functions ---------------------------------------------------------//
+
+bool ControllerExcitation::SetExcitations(const vect<ExcitationParams>& params)
+{
+  // Safety check: all motors must have an excitation
+  if (params.size() != motors_id_.size())
+  {
+    CLOG(WARNING, "event") << "Invalid excitations!";
+    return false;
+  }
+  generators_.clear();
+  generators_.reserve(params.size());
+  for (const ExcitationParams& excitation : params)
+    generators_.push_back(ExcitationGenerator(cycle_time_, excitation));
+  init_cables_len_.assign(params.size(), 0.0);
+  new_excitation_ = true;
+  completed_      = false;
+  SetMode(ControlMode::CABLE_LENGTH);
+  progress_timer_.start(kProgressPollIntervalMsec_);
+  return true;
+}
+
+double ControllerExcitation::GetDuration() const
+{
+  double duration = 0.0;
+  for (const ExcitationGenerator& generator : generators_)
+    duration = std::max(duration, generator.Duration());
+  return duration;
+}
+
+vect<ControlAction>
+ControllerExcitation::CalcCtrlActions(const grabcdpr::RobotVars&,
+                                      const vect<ActuatorStatus>& actuators_status)
+{
+  // Excitations are relative to cable lengths at start
+  if (new_excitation_)
+  {
+    new_excitation_ = false;
+    for (size_t i = 0; i < motors_id_.size(); i++)
+      for (const ActuatorStatus& status : actuators_status)
+        if (status.id == motors_id_[i])
+        {
+          init_cables_len_[i] = status.cable_length;
+          break;
+        }
+  }
+
+  vect<ControlAction> actions(modes_.size());
+  bool done = true;
+  for (size_t i = 0; i < actions.size(); i++)
+  {
+    actions[i].motor_id  = motors_id_[i];
+    actions[i].ctrl_mode = i < generators_.size() ? modes_[i] : NONE;
+    if (actions[i].ctrl_mode != CABLE_LENGTH)
+    {
+      actions[i].ctrl_mode = NONE;
+      continue;
+    }
+    actions[i].cable_length = init_cables_len_[i] + generators_[i].Next();
+    done &= generators_[i].Done();
+  }
+
+  // Only publish to atomics here: signals are emitted by pollProgress() in Qt thread.
+  if (done && !completed_)
+  {
+    completed_ = true;
+    completions_count_.fetch_add(1, std::memory_order_release);
+  }
+  return actions;
+}
+
+//--------- Private slots ------------------------------------------------------------//
+
+void ControllerExcitation::pollProgress()
+{
+  const uint completions_count = completions_count_.load(std::memory_order_acquire);
+  if (completions_count != last_completions_count_)
+  {
+    last_completions_count_ = completions_count;
+    // Stop before notifying, since a new excitation may be set right away
+    progress_timer_.stop();
+    emit excitationCompleted();
+  }
+}
@@ -7,11 +7,16 @@
 
 #include "ctrl/controller_joints_pvt.h"
 
+#include <type_traits>
+
+constexpr int ControllerJointsPVT::kProgressPollIntervalMsec_;
 constexpr double ControllerJointsPVT::kMinArrestTime_;
 
 ControllerJointsPVT::ControllerJointsPVT(const vect<grabcdpr::ActuatorParams>& params,
                                          const uint32_t cycle_t_nsec, QObject* parent)
-  : QObject(parent), ControllerBase(), winches_controller_(params)
+  : QObject(parent), ControllerBase(), progress_timer_(this), progress_percent_(-1),
+    progress_ts_(0.0), completions_count_(0), last_progress_percent_(-1),
+    last_progress_ts_(0.0), last_completions_count_(0), winches_controller_(params)
 {
   motors_vel_.resize(params.size());
   cycle_time_ = grabrt::NanoSec2Sec(cycle_t_nsec);
@@ -19,7 +24,18 @@ ControllerJointsPVT::ControllerJointsPVT(const vect<grabcdpr::ActuatorParams>& p
 
   traj_time_         = 0.0;
   true_traj_time_    = 0.0;
+  time_rate_         = 1.0;
   stop_request_time_ = 0.0;
+  lead_time_         = 0.0; // feedforward disabled until lead time is identified
+
+  // Timer is started only while a trajectory is being followed
+  connect(&progress_timer_, SIGNAL(timeout()), this, SLOT(pollProgress()));
+}
+
+ControllerJointsPVT::~ControllerJointsPVT()
+{
+  progress_timer_.stop();
+  disconnect(&progress_timer_, SIGNAL(timeout()), this, SLOT(pollProgress()));
 }
 
 //--------- Public functions ---------------------------------------------------------//
@@ -30,8 +46,10 @@ bool ControllerJointsPVT::setCablesLenTrajectories(const vect<TrajectoryD>& traj
     return false;
   reset();
   traj_cables_len_ = trajectories;
+  computeFeedforwards(traj_cables_len_);
   SetMode(ControlMode::CABLE_LENGTH);
   target_flags_.set(LENGTH);
+  progress_timer_.start(kProgressPollIntervalMsec_);
   return true;
 }
 
@@ -41,8 +59,10 @@ bool ControllerJointsPVT::setMotorsPosTrajectories(const vect<TrajectoryI>& traj
     return false;
   reset();
   traj_motors_pos_ = trajectories;
+  computeFeedforwards(traj_motors_pos_);
   SetMode(ControlMode::MOTOR_POSITION);
   target_flags_.set(POSITION);
+  progress_timer_.start(kProgressPollIntervalMsec_);
   return true;
 }
 
@@ -54,6 +74,7 @@ bool ControllerJointsPVT::setMotorsVelTrajectories(const vect<TrajectoryI>& traj
   traj_motors_vel_ = trajectories;
   SetMode(ControlMode::MOTOR_SPEED);
   target_flags_.set(SPEED);
+  progress_timer_.start(kProgressPollIntervalMsec_);
   return true;
 }
 
@@ -66,6 +87,7 @@ bool ControllerJointsPVT::setMotorsTorqueTrajectories(
   traj_motors_torque_ = trajectories;
   SetMode(ControlMode::MOTOR_TORQUE);
   target_flags_.set(TORQUE);
+  progress_timer_.start(kProgressPollIntervalMsec_);
   return true;
 }
 
@@ -97,7 +119,9 @@ ControllerJointsPVT::CalcCtrlActions(const grabcdpr::RobotVars &,
                                      const vect<ActuatorStatus>& actuators_status)
 {
   // Possibly apply smooth resume/stop
+  const double prev_traj_time = traj_time_;
   processTrajTime();
+  time_rate_ = std::max(0.0, (traj_time_ - prev_traj_time) / cycle_time_);
   // Collect motors speed for possible arrest/resume time computation
   for (ulong i = 0; i < actuators_status.size(); i++)
     motors_vel_[i] = actuators_status[i].motor_speed;
@@ -145,6 +169,30 @@ ControllerJointsPVT::CalcCtrlActions(const grabcdpr::RobotVars &,
   return actions;
 }
 
+//--------- Private slots ------------------------------------------------------------//
+
+void ControllerJointsPVT::pollProgress()
+{
+  const uint completions_count = completions_count_.load(std::memory_order_acquire);
+  const int progress_percent   = progress_percent_.load(std::memory_order_relaxed);
+  const double progress_ts     = progress_ts_.load(std::memory_order_relaxed);
+
+  if (progress_percent >= 0 && (progress_percent != last_progress_percent_ ||
+                                progress_ts != last_progress_ts_))
+  {
+    last_progress_percent_ = progress_percent;
+    last_progress_ts_      = progress_ts;
+    emit trajectoryProgressStatus(progress_percent, progress_ts);
+  }
+  if (completions_count != last_completions_count_)
+  {
+    last_completions_count_ = completions_count;
+    // Stop before notifying, since the next trajectory may be set right away
+    progress_timer_.stop();
+    emit trajectoryCompleted();
+  }
+}
+
 //--------- Private functions --------------------------------------------------------//
 
 void ControllerJointsPVT::processTrajTime()
@@ -186,18 +234,26 @@ void ControllerJointsPVT::processTrajTime()
     traj_time_ = true_traj_time_;
 }
 
+template <typename T>
+void ControllerJointsPVT::computeFeedforwards(const vect<Trajectory<T>>& trajectories)
+{
+  feedforwards_.resize(trajectories.size());
+  for (size_t i = 0; i < trajectories.size(); i++)
+    feedforwards_[i].Compute(trajectories[i]);
+}
+
 template <typename T>
 T ControllerJointsPVT::getTrajectoryPointValue(const id_t id,
                                                const vect<Trajectory<T>>& trajectories,
                                                const ControlMode mode)
 {
-  static const ulong kProgressTriggerCounts = 200 * motors_id_.size();
-
   WayPoint<T> waypoint;
   double progress = -1;
   bool stop       = true;
-  for (const Trajectory<T>& traj : trajectories)
+  double lead     = 0.0;
+  for (size_t i = 0; i < trajectories.size(); i++)
   {
+    const Trajectory<T>& traj = trajectories[i];
     if (traj.id != id)
       continue;
     if (resume_request_ || stop_request_)
@@ -217,29 +273,38 @@ T ControllerJointsPVT::getTrajectoryPointValue(const id_t id,
       waypoint = traj.waypointFromRelTime(traj_time_, cycle_time_);
     progress = waypoint.ts / traj.timestamps.back();
     stop &= progress >= 1.0;
+    if ((mode == CABLE_LENGTH || mode == MOTOR_POSITION) && i < feedforwards_.size())
+      lead = feedforwards_[i].Lead(waypoint.ts, lead_time_, time_rate_);
     break;
   }
 
-  if (stop)
+  // Only publish to atomics here: signals are emitted by pollProgress() in Qt thread.
+  if (stop && !stop_)
   {
     stop_ = true;
-    emit trajectoryCompleted();
+    completions_count_.fetch_add(1, std::memory_order_release);
+  }
+  if (progress > 0 && !stop_request_)
+  {
+    progress_percent_.store(qRound(progress * 100.), std::memory_order_relaxed);
+    progress_ts_.store(waypoint.ts, std::memory_order_relaxed);
   }
-  if (progress > 0 && (progress_counter_++ % kProgressTriggerCounts == 0) &&
-      !stop_request_)
-    emit trajectoryProgressStatus(qRound(progress * 100.), waypoint.ts);
-  return waypoint.value;
+  if (lead == 0.0)
+    return waypoint.value;
+  const double value = waypoint.value + lead;
+  return static_cast<T>(std::is_integral<T>::value ? round(value) : value);
 }
 
 void ControllerJointsPVT::reset()
 {
   target_flags_.reset();
+  feedforwards_.clear();
   stop_             = false;
   stop_request_     = false;
   resume_request_   = false;
   new_trajectory_   = true;
-  progress_counter_ = 0;
   arrest_time_ = -1.0;
+  progress_percent_.store(-1, std::memory_order_relaxed);
   time_since_stop_request_ = -1.0;
 }
 
@@ -0,0 +1,276 @@
+/**
+ * @file controller_multidrive.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing definitions of derived class declared in
+ * controller_multidrive.h.
+ */
+
+#include "ctrl/controller_multidrive.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr int16_t ControllerMultiDrive::kDefaultTorqueSsErrTol_;
+
+ControllerMultiDrive::ControllerMultiDrive(const uint32_t period_nsec)
+  : ControllerBase(), period_sec_(period_nsec * 0.000000001),
+    torque_ss_err_tol_(kDefaultTorqueSsErrTol_)
+{
+  Reset();
+}
+
+ControllerMultiDrive::ControllerMultiDrive(const vect<id_t>& motors_id,
+                                           const uint32_t period_nsec)
+  : ControllerBase(motors_id), period_sec_(period_nsec * 0.000000001),
+    torque_ss_err_tol_(kDefaultTorqueSsErrTol_)
+{
+  Reset();
+}
+
+//--------- Public functions ---------------------------------------------------------//
+
+void ControllerMultiDrive::SetCableLenTarget(const id_t motor_id, const double target)
+{
+  const size_t idx = MotorIdx(motor_id);
+  if (idx >= motors_id_.size())
+    return;
+  SetTarget(idx, CABLE_LENGTH);
+  length_targets_[idx] = target;
+  on_target_[idx]      = true; // set point is directly applied
+}
+
+void ControllerMultiDrive::SetMotorPosTarget(const id_t motor_id, const int32_t target,
+                                             const bool apply_traj /*= true*/,
+                                             const double time /*= -1.0*/)
+{
+  const size_t idx = MotorIdx(motor_id);
+  if (idx >= motors_id_.size())
+    return;
+  SetTarget(idx, MOTOR_POSITION);
+  pos_targets_[idx] = target;
+  apply_traj_[idx]  = apply_traj;
+  new_traj_[idx]    = true;
+  traj_time_[idx]   = time;
+}
+
+void ControllerMultiDrive::SetMotorsPosTarget(const vect<int32_t>& targets,
+                                              const bool apply_traj /*= true*/,
+                                              const double time /*= -1.0*/)
+{
+  CheckMotorsNum();
+  for (size_t i = 0; i < std::min(targets.size(), motors_id_.size()); i++)
+  {
+    SetTarget(i, MOTOR_POSITION);
+    pos_targets_[i] = targets[i];
+    apply_traj_[i]  = apply_traj;
+    new_traj_[i]    = true;
+    traj_time_[i]   = time;
+  }
+}
+
+void ControllerMultiDrive::SetMotorSpeedTarget(const id_t motor_id, const int32_t target)
+{
+  const size_t idx = MotorIdx(motor_id);
+  if (idx >= motors_id_.size())
+    return;
+  SetTarget(idx, MOTOR_SPEED);
+  speed_targets_[idx] = target;
+  on_target_[idx]     = true; // set point is directly applied
+}
+
+void ControllerMultiDrive::SetMotorTorqueTarget(const id_t motor_id, const int16_t target)
+{
+  const size_t idx = MotorIdx(motor_id);
+  if (idx >= motors_id_.size())
+    return;
+  SetTarget(idx, MOTOR_TORQUE);
+  torque_targets_[idx] = target;
+  torque_pids_[idx].Reset();
+}
+
+void ControllerMultiDrive::SetMotorsTorqueTarget(const vect<int16_t>& targets)
+{
+  CheckMotorsNum();
+  for (size_t i = 0; i < std::min(targets.size(), motors_id_.size()); i++)
+  {
+    SetTarget(i, MOTOR_TORQUE);
+    torque_targets_[i] = targets[i];
+    torque_pids_[i].Reset();
+  }
+}
+
+bool ControllerMultiDrive::TargetReached(const id_t motor_id) const
+{
+  const size_t idx = MotorIdx(motor_id);
+  if (idx >= motors_id_.size() || idx >= on_target_.size())
+    return false;
+  return on_target_[idx];
+}
+
+bool ControllerMultiDrive::TargetReached() const
+{
+  if (modes_.empty() || on_target_.size() != motors_id_.size())
+    return false;
+  for (size_t i = 0; i < motors_id_.size(); i++)
+    if (modes_[i] != NONE && !(targets_mode_[i] == modes_[i] && on_target_[i]))
+      return false;
+  return true;
+}
+
+vect<ControlAction>
+ControllerMultiDrive::CalcCtrlActions(const grabcdpr::RobotVars&,
+                                      const vect<ActuatorStatus>& actuators_status)
+{
+  CheckMotorsNum();
+  StartPosTrajectories(actuators_status);
+  pos_profiles_.Evaluate(pos_setpoints_.data());
+
+  vect<ControlAction> actions(motors_id_.size());
+  for (size_t i = 0; i < motors_id_.size(); i++)
+  {
+    ControlAction& action = actions[i];
+    action.motor_id       = motors_id_[i];
+    action.ctrl_mode      = modes_[i];
+    // A motor is controlled only if a target for its current mode is set
+    if (targets_mode_[i] != modes_[i])
+    {
+      action.ctrl_mode = NONE;
+      continue;
+    }
+    switch (action.ctrl_mode)
+    {
+      case CABLE_LENGTH:
+        action.cable_length = length_targets_[i];
+        break;
+      case MOTOR_POSITION:
+        action.motor_position = CalcMotorPos(i);
+        break;
+      case MOTOR_SPEED:
+        action.motor_speed = speed_targets_[i];
+        break;
+      case MOTOR_TORQUE:
+        action.motor_torque =
+          CalcMotorTorque(i, FindStatus(motors_id_[i], actuators_status));
+        break;
+      case NONE:
+        break;
+    }
+  }
+  return actions;
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+void ControllerMultiDrive::Reset()
+{
+  const size_t motors_num = motors_id_.size();
+  targets_mode_.assign(motors_num, NONE);
+  on_target_.assign(motors_num, false);
+  length_targets_.assign(motors_num, 0.0);
+  pos_targets_.assign(motors_num, 0);
+  speed_targets_.assign(motors_num, 0);
+  torque_targets_.assign(motors_num, 0);
+  torque_pids_.assign(motors_num, PID(period_sec_));
+  for (PID& pid : torque_pids_)
+    pid.SetParams(torque_pid_params_);
+
+  apply_traj_.assign(motors_num, false);
+  new_traj_.assign(motors_num, false);
+  traj_time_.assign(motors_num, -1.0);
+  traj_init_pos_.assign(motors_num, 0.0);
+  pos_setpoints_.assign(motors_num, 0.0);
+  pos_profiles_.Resize(motors_num);
+}
+
+void ControllerMultiDrive::CheckMotorsNum()
+{
+  // Controlled motors were changed by base class setters: start from scratch
+  if (targets_mode_.size() != motors_id_.size())
+    Reset();
+}
+
+size_t ControllerMultiDrive::MotorIdx(const id_t motor_id) const
+{
+  return static_cast<size_t>(std::find(motors_id_.begin(), motors_id_.end(), motor_id) -
+                             motors_id_.begin());
+}
+
+void ControllerMultiDrive::SetTarget(const size_t idx, const ControlMode mode)
+{
+  CheckMotorsNum();
+  targets_mode_[idx] = mode;
+  on_target_[idx]    = false;
+  new_traj_[idx]     = false;
+}
+
+void ControllerMultiDrive::StartPosTrajectories(
+  const vect<ActuatorStatus>& actuators_status)
+{
+  // Trajectories starting together without a given time share the longest duration, so
+  // that all motors arrive together
+  double common_time = 0.0;
+  for (size_t i = 0; i < motors_id_.size(); i++)
+  {
+    if (!new_traj_[i] || !apply_traj_[i])
+      continue;
+    const ActuatorStatus* status = FindStatus(motors_id_[i], actuators_status);
+    // For safety, in case there's no id match, motor is kept still on its target
+    traj_init_pos_[i] = status == nullptr ? pos_targets_[i] : status->motor_position;
+    if (traj_time_[i] <= 0.0)
+      common_time = std::max(
+        common_time,
+        std::max(1.0, std::abs(pos_targets_[i] - traj_init_pos_[i]) / kAbsMaxMotorSpeed));
+  }
+  for (size_t i = 0; i < motors_id_.size(); i++)
+  {
+    if (!new_traj_[i])
+      continue;
+    new_traj_[i] = false;
+    if (!apply_traj_[i])
+    {
+      pos_profiles_.Start(i, pos_targets_[i], pos_targets_[i], 0);
+      continue;
+    }
+    if (traj_time_[i] <= 0.0)
+      traj_time_[i] = common_time;
+    pos_profiles_.Start(i, traj_init_pos_[i], pos_targets_[i],
+                        Poly5Profile::CyclesFromTime(traj_time_[i], period_sec_));
+  }
+}
+
+int32_t ControllerMultiDrive::CalcMotorPos(const size_t idx)
+{
+  on_target_[idx] = pos_profiles_.Done(idx);
+  return static_cast<int32_t>(round(pos_setpoints_[idx]));
+}
+
+int16_t ControllerMultiDrive::CalcMotorTorque(const size_t idx,
+                                              const ActuatorStatus* actuator_status)
+{
+  int16_t target = torque_targets_[idx];
+  if (winches_controller_ != nullptr && actuator_status != nullptr)
+    target = (*winches_controller_)[motors_id_[idx]].calcServoTorqueSetpoint(
+      *actuator_status, target);
+  if (on_target_[idx])
+    return target;
+
+  PID& pid            = torque_pids_[idx];
+  double motor_torque = target;
+  if (actuator_status != nullptr)
+    motor_torque =
+      pid.Calculate(target, static_cast<double>(actuator_status->motor_torque));
+  on_target_[idx] = (std::abs(pid.GetError()) + std::abs(pid.GetPrevError())) <
+                    (2 * torque_ss_err_tol_);
+  return static_cast<int16_t>(round(motor_torque));
+}
+
+const ActuatorStatus*
+ControllerMultiDrive::FindStatus(const id_t motor_id,
+                                 const vect<ActuatorStatus>& actuators_status) const
+{
+  for (const ActuatorStatus& actuator_status : actuators_status)
+    if (actuator_status.id == motor_id)
+      return &actuator_status;
+  return nullptr;
+}
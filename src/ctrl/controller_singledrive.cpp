@@ -8,10 +8,21 @@
 
 #include "ctrl/controller_singledrive.h"
 
+constexpr double ControllerSingleDrive::kAbsDeltaLengthMicroPerSec_;
+constexpr double ControllerSingleDrive::kAbsDeltaLengthPerSec_;
+constexpr double ControllerSingleDrive::kDefaultLengthJogAcc_;
+constexpr double ControllerSingleDrive::kDefaultLengthJogJerk_;
+constexpr double ControllerSingleDrive::kDefaultSpeedJogAcc_;
+constexpr double ControllerSingleDrive::kDefaultSpeedJogJerk_;
+
 ControllerSingleDrive::ControllerSingleDrive(const uint32_t period_nsec)
   : ControllerBase(), period_sec_(period_nsec * 0.000000001),
     pos_ss_err_tol_(kDefaultPosSsErrTol_), torque_ss_err_tol_(kDefaultTorqueSsErrTol_),
-    torque_pid_(period_sec_)
+    torque_pid_(period_sec_),
+    length_jog_(period_sec_, kAbsDeltaLengthPerSec_, kDefaultLengthJogAcc_,
+                kDefaultLengthJogJerk_),
+    speed_jog_(period_sec_, kAbsMaxMotorSpeed, kDefaultSpeedJogAcc_,
+               kDefaultSpeedJogJerk_)
 {
   Clear();
   torque_pid_.SetParams(torque_pid_params_);
@@ -22,7 +33,11 @@ ControllerSingleDrive::ControllerSingleDrive(const id_t motor_id,
                                              const uint32_t period_nsec)
   : ControllerBase(vect<id_t>(1, motor_id)), period_sec_(period_nsec * 0.000000001),
     pos_ss_err_tol_(kDefaultPosSsErrTol_), torque_ss_err_tol_(kDefaultTorqueSsErrTol_),
-    torque_pid_(period_sec_)
+    torque_pid_(period_sec_),
+    length_jog_(period_sec_, kAbsDeltaLengthPerSec_, kDefaultLengthJogAcc_,
+                kDefaultLengthJogJerk_),
+    speed_jog_(period_sec_, kAbsMaxMotorSpeed, kDefaultSpeedJogAcc_,
+               kDefaultSpeedJogJerk_)
 {
   Clear();
   torque_pid_.SetParams(torque_pid_params_);
@@ -55,6 +70,7 @@ void ControllerSingleDrive::SetMotorSpeedTarget(const int32_t target)
 {
   Clear();
   speed_target_true_ = target;
+  speed_jog_.Reset(0.0, target);
   target_flags_.set(SPEED);
 }
 
@@ -80,21 +96,37 @@ void ControllerSingleDrive::CableLenIncrement(const bool active,
                                               const Sign sign /*= Sign::POS*/,
                                               const bool micromove /*= true*/)
 {
-  if (active == change_length_target_)
-    return;
-
-  change_length_target_ = active;
-  if (change_length_target_)
+  if (!active)
   {
-    delta_length_ = sign *
-                    (micromove ? kAbsDeltaLengthMicroPerSec_ : kAbsDeltaLengthPerSec_) *
-                    period_sec_;
+    // Motion is not stopped here, but smoothly brought to rest by the jog profile
+    length_jog_.SetTargetSpeed(0.0);
+    return;
   }
+
+  if (!change_length_target_)
+    length_jog_.Reset(length_target_);
+  change_length_target_ = true;
+  length_jog_.SetTargetSpeed(sign * (micromove ? kAbsDeltaLengthMicroPerSec_
+                                               : length_jog_max_speed_));
 }
 
 void ControllerSingleDrive::ScaleMotorSpeed(const double scale)
 {
-  speed_target_true_ = static_cast<int>(round(scale * kAbsMaxSpeed_));
+  speed_jog_.SetTargetSpeed(scale * kAbsMaxMotorSpeed);
+}
+
+void ControllerSingleDrive::SetCableLenJogLimits(const double max_speed,
+                                                 const double max_acc,
+                                                 const double max_jerk)
+{
+  length_jog_max_speed_ = std::abs(max_speed);
+  length_jog_.SetLimits(max_speed, max_acc, max_jerk);
+}
+
+void ControllerSingleDrive::SetMotorSpeedJogLimits(const double max_acc,
+                                                   const double max_jerk)
+{
+  speed_jog_.SetLimits(kAbsMaxMotorSpeed, max_acc, max_jerk);
 }
 
 void ControllerSingleDrive::MotorTorqueIncrement(const bool active,
@@ -124,7 +156,10 @@ ControllerSingleDrive::CalcCtrlActions(const grabcdpr::RobotVars &,
       if (target_flags_.test(LENGTH))
       {
         if (change_length_target_)
-          length_target_ += delta_length_;
+        {
+          length_target_        = length_jog_.Next();
+          change_length_target_ = !length_jog_.Idle();
+        }
         if (apply_trajectory_)
           length_target_ = GetTrajectoryPoint();
         res.cable_length = length_target_;
@@ -140,7 +175,11 @@ ControllerSingleDrive::CalcCtrlActions(const grabcdpr::RobotVars &,
       break;
     case MOTOR_SPEED:
       if (target_flags_.test(SPEED))
-        res.motor_speed = speed_target_true_;
+      {
+        speed_jog_.Next();
+        speed_target_true_ = static_cast<int32_t>(round(speed_jog_.Speed()));
+        res.motor_speed    = speed_target_true_;
+      }
       else
         res.ctrl_mode = NONE;
       break;
@@ -179,8 +218,8 @@ int32_t ControllerSingleDrive::CalcMotorPos(const vect<ActuatorStatus>& actuator
   {
     if (actuator_status.id != motors_id_[0])
       continue;
-    pos_target =
-      CalcPoly5Waypoint(actuator_status.motor_position, pos_target_true_, kAbsMaxSpeed_);
+    pos_target = CalcPoly5Waypoint(actuator_status.motor_position, pos_target_true_,
+                                   kAbsMaxMotorSpeed);
     on_target_ = pos_target == pos_target_true_;
     break;
   }
@@ -212,31 +251,19 @@ ControllerSingleDrive::CalcMotorTorque(const vect<ActuatorStatus>& actuators_sta
 int32_t ControllerSingleDrive::CalcPoly5Waypoint(const int32_t q, const int32_t q_final,
                                                  const int32_t max_dq)
 {
-  static double a0, a3, a4, a5; // polynomial coefficients for null init/final vel/acc
-  static grabrt::Clock clock;
-
   // Check if a trajectory was requested
   if (!apply_trajectory_)
     return q_final;
 
   if (new_trajectory_)
   {
-    double dq = q_final - q;
     if (traj_time_ <= 0.0)
-      traj_time_ = std::max(1.0, std::abs(dq) / max_dq);
-    a0              = q; // this is q_init for a new trajectory
-    a3              = 20. / (2 * pow(traj_time_, 3.)) * dq;
-    a4              = -30. / (2 * pow(traj_time_, 4.)) * dq;
-    a5              = 12. / (2 * pow(traj_time_, 5.)) * dq;
+      traj_time_ = std::max(1.0, std::abs(q_final - q) / static_cast<double>(max_dq));
+    pos_profile_.Start(q, q_final, Poly5Profile::CyclesFromTime(traj_time_, period_sec_));
     new_trajectory_ = false;
-    clock.Reset();
   }
 
-  double t = clock.Elapsed();
-  if (t >= traj_time_)
-    return q_final;
-  double q_t = a0 + a3 * pow(t, 3.) + a4 * pow(t, 4.) + a5 * pow(t, 5.);
-  return static_cast<int32_t>(round(q_t));
+  return static_cast<int32_t>(round(pos_profile_.Next()));
 }
 
 double ControllerSingleDrive::GetTrajectoryPoint()
@@ -263,7 +290,6 @@ void ControllerSingleDrive::Clear()
 
   change_length_target_ = false;
   change_torque_target_ = false;
-  delta_length_         = 0.0;
 
   apply_trajectory_ = false;
 }
@@ -0,0 +1,379 @@
+/**
+ * @file excitation_generator.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in excitation_generator.h.
+ */
+
+#include "ctrl/excitation_generator.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "ctrl/poly5_profile.h"
+
+constexpr uint ExcitationGenerator::kMaxLines_;
+constexpr uint ExcitationGenerator::kGridPerLine_;
+constexpr uint ExcitationGenerator::kPeakGridPerLine_;
+constexpr uint ExcitationGenerator::kCrestIterations_;
+constexpr double ExcitationGenerator::kClipRatio_;
+constexpr double ExcitationGenerator::kResyncTime_;
+constexpr double ExcitationGenerator::kPrbsBandRatio_;
+constexpr uint ExcitationGenerator::kPrbsMinOrder_;
+constexpr uint ExcitationGenerator::kPrbsMaxOrder_;
+constexpr double ExcitationGenerator::kPrbsRiseRatio_;
+
+namespace {
+
+constexpr double kTwoPi = 2.0 * M_PI;
+constexpr double kEps   = 1e-9;
+
+// Feedback taps of maximum length shift registers, indexed by order, as bit masks where
+// bit i stands for stage i + 1.
+// clang-format off
+constexpr uint32_t kLfsrTaps[] = {
+  0, 0,
+  0x3,     0x6,     0xC,     0x14,    0x30,    0x60,    0xB8,    0x110,
+  0x240,   0x500,   0x829,   0x100D,  0x2015,  0x6000,  0xD008,  0x12000,
+  0x20400, 0x40023, 0x90000};
+// clang-format on
+
+// Restrict-qualified arrays and a branchless body let the compiler vectorize this loop,
+// which is enabled for this function only.
+__attribute__((optimize("tree-vectorize")))
+void RotateOscillators(double* __restrict__ c, double* __restrict__ s,
+                       const double* __restrict__ c_step,
+                       const double* __restrict__ s_step, const size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    const double ci = c[i];
+    const double si = s[i];
+    c[i]            = ci * c_step[i] - si * s_step[i];
+    s[i]            = si * c_step[i] + ci * s_step[i];
+  }
+}
+
+void FillTables(const uint size, vectD& cos_table, vectD& sin_table)
+{
+  cos_table.resize(size);
+  sin_table.resize(size);
+  for (uint m = 0; m < size; m++)
+  {
+    const double angle = kTwoPi * m / size;
+    cos_table[m]       = cos(angle);
+    sin_table[m]       = sin(angle);
+  }
+}
+
+double AbsPeak(const vectD& signal)
+{
+  double peak = 0.0;
+  for (const double value : signal)
+    peak = std::max(peak, std::abs(value));
+  return peak;
+}
+
+} // end namespace
+
+ExcitationGenerator::ExcitationGenerator(const double period_sec,
+                                         const ExcitationParams& params)
+  : period_sec_(period_sec), params_(params), scale_(0.0), crest_factor_(0.0), k_(0),
+    base_freq_(0.0), sweep_ratio_(1.0), clock_freq_(0.0), lfsr_taps_(0), lfsr_mask_(0),
+    lfsr_(1), bits_count_(0), prev_level_(0.0), level_(0.0)
+{
+  // Keep bandwidth positive and below Nyquist frequency
+  const double nyquist_freq = 0.5 / period_sec_;
+  params_.amplitude         = std::abs(params_.amplitude);
+  params_.duration          = std::max(0.0, params_.duration);
+  params_.rest_time         = std::max(0.0, params_.rest_time);
+  params_.delay             = std::max(0.0, params_.delay);
+  params_.fade_time = std::min(std::max(0.0, params_.fade_time), 0.5 * params_.duration);
+  params_.max_freq  = std::min(std::abs(params_.max_freq), nyquist_freq);
+  params_.min_freq  = std::min(std::abs(params_.min_freq), params_.max_freq);
+  if (params_.min_freq <= 0.0)
+    params_.min_freq = params_.duration > 0.0 ? 1.0 / params_.duration : nyquist_freq;
+  params_.max_freq = std::max(params_.max_freq, params_.min_freq);
+
+  const uint64_t rest_cycles =
+    Poly5Profile::CyclesFromTime(params_.rest_time, period_sec_);
+  start_cycle_ =
+    rest_cycles + Poly5Profile::CyclesFromTime(params_.delay, period_sec_);
+  fade_cycles_       = Poly5Profile::CyclesFromTime(params_.fade_time, period_sec_);
+  excitation_cycles_ = Poly5Profile::CyclesFromTime(params_.duration, period_sec_);
+  end_cycle_         = start_cycle_ + excitation_cycles_ + rest_cycles;
+  resync_cycles_ =
+    std::max(uint64_t(1), Poly5Profile::CyclesFromTime(kResyncTime_, period_sec_));
+
+  switch (params_.type)
+  {
+    case PULSE:
+      crest_factor_ = 1.0;
+      break;
+    case MULTISINE:
+      SetupMultisine();
+      break;
+    case CHIRP:
+      SetupChirp();
+      break;
+    case PRBS:
+      SetupPrbs();
+      break;
+  }
+  Reset();
+}
+
+//--------- Public functions ---------------------------------------------------------//
+
+void ExcitationGenerator::Reset()
+{
+  k_          = 0;
+  bits_count_ = 0;
+  lfsr_       = std::max(uint32_t(1), params_.seed & lfsr_mask_);
+  prev_level_ = 0.0;
+  level_      = 0.0;
+}
+
+double ExcitationGenerator::Next()
+{
+  if (k_ >= end_cycle_)
+    return 0.0;
+  const uint64_t k = k_++;
+  if (k < start_cycle_ || k >= start_cycle_ + excitation_cycles_)
+    return 0.0;
+
+  const uint64_t j = k - start_cycle_;
+  double value     = 0.0;
+  switch (params_.type)
+  {
+    case PULSE:
+      break;
+    case MULTISINE:
+      value = NextMultisine(j);
+      break;
+    case CHIRP:
+      value = NextChirp(j);
+      break;
+    case PRBS:
+      value = NextPrbs(j);
+      break;
+  }
+  return Envelope(j) * (params_.offset + scale_ * value);
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+void ExcitationGenerator::SetupMultisine()
+{
+  // Harmonics of lowest frequency, unless they would be too many to run in real time
+  base_freq_ = std::max(params_.min_freq, params_.max_freq / kMaxLines_);
+  const uint first_line =
+    std::max(1u, static_cast<uint>(ceil(params_.min_freq / base_freq_ - kEps)));
+  const uint last_line =
+    std::max(first_line, static_cast<uint>(floor(params_.max_freq / base_freq_ + kEps)));
+  lines_.clear();
+  for (uint line = first_line; line <= last_line; line++)
+    lines_.push_back(line);
+
+  // Initial phases
+  const size_t lines_num = lines_.size();
+  phases_.resize(lines_num);
+  if (params_.seed == 0)
+    for (size_t i = 0; i < lines_num; i++)
+      phases_[i] = -M_PI * i * (i + 1) / lines_num;
+  else
+  {
+    std::mt19937 generator(params_.seed);
+    std::uniform_real_distribution<double> distribution(0.0, kTwoPi);
+    for (double& phase : phases_)
+      phase = distribution(generator);
+  }
+  OptimizePhases();
+
+  // Scale onto a grid much finer than the optimization one to catch the true peak
+  const double peak = MultisinePeak(kPeakGridPerLine_ * lines_.back());
+  crest_factor_     = peak / sqrt(0.5 * lines_num);
+  scale_            = peak > 0.0 ? params_.amplitude / peak : 0.0;
+
+  cos_.assign(lines_num, 1.0);
+  sin_.assign(lines_num, 0.0);
+  cos_step_.resize(lines_num);
+  sin_step_.resize(lines_num);
+  for (size_t i = 0; i < lines_num; i++)
+  {
+    const double step = kTwoPi * lines_[i] * base_freq_ * period_sec_;
+    cos_step_[i]      = cos(step);
+    sin_step_[i]      = sin(step);
+  }
+}
+
+void ExcitationGenerator::SetupChirp()
+{
+  sweep_ratio_  = params_.max_freq / params_.min_freq;
+  crest_factor_ = M_SQRT2;
+  scale_        = params_.amplitude;
+}
+
+void ExcitationGenerator::SetupPrbs()
+{
+  // The power spectrum of a PRBS is within -3dB up to about 0.44 times its clock
+  // frequency, while its period must last at least as long as the slowest harmonic.
+  clock_freq_ = std::min(params_.max_freq / kPrbsBandRatio_, 1.0 / period_sec_);
+  uint order  = kPrbsMinOrder_;
+  while (order < kPrbsMaxOrder_ &&
+         ((1u << order) - 1) < clock_freq_ / params_.min_freq)
+    order++;
+  lfsr_taps_    = kLfsrTaps[order];
+  lfsr_mask_    = (1u << order) - 1;
+  crest_factor_ = 1.0;
+  scale_        = params_.amplitude;
+}
+
+double ExcitationGenerator::NextMultisine(const uint64_t k)
+{
+  if (k % resync_cycles_ == 0)
+    ResyncOscillators(k);
+  double value = 0.0;
+  for (const double c : cos_)
+    value += c;
+  RotateOscillators(cos_.data(), sin_.data(), cos_step_.data(), sin_step_.data(),
+                    cos_.size());
+  return value;
+}
+
+double ExcitationGenerator::NextChirp(const uint64_t k) const
+{
+  const double time     = k * period_sec_;
+  const double duration = excitation_cycles_ * period_sec_;
+  // Instantaneous frequency is f0 * r^(t/T), whose integral yields the phase
+  const double log_ratio = log(sweep_ratio_);
+  const double phase     = log_ratio < kEps
+                         ? kTwoPi * params_.min_freq * time
+                         : kTwoPi * params_.min_freq * duration / log_ratio *
+                             (pow(sweep_ratio_, time / duration) - 1.0);
+  return sin(phase);
+}
+
+double ExcitationGenerator::NextPrbs(const uint64_t k)
+{
+  const double bits = k * period_sec_ * clock_freq_;
+  while (bits_count_ <= static_cast<uint64_t>(bits))
+  {
+    prev_level_ = level_;
+    level_      = (lfsr_ & 1u) ? 1.0 : -1.0;
+    ShiftRegister();
+    bits_count_++;
+  }
+  // Raised cosine transition at the beginning of each bit
+  const double progress = (bits - floor(bits)) / kPrbsRiseRatio_;
+  if (progress >= 1.0)
+    return level_;
+  return prev_level_ + (level_ - prev_level_) * 0.5 * (1.0 - cos(M_PI * progress));
+}
+
+double ExcitationGenerator::Envelope(const uint64_t k) const
+{
+  if (fade_cycles_ == 0)
+    return 1.0;
+  // Raised cosine fade in and out, null at first and last cycle
+  const uint64_t from_edge = std::min(k, excitation_cycles_ - 1 - k);
+  if (from_edge >= fade_cycles_)
+    return 1.0;
+  return 0.5 * (1.0 - cos(M_PI * from_edge / fade_cycles_));
+}
+
+void ExcitationGenerator::ResyncOscillators(const uint64_t k)
+{
+  const double time = k * period_sec_;
+  for (size_t i = 0; i < lines_.size(); i++)
+  {
+    // Wrap cycles before converting to angle to keep precision on long excitations
+    double cycles = lines_[i] * base_freq_ * time;
+    cycles -= floor(cycles);
+    const double angle = kTwoPi * cycles + phases_[i];
+    cos_[i]            = cos(angle);
+    sin_[i]            = sin(angle);
+  }
+}
+
+void ExcitationGenerator::OptimizePhases()
+{
+  // Iterative clipping: clip one period of the signal, project it back onto the excited
+  // harmonics and keep their phases only, so that the spectrum stays flat.
+  vectD cos_table, sin_table;
+  FillTables(kGridPerLine_ * lines_.back(), cos_table, sin_table);
+  const uint grid_size = static_cast<uint>(cos_table.size());
+  vectD signal(grid_size);
+  vectD best_phases = phases_;
+  double best_peak  = std::numeric_limits<double>::max();
+  for (uint iter = 0; iter <= kCrestIterations_; iter++)
+  {
+    SynthesizePeriod(cos_table, sin_table, signal);
+    const double peak = AbsPeak(signal);
+    if (peak < best_peak)
+    {
+      best_peak   = peak;
+      best_phases = phases_;
+    }
+    if (iter == kCrestIterations_)
+      break;
+
+    const double clip_level = kClipRatio_ * peak;
+    for (double& value : signal)
+      value = std::min(std::max(value, -clip_level), clip_level);
+    for (size_t i = 0; i < lines_.size(); i++)
+    {
+      double re = 0.0, im = 0.0;
+      uint idx  = 0;
+      for (uint m = 0; m < grid_size; m++)
+      {
+        re += signal[m] * cos_table[idx];
+        im += signal[m] * sin_table[idx];
+        idx += lines_[i];
+        if (idx >= grid_size)
+          idx -= grid_size;
+      }
+      phases_[i] = atan2(-im, re);
+    }
+  }
+  phases_ = best_phases;
+}
+
+double ExcitationGenerator::MultisinePeak(const uint grid_size) const
+{
+  vectD cos_table, sin_table;
+  FillTables(grid_size, cos_table, sin_table);
+  vectD signal(grid_size);
+  SynthesizePeriod(cos_table, sin_table, signal);
+  return AbsPeak(signal);
+}
+
+void ExcitationGenerator::SynthesizePeriod(const vectD& cos_table,
+                                           const vectD& sin_table, vectD& signal) const
+{
+  const uint grid_size = static_cast<uint>(signal.size());
+  std::fill(signal.begin(), signal.end(), 0.0);
+  for (size_t i = 0; i < lines_.size(); i++)
+  {
+    const double c = cos(phases_[i]);
+    const double s = sin(phases_[i]);
+    uint idx       = 0;
+    for (uint m = 0; m < grid_size; m++)
+    {
+      signal[m] += c * cos_table[idx] - s * sin_table[idx];
+      idx += lines_[i];
+      if (idx >= grid_size)
+        idx -= grid_size;
+    }
+  }
+}
+
+void ExcitationGenerator::ShiftRegister()
+{
+  const uint32_t feedback =
+    static_cast<uint32_t>(std::bitset<32>(lfsr_ & lfsr_taps_).count() & 1u);
+  lfsr_ = ((lfsr_ << 1) | feedback) & lfsr_mask_;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file jog_profile.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in jog_profile.h.
+ */
+
+#include "ctrl/jog_profile.h"
+
+#include <algorithm>
+#include <cmath>
+
+JogProfile::JogProfile(const double period_sec, const double max_speed,
+                       const double max_acc, const double max_jerk)
+  : period_sec_(period_sec)
+{
+  SetLimits(max_speed, max_acc, max_jerk);
+}
+
+//--------- Public functions ---------------------------------------------------------//
+
+void JogProfile::SetLimits(const double max_speed, const double max_acc,
+                           const double max_jerk)
+{
+  max_speed_ = std::abs(max_speed);
+  max_acc_   = std::abs(max_acc);
+  max_jerk_  = std::abs(max_jerk);
+  SetTargetSpeed(target_vel_);
+}
+
+void JogProfile::Reset(const double position, const double speed /*= 0.0*/)
+{
+  pos_ = position;
+  vel_ = speed;
+  acc_ = 0.0;
+  SetTargetSpeed(speed);
+}
+
+void JogProfile::SetTargetSpeed(const double speed)
+{
+  target_vel_ = std::min(std::max(speed, -max_speed_), max_speed_);
+}
+
+double JogProfile::Next()
+{
+  const double max_delta_acc = max_jerk_ * period_sec_;
+  const double err           = target_vel_ - vel_;
+
+  // Snap onto target once it is reachable within a single cycle
+  if (std::abs(acc_) <= max_delta_acc && std::abs(err) <= max_delta_acc * period_sec_)
+  {
+    acc_ = 0.0;
+    pos_ += 0.5 * (vel_ + target_vel_) * period_sec_;
+    vel_ = target_vel_;
+    return pos_;
+  }
+
+  // Largest acceleration which can still be ramped down to zero reaching target speed.
+  // Speed error is taken net of the change due to the current acceleration in one cycle,
+  // to account for discretization.
+  const double err_next = err - acc_ * period_sec_;
+  const double acc_des  = (err_next > 0.0 ? 1.0 : -1.0) *
+                         std::min(max_acc_, sqrt(2.0 * max_jerk_ * std::abs(err_next)));
+  const double acc_prev = acc_;
+  acc_ += std::min(std::max(acc_des - acc_, -max_delta_acc), max_delta_acc);
+
+  const double vel_prev = vel_;
+  vel_ += 0.5 * (acc_prev + acc_) * period_sec_;
+  pos_ += 0.5 * (vel_prev + vel_) * period_sec_;
+  return pos_;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file poly5_profile.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of classes declared in poly5_profile.h.
+ */
+
+#include "ctrl/poly5_profile.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Coefficients of q(k) = a0 + dq * (10s^3 - 15s^4 + 6s^5), with s = k/n, expanded in k.
+void CalcCoefficients(const double q_init, const double q_final, const double n,
+                      double& a0, double& c3, double& c4, double& c5)
+{
+  const double dq = q_final - q_init;
+  const double n3 = n * n * n;
+  a0              = q_init;
+  c3              = n > 0.0 ? 10. * dq / n3 : 0.0;
+  c4              = n > 0.0 ? -15. * dq / (n3 * n) : 0.0;
+  c5              = n > 0.0 ? 6. * dq / (n3 * n * n) : 0.0;
+}
+
+// Restrict-qualified arrays and a branchless body, with all loads unconditional, let the
+// compiler vectorize this loop. Vectorization and non-trapping math are enabled for this
+// function only, to leave floating-point semantics of the rest of the project untouched.
+__attribute__((optimize("tree-vectorize", "no-trapping-math")))
+void EvaluateBatch(const double* __restrict__ a0, const double* __restrict__ c3,
+                   const double* __restrict__ c4, const double* __restrict__ c5,
+                   const double* __restrict__ qf, const double* __restrict__ n,
+                   double* __restrict__ k, double* __restrict__ out, const size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    const double ni    = n[i];
+    const double qfi   = qf[i];
+    const double knext = k[i] + 1.0;
+    const bool done    = knext >= ni;
+    const double ki    = done ? ni : knext;
+    const double q     = a0[i] + ki * ki * ki * (c3[i] + ki * (c4[i] + ki * c5[i]));
+    k[i]               = ki;
+    out[i]             = done ? qfi : q;
+  }
+}
+
+} // end namespace
+
+//------------------------------------------------------------------------------------//
+//--------- Poly5Profile class -------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+void Poly5Profile::Start(const double q_init, const double q_final, const uint64_t cycles)
+{
+  n_       = static_cast<double>(cycles);
+  k_       = 0.0;
+  q_final_ = q_final;
+  CalcCoefficients(q_init, q_final, n_, a0_, c3_, c4_, c5_);
+}
+
+double Poly5Profile::Next()
+{
+  k_ = std::min(k_ + 1.0, n_);
+  if (k_ >= n_)
+    return q_final_;
+  return a0_ + k_ * k_ * k_ * (c3_ + k_ * (c4_ + k_ * c5_));
+}
+
+uint64_t Poly5Profile::CyclesFromTime(const double time_sec, const double period_sec)
+{
+  if (time_sec <= 0.0)
+    return 0;
+  return static_cast<uint64_t>(ceil(time_sec / period_sec));
+}
+
+//------------------------------------------------------------------------------------//
+//--------- Poly5ProfileBatch class --------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+void Poly5ProfileBatch::Resize(const size_t axes_num)
+{
+  a0_.assign(axes_num, 0.0);
+  c3_.assign(axes_num, 0.0);
+  c4_.assign(axes_num, 0.0);
+  c5_.assign(axes_num, 0.0);
+  q_final_.assign(axes_num, 0.0);
+  n_.assign(axes_num, 0.0);
+  k_.assign(axes_num, 0.0);
+}
+
+void Poly5ProfileBatch::Start(const size_t idx, const double q_init, const double q_final,
+                              const uint64_t cycles)
+{
+  n_[idx]       = static_cast<double>(cycles);
+  k_[idx]       = 0.0;
+  q_final_[idx] = q_final;
+  CalcCoefficients(q_init, q_final, n_[idx], a0_[idx], c3_[idx], c4_[idx], c5_[idx]);
+}
+
+void Poly5ProfileBatch::Evaluate(double* values)
+{
+  EvaluateBatch(a0_.data(), c3_.data(), c4_.data(), c5_.data(), q_final_.data(),
+                n_.data(), k_.data(), values, a0_.size());
+}
@@ -0,0 +1,88 @@
+/**
+ * @file trajectory_feedforward.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in trajectory_feedforward.h.
+ */
+
+#include "ctrl/trajectory_feedforward.h"
+
+#include <algorithm>
+
+//--------- Public functions ---------------------------------------------------------//
+
+double TrajectoryFeedforward::Lead(const double abs_time, const double lead_time,
+                                   const double time_rate /*= 1.0*/) const
+{
+  if (timestamps_.size() < 2 || abs_time <= timestamps_.front() ||
+      abs_time >= timestamps_.back())
+    return 0.0;
+
+  const size_t upper_idx = static_cast<size_t>(
+    std::upper_bound(timestamps_.begin(), timestamps_.end(), abs_time) -
+    timestamps_.begin());
+  const size_t lower_idx = upper_idx - 1;
+  const double dt        = timestamps_[upper_idx] - timestamps_[lower_idx];
+  const double alpha     = dt > 0.0 ? (abs_time - timestamps_[lower_idx]) / dt : 0.0;
+
+  double vel, acc;
+  if (hermite_)
+  {
+    // Derivatives of cubic Hermite basis functions
+    const double y0 = values_[lower_idx], y1 = values_[upper_idx];
+    const double v0 = velocities_[lower_idx], v1 = velocities_[upper_idx];
+    const double a2 = alpha * alpha;
+    vel = ((6. * a2 - 6. * alpha) * (y0 - y1)) / dt +
+          (3. * a2 - 4. * alpha + 1.) * v0 + (3. * a2 - 2. * alpha) * v1;
+    acc = ((12. * alpha - 6.) * (y0 - y1)) / (dt * dt) +
+          ((6. * alpha - 4.) * v0 + (6. * alpha - 2.) * v1) / dt;
+  }
+  else
+  {
+    vel = velocities_[lower_idx] +
+          alpha * (velocities_[upper_idx] - velocities_[lower_idx]);
+    acc = accelerations_[lower_idx] +
+          alpha * (accelerations_[upper_idx] - accelerations_[lower_idx]);
+  }
+  // Time warping scales derivatives with respect to real time
+  return vel * time_rate * lead_time +
+         0.5 * acc * time_rate * time_rate * lead_time * lead_time;
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+void TrajectoryFeedforward::ComputeDerivatives()
+{
+  const vectD& values = values_;
+  const size_t size   = std::min(timestamps_.size(), values.size());
+  velocities_.assign(size, 0.0);
+  accelerations_.assign(size, 0.0);
+  if (size < 2)
+    return;
+
+  for (size_t i = 1; i + 1 < size; i++)
+  {
+    const double h0 = timestamps_[i] - timestamps_[i - 1];
+    const double h1 = timestamps_[i + 1] - timestamps_[i];
+    if (h0 <= 0.0 || h1 <= 0.0)
+      continue;
+    const double y0 = values[i - 1], y1 = values[i], y2 = values[i + 1];
+    velocities_[i] =
+      (-h1 / (h0 * (h0 + h1))) * y0 + ((h1 - h0) / (h0 * h1)) * y1 +
+      (h0 / (h1 * (h0 + h1))) * y2;
+    accelerations_[i] =
+      2. * (y0 / (h0 * (h0 + h1)) - y1 / (h0 * h1) + y2 / (h1 * (h0 + h1)));
+  }
+  // One-sided differences at boundaries
+  const double h_first = timestamps_[1] - timestamps_[0];
+  const double h_last  = timestamps_[size - 1] - timestamps_[size - 2];
+  if (h_first > 0.0)
+    velocities_.front() = (values[1] - values[0]) / h_first;
+  if (h_last > 0.0)
+    velocities_.back() = (values[size - 1] - values[size - 2]) / h_last;
+  if (size > 2)
+  {
+    accelerations_.front() = accelerations_[1];
+    accelerations_.back()  = accelerations_[size - 2];
+  }
+}
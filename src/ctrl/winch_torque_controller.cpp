@@ -7,31 +7,321 @@
 
 #include "ctrl/winch_torque_controller.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "json.hpp"
+
+#include "utils/binary_log.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+/**
+ * @brief Indices of actuator status fields needed by friction identification within the
+ * fields of a logged message, or -1 if missing.
+ */
+struct StatusFields
+{
+  int id           = -1;
+  int motor_speed  = -1;
+  int motor_torque = -1;
+  int pulley_angle = -1;
+
+  bool IsValid() const
+  {
+    return id >= 0 && motor_speed >= 0 && motor_torque >= 0 && pulley_angle >= 0;
+  }
+};
+
+StatusFields FindStatusFields(const std::vector<BinLogField>& fields)
+{
+  StatusFields index;
+  for (size_t i = 0; i < fields.size(); i++)
+  {
+    if (fields[i].name == "id")
+      index.id = static_cast<int>(i);
+    else if (fields[i].name == "motor_speed")
+      index.motor_speed = static_cast<int>(i);
+    else if (fields[i].name == "motor_torque")
+      index.motor_torque = static_cast<int>(i);
+    else if (fields[i].name == "pulley_angle")
+      index.pulley_angle = static_cast<int>(i);
+  }
+  return index;
+}
+
+void AppendSample(const BinLogValue* values, const StatusFields& index,
+                  vect<vect<ActuatorStatus>>& samples)
+{
+  const double id = values[index.id].toDouble();
+  if (id < 0.0 || id >= samples.size())
+    return;
+  ActuatorStatus status;
+  status.id           = static_cast<id_t>(id);
+  status.motor_speed  = static_cast<int32_t>(values[index.motor_speed].toDouble());
+  status.motor_torque = static_cast<int16_t>(values[index.motor_torque].toDouble());
+  status.pulley_angle = values[index.pulley_angle].toDouble();
+  samples[status.id].push_back(status);
+}
+
+} // end namespace
+
+constexpr size_t WinchTorqueControl::kTableIntervals_;
+constexpr size_t WinchesTorqueControl::kDefaultAngleBins;
+constexpr double WinchesTorqueControl::kDefaultStictionSpeed;
+const std::string WinchesTorqueControl::kDefaultFrictionFilepath =
+  SRCDIR "config/winch_friction.json";
+
+bool identifyWinchFriction(const vect<ActuatorStatus>& samples, const size_t angle_bins,
+                           const double stiction_speed, WinchFrictionParams& params)
+{
+  // Least squares fit of sign(w) * torque = coulomb + viscous * |w|
+  double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+  double angle_min = std::numeric_limits<double>::max();
+  double angle_max = std::numeric_limits<double>::lowest();
+  for (const ActuatorStatus& sample : samples)
+  {
+    const double speed = static_cast<double>(sample.motor_speed);
+    if (std::abs(speed) < stiction_speed)
+      continue;
+    const double x = std::abs(speed);
+    const double y = (speed > 0.0 ? 1.0 : -1.0) * sample.motor_torque;
+    n += 1.0;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+    angle_min = std::min(angle_min, sample.pulley_angle);
+    angle_max = std::max(angle_max, sample.pulley_angle);
+  }
+  const double det = n * sxx - sx * sx;
+  if (n < 2.0 || std::abs(det) < std::numeric_limits<double>::epsilon())
+    return false;
+
+  params.viscous        = (n * sxy - sx * sy) / det;
+  params.coulomb        = (sy - params.viscous * sx) / n;
+  params.stiction_speed = stiction_speed;
+  params.angle_min      = angle_min;
+  params.angle_max      = angle_max;
+  params.angle_coulomb.assign(std::max<size_t>(angle_bins, 1), 0.0);
+
+  // Mean residual of each pulley angle bin
+  const size_t bins_num = params.angle_coulomb.size();
+  vect<size_t> bins_count(bins_num, 0);
+  const double bin_width = (angle_max - angle_min) / bins_num;
+  for (const ActuatorStatus& sample : samples)
+  {
+    const double speed = static_cast<double>(sample.motor_speed);
+    if (std::abs(speed) < stiction_speed)
+      continue;
+    const double y = (speed > 0.0 ? 1.0 : -1.0) * sample.motor_torque;
+    size_t bin = 0;
+    if (bin_width > 0.0)
+      bin = std::min(static_cast<size_t>((sample.pulley_angle - angle_min) / bin_width),
+                     bins_num - 1);
+    params.angle_coulomb[bin] += y - params.coulomb - params.viscous * std::abs(speed);
+    bins_count[bin]++;
+  }
+  // Empty bins are linearly interpolated between nearest non-empty ones, held at ends
+  vect<double>& coulomb = params.angle_coulomb;
+  size_t prev           = bins_num; // last non-empty bin, none yet
+  for (size_t i = 0; i < bins_num; i++)
+  {
+    if (bins_count[i] == 0)
+      continue;
+    coulomb[i] /= bins_count[i];
+    if (prev == bins_num)
+      std::fill(coulomb.begin(), coulomb.begin() + i, coulomb[i]);
+    else
+      for (size_t j = prev + 1; j < i; j++)
+      {
+        const double alpha = static_cast<double>(j - prev) / (i - prev);
+        coulomb[j]         = coulomb[prev] + alpha * (coulomb[i] - coulomb[prev]);
+      }
+    prev = i;
+  }
+  std::fill(coulomb.begin() + prev + 1, coulomb.end(), coulomb[prev]);
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+//--------- WinchTorqueControl class -------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
 WinchTorqueControl::WinchTorqueControl(const id_t id,
                                        const grabcdpr::ActuatorParams& /*params*/)
   : id_(id)
-{}
+{
+  setFrictionParams(WinchFrictionParams());
+}
+
+void WinchTorqueControl::setFrictionParams(const WinchFrictionParams& params)
+{
+  friction_params_    = params;
+  viscous_            = params.viscous;
+  inv_stiction_speed_ = params.stiction_speed > 0.0 ? 1.0 / params.stiction_speed : 0.0;
+  angle_min_          = params.angle_min;
+  const double range  = params.angle_max - params.angle_min;
+  inv_angle_step_     = range > 0.0 ? kTableIntervals_ / range : 0.0;
+
+  // Resample pulley-angle Coulomb term onto the table by linear interpolation
+  const vect<double>& samples = params.angle_coulomb;
+  for (size_t i = 0; i <= kTableIntervals_; i++)
+  {
+    double delta = 0.0;
+    if (samples.size() == 1)
+      delta = samples[0];
+    else if (samples.size() > 1)
+    {
+      // Samples are located at bins centers
+      const double pos = std::min(
+        std::max(static_cast<double>(i) * samples.size() / kTableIntervals_ - 0.5, 0.0),
+        samples.size() - 1.0);
+      const size_t j     = std::min(static_cast<size_t>(pos), samples.size() - 2);
+      const double alpha = pos - j;
+      delta              = samples[j] + alpha * (samples[j + 1] - samples[j]);
+    }
+    coulomb_table_[i] = params.coulomb + delta;
+  }
+}
 
-short WinchTorqueControl::calcServoTorqueSetpoint(const ActuatorStatus& /*status*/,
-                                                  const short target)
+short WinchTorqueControl::calcServoTorqueSetpoint(const ActuatorStatus& status,
+                                                  const short target) const
 {
-  return target; // dummy
+  const double speed = static_cast<double>(status.motor_speed);
+
+  // Coulomb term, linearly interpolated on the table and saturated at its ends
+  const double pos =
+    std::min(std::max((status.pulley_angle - angle_min_) * inv_angle_step_, 0.0),
+             static_cast<double>(kTableIntervals_));
+  const size_t idx     = std::min(static_cast<size_t>(pos), kTableIntervals_ - 1);
+  const double alpha   = pos - idx;
+  const double coulomb = coulomb_table_[idx] +
+                         alpha * (coulomb_table_[idx + 1] - coulomb_table_[idx]);
+  // Sign of speed, smoothed around standstill
+  const double sign = std::min(std::max(speed * inv_stiction_speed_, -1.0), 1.0);
+
+  const double setpoint = target + sign * coulomb + viscous_ * speed;
+  return static_cast<short>(
+    round(std::min(std::max(setpoint, static_cast<double>(SHRT_MIN)),
+                   static_cast<double>(SHRT_MAX))));
 }
 
-WinchesTorqueControl::WinchesTorqueControl(const vect<grabcdpr::ActuatorParams>& params)
+//------------------------------------------------------------------------------------//
+//--------- WinchesTorqueControl class -----------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+WinchesTorqueControl::WinchesTorqueControl(
+  const vect<grabcdpr::ActuatorParams>& params,
+  const std::string& friction_filepath /*= kDefaultFrictionFilepath*/)
 {
+  // One controller per actuator, including inactive ones, for direct indexing
+  controllers_.reserve(params.size());
   for (id_t i = 0; i < params.size(); i++)
+    controllers_.push_back(WinchTorqueControl(i, params[i]));
+  // Friction is compensated only once identified
+  loadFrictionParams(friction_filepath);
+}
+
+bool WinchesTorqueControl::loadFrictionParams(const std::string& filepath)
+{
+  std::ifstream ifile(filepath);
+  if (!ifile.is_open())
+    return false;
+
+  try
   {
-    if (!params[i].active)
+    json root;
+    ifile >> root;
+    for (const json& winch : root.at("winches"))
+    {
+      const id_t id = winch.at("id");
+      if (id >= controllers_.size())
+        continue;
+      WinchFrictionParams params;
+      params.coulomb        = winch.at("coulomb");
+      params.viscous        = winch.at("viscous");
+      params.stiction_speed = winch.at("stiction_speed");
+      params.angle_min      = winch.at("angle_min");
+      params.angle_max      = winch.at("angle_max");
+      params.angle_coulomb  = winch.at("angle_coulomb").get<vect<double>>();
+      controllers_[id].setFrictionParams(params);
+    }
+  }
+  catch (json::exception&)
+  {
+    return false;
+  }
+  return true;
+}
+
+vect<id_t> WinchesTorqueControl::identifyFrictionParams(
+  const std::string& log_filepath, const size_t angle_bins /*= kDefaultAngleBins*/,
+  const double stiction_speed /*= kDefaultStictionSpeed*/)
+{
+  vect<id_t> identified;
+  BinaryLogReader reader;
+  if (!reader.open(QString::fromStdString(log_filepath)))
+    return identified;
+
+  // Samples may come from both single status messages and frames of all actuators
+  const std::vector<BinLogSchema>& schemas = reader.schemas();
+  vect<StatusFields> body_fields;
+  vect<StatusFields> group_fields;
+  for (const BinLogSchema& schema : schemas)
+  {
+    body_fields.push_back(FindStatusFields(schema.fields));
+    group_fields.push_back(FindStatusFields(schema.group.fields));
+  }
+  vect<vect<ActuatorStatus>> samples(controllers_.size());
+  BinLogRecord record;
+  while (reader.readNext(record)) // a truncated log still provides its valid records
+  {
+    const size_t i = record.schema_index;
+    if (body_fields[i].IsValid())
+      AppendSample(record.values.data(), body_fields[i], samples);
+    if (!group_fields[i].IsValid())
       continue;
-    controllers_.push_back(WinchTorqueControl(i, params[i]));
+    const size_t item_fields_num = schemas[i].group.fields.size();
+    for (size_t j = 0; j < record.items_num; j++)
+      AppendSample(record.items_values.data() + j * item_fields_num, group_fields[i],
+                   samples);
+  }
+
+  for (id_t id = 0; id < controllers_.size(); id++)
+  {
+    WinchFrictionParams params;
+    if (!identifyWinchFriction(samples[id], angle_bins, stiction_speed, params))
+      continue;
+    controllers_[id].setFrictionParams(params);
+    identified.push_back(id);
   }
+  return identified;
 }
 
-WinchTorqueControl& WinchesTorqueControl::operator[](const id_t id)
+bool WinchesTorqueControl::saveFrictionParams(const std::string& filepath) const
 {
-  for (WinchTorqueControl& controller : controllers_)
-    if (controller.id() == id)
-      return controller;
-  throw std::out_of_range("Index out of range");
+  json winches = json::array();
+  for (const WinchTorqueControl& controller : controllers_)
+  {
+    const WinchFrictionParams& params = controller.frictionParams();
+    winches.push_back({{"id", controller.id()},
+                       {"coulomb", params.coulomb},
+                       {"viscous", params.viscous},
+                       {"stiction_speed", params.stiction_speed},
+                       {"angle_min", params.angle_min},
+                       {"angle_max", params.angle_max},
+                       {"angle_coulomb", params.angle_coulomb}});
+  }
+
+  std::ofstream ofile(filepath);
+  if (!ofile.is_open())
+    return false;
+  ofile << json({{"winches", winches}}).dump(2) << std::endl;
+  return ofile.good();
 }
@@ -28,6 +28,12 @@ JointsPVTDialog::JointsPVTDialog(QWidget* parent, CableRobot* robot,
   connect(&app_, SIGNAL(trajectoryComplete()), this, SLOT(handleTrajectoryCompleted()));
   connect(&app_, SIGNAL(trajectoryProgress(int, double)), this,
           SLOT(progressUpdateCallback(int, double)));
+  connect(&app_, SIGNAL(trajectoriesReadProgress(int, int)), this,
+          SLOT(handleReadProgress(int, int)));
+  connect(&app_, SIGNAL(trajectoriesReadComplete(bool, QString, QString)), this,
+          SLOT(handleReadCompleted(bool, QString, QString)));
+  connect(&app_, SIGNAL(trajectoriesCheckComplete(bool, QString)), this,
+          SLOT(handleCheckCompleted(bool, QString)));
 }
 
 JointsPVTDialog::~JointsPVTDialog()
@@ -40,6 +46,12 @@ JointsPVTDialog::~JointsPVTDialog()
              SLOT(handleTrajectoryCompleted()));
   disconnect(&app_, SIGNAL(trajectoryProgress(int, double)), this,
              SLOT(progressUpdateCallback(int, double)));
+  disconnect(&app_, SIGNAL(trajectoriesReadProgress(int, int)), this,
+             SLOT(handleReadProgress(int, int)));
+  disconnect(&app_, SIGNAL(trajectoriesReadComplete(bool, QString, QString)), this,
+             SLOT(handleReadCompleted(bool, QString, QString)));
+  disconnect(&app_, SIGNAL(trajectoriesCheckComplete(bool, QString)), this,
+             SLOT(handleCheckCompleted(bool, QString)));
 
   while (!line_edits_.empty())
   {
@@ -98,6 +110,61 @@ void JointsPVTDialog::handleTrajectoryCompleted()
           SLOT(progressUpdate(int, double)), Qt::QueuedConnection);
 }
 
+void JointsPVTDialog::handleReadProgress(const int files_done, const int files_num)
+{
+  ui->progressBar->setMaximum(files_num);
+  ui->progressBar->setValue(files_done);
+}
+
+void JointsPVTDialog::handleReadCompleted(const bool success,
+                                          const QString& failed_filepath,
+                                          const QString& reason)
+{
+  ui->pushButton_read->setText("Read trajectories");
+  ui->pushButton_addTraj->setEnabled(true);
+  ui->pushButton_removeTraj->setEnabled(input_form_pos_ > kInputFormPosInit_);
+  ui->progressBar->setFormat("%p%");
+  ui->progressBar->setMaximum(100);
+  ui->progressBar->setValue(0);
+  if (!success)
+  {
+    if (!failed_filepath.isEmpty())
+      QMessageBox::warning(this, "File Error",
+                           "Trajectory file '" + failed_filepath + "' is not valid" +
+                             (reason.isEmpty() ? "" : ":\n" + reason));
+    return;
+  }
+
+  num_traj_ = line_edits_.size();
+  updatePlots(app_.getTrajectorySet(traj_counter_)); // display first trajectory in queue
+  // Look for unsafe trajectories in background before running any, see
+  // handleCheckCompleted()
+  ui->progressBar->setFormat("Checking trajectories...");
+  ui->progressBar->setMaximum(0); // busy indicator
+  app_.startCheckingTrajectories();
+}
+
+void JointsPVTDialog::handleCheckCompleted(const bool safe, const QString& summary)
+{
+  // Trajectories being read replace checked ones, and they are checked in turn
+  if (app_.isReadingTrajectories())
+    return;
+  ui->progressBar->setFormat("%p%");
+  ui->progressBar->setMaximum(100);
+  ui->progressBar->setValue(0);
+  if (!safe &&
+      QMessageBox::question(this, "Trajectory Warning",
+                            "Some trajectories are not safe:\n" + summary +
+                              "\n\nDo you want to run them anyway?",
+                            QMessageBox::Yes | QMessageBox::No,
+                            QMessageBox::No) != QMessageBox::Yes)
+  {
+    CLOG(WARNING, "event") << "Unsafe trajectories rejected by user";
+    return;
+  }
+  ui->pushButton_start->setEnabled(true);
+}
+
 void JointsPVTDialog::progressUpdateCallback(const int progress_value,
                                              const double timestamp)
 {
@@ -193,6 +260,12 @@ void JointsPVTDialog::on_pushButton_removeTraj_clicked()
 void JointsPVTDialog::on_pushButton_read_clicked()
 {
   CLOG(TRACE, "event");
+  // Same button cancels an ongoing reading.
+  if (app_.isReadingTrajectories())
+  {
+    app_.cancelReadingTrajectories();
+    return;
+  }
   // Collect all given filepaths.
   QVector<QString> input_filenames;
   for (FileSelectionForm* form : line_edits_)
@@ -214,21 +287,15 @@ void JointsPVTDialog::on_pushButton_read_clicked()
   num_traj_ = 0;
   traj_counter_ = 0;
 
-  // Read trajectories from each file.
-  for (const QString& input_filename : input_filenames)
-  {
-    if (!app_.readTrajectories(input_filename))
-    {
-      CLOG(WARNING, "event") << "Trajectory file is not valid";
-      QMessageBox::warning(this, "File Error",
-                           "Trajectory file '" + input_filename + "' is not valid");
-      return;
-    }
-    num_traj_++;
-  }
-
-  updatePlots(app_.getTrajectorySet(traj_counter_)); // display first trajectory in queue
-  ui->pushButton_start->setEnabled(true);
+  // Read trajectories from all files concurrently, see handleReadCompleted().
+  ui->pushButton_start->setDisabled(true);
+  ui->pushButton_addTraj->setDisabled(true);
+  ui->pushButton_removeTraj->setDisabled(true);
+  ui->pushButton_read->setText("Cancel reading");
+  ui->progressBar->setFormat("Reading trajectories... %v/%m");
+  ui->progressBar->setMaximum(input_filenames.size());
+  ui->progressBar->setValue(0);
+  app_.startReadingTrajectories(input_filenames);
 }
 
 void JointsPVTDialog::on_checkBox_infLoop_toggled(bool checked)
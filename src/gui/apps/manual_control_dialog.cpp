@@ -8,6 +8,8 @@
 #include "gui/apps/manual_control_dialog.h"
 #include "ui_manual_control_dialog.h"
 
+#include <cmath>
+
 ManualControlDialog::ManualControlDialog(QWidget* parent, CableRobot* robot)
   : QDialog(parent), ui(new Ui::ManualControlDialog), robot_ptr_(robot), app_(this, robot)
 {
@@ -70,6 +72,21 @@ void ManualControlDialog::updateActualXYZ()
 
 //--------- Private GUI slots -------------------------------------------------------//
 
+void ManualControlDialog::on_spinBox_x_editingFinished()
+{
+  updateTarget(Coordinates::X, ui->spinBox_x);
+}
+
+void ManualControlDialog::on_spinBox_y_editingFinished()
+{
+  updateTarget(Coordinates::Y, ui->spinBox_y);
+}
+
+void ManualControlDialog::on_spinBox_z_editingFinished()
+{
+  updateTarget(Coordinates::Z, ui->spinBox_z);
+}
+
 void ManualControlDialog::on_pushButton_reset_clicked()
 {
   CLOG(TRACE, "event");
@@ -90,6 +107,16 @@ void ManualControlDialog::resetTargetXYZ()
 {
   grabnum::Vector3d actual_pos = app_.getActualPos();
   ui->spinBox_x->setValue(static_cast<int>(actual_pos(Coordinates::X) * 1000));
-  ui->spinBox_x->setValue(static_cast<int>(actual_pos(Coordinates::Y) * 1000));
-  ui->spinBox_x->setValue(static_cast<int>(actual_pos(Coordinates::Z) * 1000));
+  ui->spinBox_y->setValue(static_cast<int>(actual_pos(Coordinates::Y) * 1000));
+  ui->spinBox_z->setValue(static_cast<int>(actual_pos(Coordinates::Z) * 1000));
+}
+
+void ManualControlDialog::updateTarget(const Coordinates coord, QSpinBox* spin_box)
+{
+  const int target = static_cast<int>(std::round(app_.getTargetPos()(coord) * 1000));
+  if (spin_box->value() == target)
+    return;
+  // Show actual target if not accepted as is, i.e. either clamped or previous one
+  if (!app_.setTarget(coord, spin_box->value() / 1000.0))
+    spin_box->setValue(static_cast<int>(std::round(app_.getTargetPos()(coord) * 1000)));
 }
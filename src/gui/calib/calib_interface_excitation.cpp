@@ -8,10 +8,9 @@
 #include "gui/calib/calib_interface_excitation.h"
 #include "ui_calib_interface_excitation.h"
 
-CalibInterfaceExcitation::CalibInterfaceExcitation(
-  QWidget* parent, CableRobot* robot, const vect<grabcdpr::ActuatorParams>& params)
+CalibInterfaceExcitation::CalibInterfaceExcitation(QWidget* parent, CableRobot* robot)
   : QDialog(parent), ui(new Ui::CalibInterfaceExcitation), robot_ptr_(robot),
-    app_(this, robot, params)
+    app_(this, robot)
 {
   ui->setupUi(this);
   setAttribute(Qt::WA_DeleteOnClose);
@@ -64,6 +63,9 @@ void CalibInterfaceExcitation::handleStateChanged(const quint8& state)
   {
     case CalibExcitation::ST_IDLE:
       ui->pushButton_enable->setText(tr("Enable"));
+      ui->pushButton_loadExcitation->setDisabled(true);
+      ui->pushButton_identifyFriction->setDisabled(true);
+      ui->pushButton_logging->setDisabled(true);
       break;
     case CalibExcitation::ST_ENABLED:
       ui->pushButton_enable->setText(tr("Disable"));
@@ -73,6 +75,8 @@ void CalibInterfaceExcitation::handleStateChanged(const quint8& state)
         on_radioButton_position_clicked();
       break;
     case CalibExcitation::ST_POS_CONTROL:
+      ui->pushButton_loadExcitation->setEnabled(true);
+      ui->pushButton_identifyFriction->setEnabled(true);
       ui->pushButton_logging->setEnabled(true);
       ui->pushButton_enable->setEnabled(true);
       ui->pushButton_return->setEnabled(true);
@@ -80,6 +84,8 @@ void CalibInterfaceExcitation::handleStateChanged(const quint8& state)
       ui->radioButton_position->setEnabled(true);
       break;
     case CalibExcitation::ST_LOGGING:
+      ui->pushButton_loadExcitation->setDisabled(true);
+      ui->pushButton_identifyFriction->setDisabled(true);
       ui->pushButton_enable->setDisabled(true);
       ui->pushButton_return->setDisabled(true);
       ui->pushButton_logging->setDisabled(true);
@@ -130,4 +136,29 @@ void CalibInterfaceExcitation::on_pushButton_return_clicked()
   close();
 }
 
+void CalibInterfaceExcitation::on_pushButton_loadExcitation_clicked()
+{
+  CLOG(TRACE, "event");
+  QString filepath =
+    QFileDialog::getOpenFileName(this, tr("Load Excitation"), tr(SRCDIR "/resources"),
+                                 tr("Excitation File (*.json)"));
+  if (filepath.isEmpty())
+    return;
+  if (!app_.loadExcitationParams(filepath))
+    QMessageBox::warning(this, "File Error", "Excitation file is not valid");
+}
+
 void CalibInterfaceExcitation::on_pushButton_logging_clicked() { app_.exciteAndLog(); }
+
+void CalibInterfaceExcitation::on_pushButton_identifyFriction_clicked()
+{
+  CLOG(TRACE, "event");
+  QString filepath = QFileDialog::getOpenFileName(
+    this, tr("Identify Winches Friction"), tr("/tmp/cable-robot-logs"),
+    tr("Binary Data Log (*.bin)"));
+  if (filepath.isEmpty())
+    return;
+  if (!app_.identifyWinchesFriction(filepath))
+    QMessageBox::warning(this, "File Error",
+                         "Winches friction could not be identified from this log");
+}
@@ -28,8 +28,7 @@ CalibrationDialog::~CalibrationDialog()
 
 void CalibrationDialog::on_buttonBox_accepted()
 {
-  interface_ =
-    new CalibInterfaceExcitation(parentWidget(), robot_ptr_, params_.actuators);
+  interface_ = new CalibInterfaceExcitation(parentWidget(), robot_ptr_);
   connect(interface_, SIGNAL(destroyed()), this, SLOT(fwdCalibFinished()));
   interface_->show();
   CLOG(INFO, "event") << "Prompt " << ui->comboBox_calibMethod->currentText()
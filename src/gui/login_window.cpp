@@ -133,8 +133,13 @@ void LoginWindow::on_pushButton_loadDefault_clicked()
   CLOG(TRACE, "event");
   QString default_filename(SRCDIR);
   default_filename.append("config/default.json");
+  if (!ParseConfigFile(default_filename))
+  {
+    CLOG(WARNING, "event") << "Default configuration file is not valid";
+    QMessageBox::warning(this, "File Error", "Default configuration file is not valid");
+    return;
+  }
   CLOG(INFO, "event") << "Loaded default configuration file '" << default_filename << "'";
-  ParseConfigFile(default_filename);
   main_gui = new MainGUI(this, config_);
   hide();
   CLOG(INFO, "event") << "Hide login window";
@@ -146,5 +151,20 @@ bool LoginWindow::ParseConfigFile(QString& config_filename)
 {
   RobotConfigJsonParser parser;
   CLOG(INFO, "event") << "Parsing configuration file '" << config_filename << "'...";
-  return parser.ParseFile(config_filename, &config_);
+  if (!parser.ParseFile(config_filename, &config_))
+    return false;
+  // Status of all active actuators must fit in a single frame, to be logged and
+  // controlled together: refuse configurations exceeding it rather than truncating them
+  size_t active_actuators_num = 0;
+  for (const grabcdpr::ActuatorParams& actuator : config_.actuators)
+    if (actuator.active)
+      active_actuators_num++;
+  if (active_actuators_num > kMaxActuators)
+  {
+    CLOG(ERROR, "event") << "Configuration has " << active_actuators_num
+                         << " active actuators, but at most " << kMaxActuators
+                         << " are supported";
+    return false;
+  }
+  return true;
 }
@@ -9,7 +9,8 @@
 #include "ui_main_gui.h"
 
 MainGUI::MainGUI(QWidget* parent, const grabcdpr::RobotParams &config)
-  : QDialog(parent), ui(new Ui::MainGUI), config_params_(config)
+  : QDialog(parent), ui(new Ui::MainGUI), config_params_(config),
+    winches_controller_(config.actuators)
 {
   ui->setupUi(this);
 
@@ -197,7 +198,8 @@ void MainGUI::on_pushButton_freedrive_pressed()
   if (freedrive_)
   {
     robot_ptr_->SetController(nullptr);
-    delete man_ctrl_ptr_;
+    delete freedrive_ctrl_ptr_;
+    freedrive_ctrl_ptr_ = nullptr;
     if (robot_ptr_->GetCurrentState() != CableRobot::ST_READY)
       robot_ptr_->DisableMotors();
     freedrive_ = false;
@@ -223,25 +225,21 @@ void MainGUI::on_pushButton_freedrive_pressed()
     }
   }
 
-  // Set all motors in torque control mode
-  man_ctrl_ptr_ = new ControllerSingleDrive(motor_id_, robot_ptr_->GetRtCycleTimeNsec());
-  man_ctrl_ptr_->SetMotorTorqueSsErrTol(kTorqueSsErrTol_);
-  robot_ptr_->SetController(man_ctrl_ptr_);
-  for (const id_t id : robot_ptr_->GetActiveMotorsID())
-  {
-    pthread_mutex_lock(&robot_ptr_->Mutex());
-    man_ctrl_ptr_->SetMotorID(id);
-    man_ctrl_ptr_->SetMode(ControlMode::MOTOR_TORQUE);
-    man_ctrl_ptr_->SetMotorTorqueTarget(kFreedriveTorque_);
-    pthread_mutex_unlock(&robot_ptr_->Mutex());
-    // Wait until each motor reached user-given initial torque setpoint
-    if (robot_ptr_->WaitUntilTargetReached() != RetVal::OK)
-    {
-      appendText2Browser(
-        QString("WARNING: Could not switch motor %1 to torque control mode").arg(id));
-      break;
-    }
-  }
+  // Set all motors in torque control mode at once
+  const vect<id_t> motors_id = robot_ptr_->GetActiveMotorsID();
+  freedrive_ctrl_ptr_ =
+    new ControllerMultiDrive(motors_id, robot_ptr_->GetRtCycleTimeNsec());
+  freedrive_ctrl_ptr_->SetMotorTorqueSsErrTol(kTorqueSsErrTol_);
+  // Friction may have been identified meanwhile
+  winches_controller_.loadFrictionParams(WinchesTorqueControl::kDefaultFrictionFilepath);
+  freedrive_ctrl_ptr_->SetWinchesController(&winches_controller_);
+  freedrive_ctrl_ptr_->SetMode(ControlMode::MOTOR_TORQUE);
+  freedrive_ctrl_ptr_->SetMotorsTorqueTarget(
+    vect<int16_t>(motors_id.size(), kFreedriveTorque_));
+  robot_ptr_->SetController(freedrive_ctrl_ptr_);
+  // Wait until all motors reached initial torque setpoint
+  if (robot_ptr_->WaitUntilTargetReached() != RetVal::OK)
+    appendText2Browser("WARNING: Could not switch all motors to torque control mode");
   appendText2Browser("Freedrive mode ACTIVATED\nYou can now manually move the platform");
   freedrive_ = true;
 }
@@ -51,7 +51,9 @@ const QString HomingProprioceptive::kMatlabOptimizationResultsLoc =
 
 HomingProprioceptive::HomingProprioceptive(QObject* parent, CableRobot* robot)
   : QObject(parent), StateMachine(ST_MAX_STATES), robot_ptr_(robot),
-    controller_(robot->GetRtCycleTimeNsec()), optimization_progess_timer_(this)
+    controller_(robot->GetRtCycleTimeNsec()),
+    startup_controller_(robot->GetActiveMotorsID(), robot->GetRtCycleTimeNsec()),
+    optimization_progess_timer_(this)
 {
   // Initialize with default values
   num_meas_   = kNumMeasMin_;
@@ -59,6 +61,7 @@ HomingProprioceptive::HomingProprioceptive(QObject* parent, CableRobot* robot)
   ExternalEvent(ST_IDLE);
   prev_state_ = ST_IDLE;
   controller_.SetMotorTorqueSsErrTol(kTorqueSsErrTol_);
+  startup_controller_.SetMotorTorqueSsErrTol(kTorqueSsErrTol_);
 
   // Setup connection to track robot status
   active_actuators_id_ = robot_ptr_->GetActiveMotorsID();
@@ -283,6 +286,7 @@ void HomingProprioceptive::updateOptimizationProgress()
 
 GUARD_DEFINE(HomingProprioceptive, GuardIdle, NoEventData)
 {
+  TRACE_SCOPE("guard", "HomingProprioceptive::GuardIdle");
   if (prev_state_ != ST_FAULT)
     return true;
 
@@ -328,6 +332,7 @@ STATE_DEFINE(HomingProprioceptive, Idle, NoEventData)
 
 GUARD_DEFINE(HomingProprioceptive, GuardEnabled, NoEventData)
 {
+  TRACE_SCOPE("guard", "HomingProprioceptive::GuardEnabled");
   robot_ptr_->SetController(nullptr);
   robot_ptr_->EnableMotors();
 
@@ -378,23 +383,16 @@ STATE_DEFINE(HomingProprioceptive, StartUp, HomingProprioceptiveStartData)
   reg_pos_.resize(num_meas_);
 #endif
 
-  RetVal ret = RetVal::OK;
-  robot_ptr_->SetController(&controller_);
-  for (size_t i = 0; i < active_actuators_id_.size(); ++i)
-  {
-    // Setup initial target torque for each motor
-    init_torques_.push_back(data->init_torques[i]);
-    pthread_mutex_lock(&robot_ptr_->Mutex());
-    controller_.SetMotorID(active_actuators_id_[i]);
-    controller_.SetMode(ControlMode::MOTOR_TORQUE);
-    controller_.SetMotorTorqueTarget(init_torques_.back()); // = data->init_torques[i]
-    pthread_mutex_unlock(&robot_ptr_->Mutex());
-    // Wait until each motor reached user-given initial torque setpoint
-    ret = robot_ptr_->WaitUntilTargetReached();
-    if (ret != RetVal::OK)
-      break;
-    msg.append(QString("\n\t%1±%2 ‰").arg(init_torques_.back()).arg(kTorqueSsErrTol_));
-  }
+  // Setup initial target torques of all motors at once
+  init_torques_ = data->init_torques;
+  startup_controller_.SetMode(ControlMode::MOTOR_TORQUE);
+  startup_controller_.SetMotorsTorqueTarget(init_torques_);
+  robot_ptr_->SetController(&startup_controller_);
+  // Wait until all motors reached user-given initial torque setpoints
+  RetVal ret = robot_ptr_->WaitUntilTargetReached();
+  if (ret == RetVal::OK)
+    for (const qint16 init_torque : init_torques_)
+      msg.append(QString("\n\t%1±%2 ‰").arg(init_torque).arg(kTorqueSsErrTol_));
   if (ret != RetVal::OK || robot_ptr_->WaitUntilPlatformSteady(-1.) != RetVal::OK)
   {
     emit printToQConsole("WARNING: Start up phase failed");
@@ -414,6 +412,7 @@ STATE_DEFINE(HomingProprioceptive, StartUp, HomingProprioceptiveStartData)
 
 GUARD_DEFINE(HomingProprioceptive, GuardSwitch, NoEventData)
 {
+  TRACE_SCOPE("guard", "HomingProprioceptive::GuardSwitch");
   if (prev_state_ == ST_START_UP)
     return true;
 
@@ -482,6 +481,7 @@ STATE_DEFINE(HomingProprioceptive, SwitchCable, NoEventData)
 #endif
   meas_step_ = 0; // reset
 
+  robot_ptr_->SetController(&controller_); // in case we come from start up phase
   if (robot_ptr_->WaitUntilTargetReached() == RetVal::OK &&
       robot_ptr_->WaitUntilPlatformSteady(-1.) == RetVal::OK)
   {
@@ -717,6 +717,7 @@ void HomingProprioceptive::PrintStateTransition(const States current_state,
 {
   if (current_state == new_state)
     return;
+  TRACE_STATE(trace_track_, kStatesStr[new_state]);
   QString msg;
   if (current_state != ST_MAX_STATES)
     msg = QString("Homing state transition: %1 --> %2")
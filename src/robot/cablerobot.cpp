@@ -7,16 +7,53 @@
 
 #include "robot/cablerobot.h"
 
+#include <cmath>
+
 constexpr double CableRobot::kMaxWaitTimeSec;
 constexpr double CableRobot::kCycleWaitTimeSec;
 constexpr char* CableRobot::kStatesStr_[];
 constexpr double CableRobot::kCutoffFreq_;
+constexpr double CableRobot::kWorkspaceResolution_;
+constexpr double CableRobot::kFlightRecorderPreTime_;
+constexpr double CableRobot::kFlightRecorderPostTime_;
+constexpr uint64_t CableRobot::kCtrlBudgetNsec_;
+constexpr uint32_t CableRobot::kCtrlMaxOverruns_;
+
+namespace {
+
+vect<id_t> ActiveActuatorsID(const grabcdpr::RobotParams& params)
+{
+  vect<id_t> active_actuators_id;
+  for (uint i = 0; i < params.actuators.size(); i++)
+    if (params.actuators[i].active)
+      active_actuators_id.push_back(i);
+  return active_actuators_id;
+}
+
+size_t CyclesInTime(const double time, const uint32_t cycle_t_nsec)
+{
+  return static_cast<size_t>(std::ceil(time / grabrt::NanoSec2Sec(cycle_t_nsec)));
+}
+
+} // end namespace
 
 CableRobot::CableRobot(QObject* parent, const grabcdpr::RobotParams& params)
   : QObject(parent), StateMachine(ST_MAX_STATES), platform_(grabcdpr::TILT_TORSION),
-    params_(params), log_buffer_(el::Loggers::getLogger("data")),
-    stop_waiting_cmd_recv_(false), is_waiting_(false), prev_state_(ST_MAX_STATES)
+    params_(params), log_buffer_("/tmp/cable-robot-logs/data.bin"),
+    flight_recorder_("/tmp/cable-robot-logs",
+                     CyclesInTime(kFlightRecorderPreTime_, GetRtCycleTimeNsec()),
+                     CyclesInTime(kFlightRecorderPostTime_, GetRtCycleTimeNsec())),
+    stop_waiting_cmd_recv_(false), is_waiting_(false),
+    ctrl_pipeline_(LimitClampStage(ActiveActuatorsID(params)),
+                   RateLimitStage(ActiveActuatorsID(params), GetRtCycleTimeNsec())),
+    ctrl_budget_(kCtrlBudgetNsec_, kCtrlMaxOverruns_),
+    hold_controller_(GetRtCycleTimeNsec()),
+    prev_state_(ST_MAX_STATES)
 {
+#if ENABLE_TRACING
+  Tracer::Start();
+#endif
+  TRACE_THREAD_NAME("main");
   PrintStateTransition(prev_state_, ST_IDLE);
   prev_state_ = ST_IDLE;
 
@@ -31,6 +68,12 @@ CableRobot::CableRobot(QObject* parent, const grabcdpr::RobotParams& params)
   easycat2_ptr_ = new grabec::TestEasyCAT2Slave(slave_pos++);
   slaves_ptrs_.push_back(easycat2_ptr_);
 #endif
+  // Configurations are validated at loading, this is only a last line of defence
+  const size_t active_actuators_num = ActiveActuatorsID(params).size();
+  if (active_actuators_num > kMaxActuators)
+    CLOG(FATAL, "event") << "Too many active actuators (" << active_actuators_num
+                         << "): at most " << kMaxActuators
+                         << " can be logged and controlled";
   for (uint i = 0; i < params.actuators.size(); i++)
   {
     grabcdpr::CableVars cable;
@@ -45,6 +88,15 @@ CableRobot::CableRobot(QObject* parent, const grabcdpr::RobotParams& params)
               SLOT(forwardPrintToQConsole(QString)));
     }
   }
+  // Set points of all controllers are bounded within the joint limits of this rig
+  if (!ctrl_pipeline_.GetStage<0>().LoadLimits(LimitClampStage::kDefaultLimitsFilepath))
+    CLOG(WARNING, "event") << "Joint limits could not be loaded from '"
+                           << LimitClampStage::kDefaultLimitsFilepath
+                           << "': cable lengths and motor positions are unbounded";
+  // Allocate all per-motor state of the hold controller now, so that engaging it from
+  // the real time thread never resizes anything
+  hold_controller_.SetMotorsID(active_actuators_id_);
+  hold_controller_.Reset();
   num_slaves_ = slaves_ptrs_.size();
   for (grabec::EthercatSlave* slave_ptr : slaves_ptrs_)
     num_domain_elements_ += slave_ptr->GetDomainEntriesNum();
@@ -52,10 +104,10 @@ CableRobot::CableRobot(QObject* parent, const grabcdpr::RobotParams& params)
   // Setup data logging
   rt_logging_enabled_ = false;
   rt_logging_mod_     = 1;
-  meas_.resize(active_actuators_id_.size());
-  connect(this, SIGNAL(sendMsg(QByteArray)), &log_buffer_, SLOT(collectMsg(QByteArray)),
-          Qt::QueuedConnection);
   log_buffer_.start();
+  connect(&flight_recorder_, SIGNAL(printToQConsole(QString)), this,
+          SLOT(forwardPrintToQConsole(QString)), Qt::QueuedConnection);
+  flight_recorder_.start(QThread::LowPriority);
 
   // Setup timers for components' status update
   motor_status_timer_ = new QTimer(this);
@@ -63,14 +115,33 @@ CableRobot::CableRobot(QObject* parent, const grabcdpr::RobotParams& params)
   active_actuators_status_.resize(active_actuators_id_.size());
   actuator_status_timer_ = new QTimer(this);
   connect(actuator_status_timer_, SIGNAL(timeout()), this, SLOT(emitActuatorStatus()));
+  ctrl_budget_timer_ = new QTimer(this);
+  connect(ctrl_budget_timer_, SIGNAL(timeout()), this, SLOT(checkCtrlBudget()));
+  ctrl_budget_timer_->start(kCtrlBudgetIntervalMsec_);
+
+  // Load or compute wrench-feasible workspace in background
+  workspace_analyzer_ = new WorkspaceAnalyzer(
+    this, params_, WorkspaceGridParams::FromRobotParams(params_, kWorkspaceResolution_));
+  connect(workspace_analyzer_, SIGNAL(printToQConsole(QString)), this,
+          SLOT(forwardPrintToQConsole(QString)), Qt::QueuedConnection);
+  connect(workspace_analyzer_, SIGNAL(resultsReady()), this, SLOT(adoptWorkspace()),
+          Qt::QueuedConnection);
+  workspace_analyzer_->start(QThread::LowPriority);
 }
 
 CableRobot::~CableRobot()
 {
+  // Close workspace analysis, if still running
+  disconnect(workspace_analyzer_, SIGNAL(printToQConsole(QString)), this,
+             SLOT(forwardPrintToQConsole(QString)));
+  disconnect(workspace_analyzer_, SIGNAL(resultsReady()), this, SLOT(adoptWorkspace()));
+  delete workspace_analyzer_;
+
   // Close data logging
   log_buffer_.stop();
-  disconnect(this, SIGNAL(sendMsg(QByteArray)), &log_buffer_,
-             SLOT(collectMsg(QByteArray)));
+  disconnect(&flight_recorder_, SIGNAL(printToQConsole(QString)), this,
+             SLOT(forwardPrintToQConsole(QString)));
+  flight_recorder_.stop();
 
   // Close timers for components' status update
   StopTimers();
@@ -78,9 +149,25 @@ CableRobot::~CableRobot()
   disconnect(actuator_status_timer_, SIGNAL(timeout()), this, SLOT(emitActuatorStatus()));
   delete motor_status_timer_;
   delete actuator_status_timer_;
+  ctrl_budget_timer_->stop();
+  disconnect(ctrl_budget_timer_, SIGNAL(timeout()), this, SLOT(checkCtrlBudget()));
+  delete ctrl_budget_timer_;
 
   // Stop RT thread before removing slaves
   thread_rt_.Stop();
+  for (size_t i = 0; i < SafetyPipeline::kStagesNum; i++)
+  {
+    const StageTiming timing = ctrl_pipeline_.GetTiming(i);
+    CLOG(INFO, "event") << "Control stage " << timing.name << ": " << timing.calls
+                        << " calls, mean " << timing.MeanNsec() << " ns, max "
+                        << timing.max_nsec << " ns";
+  }
+
+#if ENABLE_TRACING
+  Tracer::Stop();
+  if (Tracer::Export("/tmp/cable-robot-logs/trace.json"))
+    CLOG(INFO, "event") << "Trace exported to /tmp/cable-robot-logs/trace.json";
+#endif
 
   // Delete robot components (i.e. ethercat slaves)
 #if INCLUDE_EASYCAT
@@ -161,18 +248,47 @@ void CableRobot::EnableMotor(const id_t motor_id)
     actuators_ptrs_[motor_id]->enable();
 }
 
-void CableRobot::EnableMotors()
-{
-  for (Actuator* actuator_ptr : active_actuators_ptrs_)
-    if (!actuator_ptr->IsEnabled())
-      actuator_ptr->enable();
-}
+void CableRobot::EnableMotors() { EnableMotors(active_actuators_id_); }
 
 void CableRobot::EnableMotors(const vect<id_t>& motors_id)
 {
+  TRACE_SCOPE("wait", "CableRobot::EnableMotors");
+  // All drives go through their enable sequence in parallel, polled by a single loop.
+  vect<Actuator*> pending_actuators_ptrs;
   for (const id_t& motor_id : motors_id)
-    if (actuators_ptrs_[motor_id]->IsActive())
-      actuators_ptrs_[motor_id]->enable();
+    if (actuators_ptrs_[motor_id]->IsActive() && !actuators_ptrs_[motor_id]->IsEnabled())
+    {
+      actuators_ptrs_[motor_id]->StartEnableSequence();
+      pending_actuators_ptrs.push_back(actuators_ptrs_[motor_id]);
+    }
+  if (pending_actuators_ptrs.empty())
+    return;
+
+  const size_t drives_num = pending_actuators_ptrs.size();
+  size_t enabled_num      = 0;
+  grabrt::ThreadClock clock(grabrt::Sec2NanoSec(kCycleWaitTimeSec));
+  while (!pending_actuators_ptrs.empty())
+  {
+    for (auto it = pending_actuators_ptrs.begin(); it != pending_actuators_ptrs.end();)
+    {
+      const Actuator::SequenceStatus status = (*it)->AdvanceEnableSequence();
+      if (status == Actuator::SEQ_IN_PROGRESS)
+      {
+        ++it;
+        continue;
+      }
+      if (status == Actuator::SEQ_DONE)
+      {
+        (*it)->enable(); // drive already enabled: only updates actuator state
+        enabled_num++;
+      }
+      it = pending_actuators_ptrs.erase(it);
+    }
+    if (!pending_actuators_ptrs.empty())
+      clock.WaitUntilNext();
+  }
+  CLOG(INFO, "event") << "Enabled " << enabled_num << "/" << drives_num
+                      << " drives in " << clock.ElapsedFromStart() << " sec";
 }
 
 void CableRobot::DisableMotor(const id_t motor_id)
@@ -181,21 +297,15 @@ void CableRobot::DisableMotor(const id_t motor_id)
     actuators_ptrs_[motor_id]->disable();
 }
 
-void CableRobot::DisableMotors()
-{
-  for (Actuator* actuator_ptr : active_actuators_ptrs_)
-  {
-    actuator_ptr->disable();
-  }
-}
+void CableRobot::DisableMotors() { DisableMotors(active_actuators_id_); }
 
 void CableRobot::DisableMotors(const vect<id_t>& motors_id)
 {
+  vect<Actuator*> enabled_actuators_ptrs;
   for (const id_t& motor_id : motors_id)
-    if (actuators_ptrs_[motor_id]->IsActive())
-    {
-      actuators_ptrs_[motor_id]->disable();
-    }
+    if (actuators_ptrs_[motor_id]->IsActive() && actuators_ptrs_[motor_id]->IsEnabled())
+      enabled_actuators_ptrs.push_back(actuators_ptrs_[motor_id]);
+  DisableDrives(enabled_actuators_ptrs, false);
 }
 
 void CableRobot::SetMotorOpMode(const id_t motor_id, const qint8 op_mode)
@@ -217,18 +327,21 @@ void CableRobot::SetMotorsOpMode(const vect<id_t>& motors_id, const qint8 op_mod
 
 void CableRobot::ClearFaults()
 {
+  vect<Actuator*> faulted_actuators_ptrs;
   for (Actuator* actuator_ptr : active_actuators_ptrs_)
     if (actuator_ptr->IsInFault())
-      actuator_ptr->faultReset();
+      faulted_actuators_ptrs.push_back(actuator_ptr);
+  DisableDrives(faulted_actuators_ptrs, true);
 }
 
 void CableRobot::CollectMeasRt()
 {
-  for (size_t i = 0; i < active_actuators_ptrs_.size(); i++)
-  {
-    meas_[i].body             = active_actuators_ptrs_[i]->GetStatus();
-    meas_[i].header.timestamp = clock_.Elapsed();
-  }
+  // All actuators share the same timestamp and cycle counter within a frame.
+  frame_.header.timestamp   = clock_.Elapsed();
+  frame_.body.cycle_count   = rt_cycle_counter_;
+  frame_.body.actuators_num = static_cast<uint8_t>(active_actuators_ptrs_.size());
+  for (size_t i = 0; i < frame_.body.actuators_num; i++)
+    frame_.body.actuators[i] = active_actuators_ptrs_[i]->GetStatus();
 }
 
 void CableRobot::CollectMeas()
@@ -238,20 +351,18 @@ void CableRobot::CollectMeas()
   pthread_mutex_unlock(&mutex_);
 }
 
-void CableRobot::DumpMeas() const
+void CableRobot::DumpMeas()
 {
-  for (size_t i = 0; i < active_actuators_ptrs_.size(); i++)
-    emit sendMsg(meas_[i].serialized());
+  // Log buffer accepts one producer at a time: RT-thread mutex serializes them.
+  pthread_mutex_lock(&mutex_);
+  log_buffer_.push(frame_);
+  pthread_mutex_unlock(&mutex_);
 }
 
 void CableRobot::CollectAndDumpMeasRt()
 {
-  for (size_t i = 0; i < active_actuators_ptrs_.size(); i++)
-  {
-    meas_[i].body             = active_actuators_ptrs_[i]->GetStatus();
-    meas_[i].header.timestamp = clock_.Elapsed();
-    emit sendMsg(meas_[i].serialized());
-  }
+  CollectMeasRt();
+  log_buffer_.push(frame_);
 }
 
 void CableRobot::CollectAndDumpMeas()
@@ -268,8 +379,8 @@ void CableRobot::CollectAndDumpMeas(const id_t actuator_id)
       continue;
     pthread_mutex_lock(&mutex_);
     ActuatorStatusMsg msg(clock_.Elapsed(), active_actuators_ptrs_[i]->GetStatus());
+    log_buffer_.push(msg);
     pthread_mutex_unlock(&mutex_);
-    emit sendMsg(msg.serialized());
     break;
   }
 }
@@ -295,6 +406,12 @@ void CableRobot::FlushDataLogs()
   CLOG(INFO, "event") << "Data logs flushed";
 }
 
+void CableRobot::TriggerFlightRecorder()
+{
+  flight_recorder_.Trigger(FlightRecorder::MANUAL);
+  CLOG(INFO, "event") << "Flight recorder manually triggered";
+}
+
 bool CableRobot::GoHome()
 {
   if (!MotorsEnabled())
@@ -304,26 +421,28 @@ bool CableRobot::GoHome()
   }
   emit printToQConsole("Moving to home position...");
 
-  ControllerSingleDrive controller(GetRtCycleTimeNsec());
+  // Move all motors at once, so that they reach home position together
+  vect<int32_t> home_positions;
+  for (Actuator* actuator_ptr : active_actuators_ptrs_)
+    home_positions.push_back(actuator_ptr->GetWinch().GetServoHomePos());
+  ControllerMultiDrive controller(active_actuators_id_, GetRtCycleTimeNsec());
+  controller.SetMode(ControlMode::MOTOR_POSITION);
+  controller.SetMotorsPosTarget(home_positions, true, 3.0);
+
   // Temporarly switch to local controller for moving to home pos
+  pthread_mutex_lock(&mutex_);
   ControllerBase* prev_controller = controller_;
   controller_                     = &controller;
+  ctrl_budget_.Reset();
+  pthread_mutex_unlock(&mutex_);
 
-  for (Actuator* actuator_ptr : active_actuators_ptrs_)
+  RetVal ret = WaitUntilTargetReached();
+  SetController(prev_controller); // restore original controller
+  if (ret != RetVal::OK)
   {
-    pthread_mutex_lock(&mutex_);
-    controller.SetMotorID(actuator_ptr->ID());
-    controller.SetMode(ControlMode::MOTOR_POSITION);
-    controller.SetMotorPosTarget(actuator_ptr->GetWinch().GetServoHomePos(), true, 3.0);
-    pthread_mutex_unlock(&mutex_);
-
-    if (WaitUntilTargetReached() != RetVal::OK)
-    {
-      emit printToQConsole("WARNING: Transition to home position interrupted");
-      return false;
-    }
+    emit printToQConsole("WARNING: Transition to home position interrupted");
+    return false;
   }
-  controller_ = prev_controller; // restore original controller
 
   emit printToQConsole("Daddy, I'm home!");
   return true;
@@ -333,19 +452,32 @@ void CableRobot::SetController(ControllerBase* controller)
 {
   pthread_mutex_lock(&mutex_);
   controller_ = controller;
+  ctrl_budget_.Reset();
   pthread_mutex_unlock(&mutex_);
 }
 
 RetVal CableRobot::WaitUntilTargetReached(const double max_wait_time_sec)
 {
+  TRACE_SCOPE("wait", "CableRobot::WaitUntilTargetReached");
   qmutex_.lock();
   is_waiting_ = true;
   qmutex_.unlock();
   grabrt::ThreadClock clock(grabrt::Sec2NanoSec(kCycleWaitTimeSec));
   while (1)
   {
-    // Check if target is reached
+    // Check if controller was replaced for exceeding its time budget
     pthread_mutex_lock(&mutex_);
+    if (controller_ == &hold_controller_)
+    {
+      pthread_mutex_unlock(&mutex_);
+      qmutex_.lock();
+      is_waiting_ = false;
+      qmutex_.unlock();
+      emit printToQConsole(
+        "WARNING: Controller exceeded its time budget: operation aborted");
+      return RetVal::EINT;
+    }
+    // Check if target is reached
     if (controller_->TargetReached())
     {
       pthread_mutex_unlock(&mutex_);
@@ -383,6 +515,7 @@ RetVal CableRobot::WaitUntilTargetReached(const double max_wait_time_sec)
 
 RetVal CableRobot::WaitUntilPlatformSteady(const double max_wait_time_sec)
 {
+  TRACE_SCOPE("wait", "CableRobot::WaitUntilPlatformSteady");
   // Compute these once for all
   static constexpr size_t kBuffSize =
     static_cast<size_t>(kBufferingTimeSec_ / kCycleWaitTimeSec);
@@ -593,6 +726,8 @@ STATE_DEFINE(CableRobot, Error, NoEventData)
   PrintStateTransition(prev_state_, ST_ERROR);
   prev_state_ = ST_ERROR;
 
+  flight_recorder_.Trigger(FlightRecorder::ROBOT_ERROR);
+
   StopTimers();
 }
 
@@ -640,6 +775,36 @@ void CableRobot::emitActuatorStatus()
     idx = 0;
 }
 
+void CableRobot::checkCtrlBudget()
+{
+  const bool overrun  = ctrl_budget_.TakeOverrunWarning();
+  const bool fallback = ctrl_budget_.TakeFallbackNotice();
+  if (!overrun && !fallback)
+    return;
+
+  const BudgetStats stats = ctrl_budget_.GetStats();
+  CLOG(WARNING, "event") << "Controller time budget of " << stats.budget_nsec
+                         << " ns exceeded " << stats.overruns << " times in "
+                         << stats.calls << " cycles (worst " << stats.max_nsec
+                         << " ns, p99 " << stats.window_p99_nsec << " ns)";
+  if (overrun)
+    emit printToQConsole(
+      QString("WARNING: Controller exceeded its time budget of %1 us (worst %2 us)")
+        .arg(stats.budget_nsec / 1000)
+        .arg(stats.max_nsec / 1000));
+  if (fallback)
+    emit printToQConsole("ERROR: Controller repeatedly exceeded its time budget: "
+                         "motors are held in position");
+}
+
+void CableRobot::adoptWorkspace()
+{
+  workspace_ = workspace_analyzer_->GetGrid();
+  CLOG(INFO, "event") << "Wrench-feasible workspace available: "
+                      << workspace_.FeasibleNodesNum() << "/" << workspace_.NodesNum()
+                      << " feasible nodes";
+}
+
 //--------- Miscellaneous private ---------------------------------------------------//
 
 void CableRobot::PrintStateTransition(const States current_state,
@@ -647,6 +812,7 @@ void CableRobot::PrintStateTransition(const States current_state,
 {
   if (current_state == new_state)
     return;
+  TRACE_STATE(trace_track_, kStatesStr_[new_state]);
   QString msg;
   if (current_state != ST_MAX_STATES)
     msg = QString("CableRobot state transition: %1 --> %2")
@@ -662,6 +828,60 @@ void CableRobot::StopTimers()
   actuator_status_timer_->stop();
 }
 
+bool CableRobot::DisableDrives(const vect<Actuator*>& actuators_ptrs,
+                               const bool fault_reset)
+{
+  TRACE_SCOPE("wait", "CableRobot::DisableDrives");
+  if (actuators_ptrs.empty())
+    return true;
+  const QString operation = fault_reset ? "Fault reset" : "Disabling";
+
+  // Issue all commands at once, then wait for the slowest drive only.
+  for (Actuator* actuator_ptr : actuators_ptrs)
+    actuator_ptr->StartDisableSequence(fault_reset);
+  vect<Actuator*> pending_actuators_ptrs(actuators_ptrs);
+  size_t failures_num = 0;
+  grabrt::ThreadClock clock(grabrt::Sec2NanoSec(kCycleWaitTimeSec));
+  while (!pending_actuators_ptrs.empty())
+  {
+    for (auto it = pending_actuators_ptrs.begin(); it != pending_actuators_ptrs.end();)
+    {
+      const Actuator::SequenceStatus status = (*it)->AdvanceDisableSequence();
+      if (status == Actuator::SEQ_IN_PROGRESS)
+      {
+        ++it;
+        continue;
+      }
+      if (status == Actuator::SEQ_DONE)
+      {
+        CLOG(INFO, "event") << operation.toStdString() << " of drive " << (*it)->ID()
+                            << " completed in " << clock.ElapsedFromStart() << " sec";
+        // Drive already disabled: only updates actuator state
+        if (fault_reset)
+          (*it)->faultReset();
+        else
+          (*it)->disable();
+      }
+      else
+      {
+        emit printToQConsole(QString("WARNING: %1 of drive %2 FAILED after %3 sec")
+                               .arg(operation)
+                               .arg((*it)->ID())
+                               .arg(clock.ElapsedFromStart()));
+        failures_num++;
+      }
+      it = pending_actuators_ptrs.erase(it);
+    }
+    if (!pending_actuators_ptrs.empty())
+      clock.WaitUntilNext();
+  }
+  CLOG(INFO, "event") << operation.toStdString() << " of "
+                      << actuators_ptrs.size() - failures_num << "/"
+                      << actuators_ptrs.size() << " drives completed in "
+                      << clock.ElapsedFromStart() << " sec";
+  return failures_num == 0;
+}
+
 //--------- Ethercat related private functions --------------------------------------//
 
 void CableRobot::EcStateChangedCb(const std::bitset<3>& new_state)
@@ -700,63 +920,130 @@ void CableRobot::EcRtThreadStatusChanged(const bool active)
 
 void CableRobot::EcWorkFun()
 {
-  for (grabec::EthercatSlave* slave_ptr : slaves_ptrs_)
-    slave_ptr->ReadInputs(); // read pdos
+  TRACE_THREAD_NAME("rt");
+  TRACE_SCOPE("rt", "CableRobot::EcWorkFun");
+  rt_cycle_counter_++;
+
+  {
+    TRACE_SCOPE("rt", "ReadInputs");
+    for (grabec::EthercatSlave* slave_ptr : slaves_ptrs_)
+      slave_ptr->ReadInputs(); // read pdos
+  }
 
+  ctrl_actions_frame_.cycle_count = rt_cycle_counter_;
+  ctrl_actions_frame_.actions_num = 0;
   if (controller_ != nullptr)
     ControlStep();
 
-  static uint log_counter = 0;
-  if (rt_logging_enabled_ && (++log_counter % rt_logging_mod_ == 0))
   {
-    CollectAndDumpMeasRt();
-    log_counter = 0;
+    TRACE_SCOPE("rt", "Logging");
+    // Measurements are collected every cycle to feed the flight recorder
+    CollectMeasRt();
+    flight_recorder_.Record(frame_.header.timestamp, frame_.body, ctrl_actions_frame_);
+    uint32_t faults_mask = 0;
+    for (size_t i = 0; i < frame_.body.actuators_num; i++)
+      if (frame_.body.actuators[i].state == Actuator::ST_FAULT)
+        faults_mask |= 1u << i;
+    if (faults_mask & ~faults_mask_) // any new fault
+      flight_recorder_.Trigger(FlightRecorder::DRIVE_FAULT);
+    faults_mask_ = faults_mask;
+
+    static uint log_counter = 0;
+    if (rt_logging_enabled_ && (++log_counter % rt_logging_mod_ == 0))
+    {
+      log_buffer_.push(frame_);
+      log_counter = 0;
+    }
   }
 
-  for (grabec::EthercatSlave* slave_ptr : slaves_ptrs_)
-    slave_ptr->WriteOutputs(); // write all the necessary pdos
+  {
+    TRACE_SCOPE("rt", "WriteOutputs");
+    for (grabec::EthercatSlave* slave_ptr : slaves_ptrs_)
+      slave_ptr->WriteOutputs(); // write all the necessary pdos
+  }
 }
 
 void CableRobot::EcEmergencyFun() {}
 
 //--------- Control related private functions ---------------------------------------//
 
+void CableRobot::EngageHoldController()
+{
+  // Lives in the RT thread: hold controller is preallocated and never resized here
+  for (size_t i = 0; i < active_actuators_id_.size(); i++)
+  {
+    hold_controller_.SetMode(active_actuators_id_[i], ControlMode::MOTOR_POSITION);
+    hold_controller_.SetMotorPosTarget(active_actuators_id_[i],
+                                       active_actuators_status_[i].motor_position, false);
+  }
+  controller_ = &hold_controller_;
+}
+
 void CableRobot::ControlStep()
 {
+  TRACE_SCOPE("rt", "CableRobot::ControlStep");
   for (size_t i = 0; i < active_actuators_status_.size(); i++)
     active_actuators_status_[i] = active_actuators_ptrs_[i]->GetStatus();
 
+  const uint64_t start_nsec = Tracer::NowNsec();
   std::vector<ControlAction> ctrl_actions =
     controller_->CalcCtrlActions(cdpr_status_, active_actuators_status_);
+  if (controller_ != &hold_controller_ &&
+      ctrl_budget_.Record(Tracer::NowNsec() - start_nsec) == ControllerBudget::EXHAUSTED)
+  {
+    // Discard late actions and keep all motors still until a new controller is set
+    EngageHoldController();
+    ctrl_actions =
+      hold_controller_.CalcCtrlActions(cdpr_status_, active_actuators_status_);
+  }
+  ControlAction* actions = ctrl_actions_frame_.actions;
   for (const ControlAction& ctrl_action : ctrl_actions)
   {
     // Safety check to see if given motor id is valid
-    bool valid_id = false;
-    for (const id_t& actuator_id : active_actuators_id_)
-      if (ctrl_action.motor_id == actuator_id)
+    size_t active_idx = active_actuators_id_.size();
+    for (size_t i = 0; i < active_actuators_id_.size(); i++)
+      if (ctrl_action.motor_id == active_actuators_id_[i])
       {
-        valid_id = true;
+        active_idx = i;
         break;
       }
-    if (!valid_id)
+    if (active_idx == active_actuators_id_.size())
       continue;
 
     if (!actuators_ptrs_[ctrl_action.motor_id]->IsEnabled()) // safety check
       continue;
 
-    switch (ctrl_action.ctrl_mode)
+    // At most one action per active motor, the last one given, so that the frame never
+    // overflows: active motors fit in it by construction
+    size_t frame_idx = 0;
+    while (frame_idx < ctrl_actions_frame_.actions_num &&
+           actions[frame_idx].motor_id != ctrl_action.motor_id)
+      frame_idx++;
+    if (frame_idx == ctrl_actions_frame_.actions_num)
+      ctrl_actions_frame_.actions_num++;
+    ctrl_status_[frame_idx] = active_actuators_status_[active_idx];
+    actions[frame_idx]      = ctrl_action;
+  }
+
+  // Safety stages shared by all controllers, applied to all motors at once
+  ctrl_pipeline_.Apply(actions, ctrl_status_, ctrl_actions_frame_.actions_num);
+
+  for (size_t i = 0; i < ctrl_actions_frame_.actions_num; i++)
+  {
+    Actuator* actuator_ptr = actuators_ptrs_[actions[i].motor_id];
+    switch (actions[i].ctrl_mode)
     {
       case CABLE_LENGTH:
-        actuators_ptrs_[ctrl_action.motor_id]->SetCableLength(ctrl_action.cable_length);
+        actuator_ptr->SetCableLength(actions[i].cable_length);
         break;
       case MOTOR_POSITION:
-        actuators_ptrs_[ctrl_action.motor_id]->SetMotorPos(ctrl_action.motor_position);
+        actuator_ptr->SetMotorPos(actions[i].motor_position);
         break;
       case MOTOR_SPEED:
-        actuators_ptrs_[ctrl_action.motor_id]->SetMotorSpeed(ctrl_action.motor_speed);
+        actuator_ptr->SetMotorSpeed(actions[i].motor_speed);
         break;
       case MOTOR_TORQUE:
-        actuators_ptrs_[ctrl_action.motor_id]->SetMotorTorque(ctrl_action.motor_torque);
+        actuator_ptr->SetMotorTorque(actions[i].motor_torque);
         break;
       case NONE:
         break;
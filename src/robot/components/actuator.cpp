@@ -14,11 +14,12 @@ Actuator::Actuator(const id_t id, const uint8_t slave_position,
                    const grabcdpr::ActuatorParams& params, QObject* parent /* = NULL*/)
   : QObject(parent), StateMachine(ST_MAX_STATES), id_(id),
     slave_position_(slave_position), winch_(id, slave_position, params.winch),
-    pulley_(id, params.pulley)
+    pulley_(id, params.pulley), trace_track_("Actuator " + std::to_string(id))
 {
   active_ = params.active;
   clock_.SetCycleTime(kWaitCycleTimeNsec_);
   prev_state_ = ST_IDLE;
+  TRACE_STATE(trace_track_, kStatesStr_[ST_IDLE]);
 
   winch_.GetServo()->setParent(this);
   connect(winch_.GetServo(), SIGNAL(driveFaulted()), this, SLOT(faultTrigger()));
@@ -160,6 +161,74 @@ void Actuator::UpdateConfig()
   pulley_.UpdateConfig(winch_.GetServo()->GetAuxPosition());
 }
 
+void Actuator::StartEnableSequence() { seq_drive_state_ = -1; }
+
+Actuator::SequenceStatus Actuator::AdvanceEnableSequence()
+{
+  const GSWDStates drive_state =
+    static_cast<GSWDStates>(winch_.GetServo()->GetCurrentState());
+  if (drive_state == GSWDStates::ST_OPERATION_ENABLED)
+    return SEQ_DONE;
+  if (drive_state == GSWDStates::ST_FAULT)
+  {
+    emit printToQConsole(
+      QString("WARNING: Actuator state transition FAILED. Drive %1 is in fault.")
+        .arg(id_));
+    return SEQ_FAILED;
+  }
+
+  // Issue next command only once per drive state, restarting step timeout
+  if (static_cast<int>(drive_state) != seq_drive_state_)
+  {
+    seq_drive_state_ = static_cast<int>(drive_state);
+    seq_step_t0_     = clock_.GetCurrentTime();
+    switch (drive_state)
+    {
+      case GSWDStates::ST_SWITCH_ON_DISABLED:
+        winch_.GetServo()->Shutdown(); // prepare to switch on
+        break;
+      case GSWDStates::ST_READY_TO_SWITCH_ON:
+        winch_.GetServo()->SwitchOn(); // switch on voltage
+        break;
+      case GSWDStates::ST_SWITCHED_ON:
+        winch_.GetServo()->EnableOperation(); // enable drive
+        break;
+      default:
+        break; // transient state, wait for the drive
+    }
+    return SEQ_IN_PROGRESS;
+  }
+  if (clock_.Elapsed(seq_step_t0_) > kMaxTransitionTimeSec_)
+  {
+    emit printToQConsole(
+      QString("WARNING: Actuator state transition FAILED. Taking too long to enable "
+              "drive %1.")
+        .arg(id_));
+    return SEQ_FAILED;
+  }
+  return SEQ_IN_PROGRESS;
+}
+
+void Actuator::StartDisableSequence(const bool fault_reset)
+{
+  seq_step_t0_ = clock_.GetCurrentTime();
+  if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_SWITCH_ON_DISABLED)
+    return; // nothing to do
+  if (fault_reset)
+    winch_.GetServo()->FaultReset(); // clear fault and disable drive completely
+  else
+    winch_.GetServo()->DisableVoltage(); // disable drive completely
+}
+
+Actuator::SequenceStatus Actuator::AdvanceDisableSequence()
+{
+  if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_SWITCH_ON_DISABLED)
+    return SEQ_DONE;
+  if (clock_.Elapsed(seq_step_t0_) > kMaxTransitionTimeSec_)
+    return SEQ_FAILED;
+  return SEQ_IN_PROGRESS;
+}
+
 Actuator::States Actuator::DriveState2ActuatorState(const GSWDStates drive_state)
 {
   switch (drive_state)
@@ -178,24 +247,24 @@ Actuator::States Actuator::DriveState2ActuatorState(const GSWDStates drive_state
 // Guard condition to detemine whether Idle state is executed.
 GUARD_DEFINE(Actuator, GuardIdle, NoEventData)
 {
-  if (prev_state_ == ST_FAULT)
-    winch_.GetServo()->FaultReset(); // clear fault and disable drive completely
-  else
-    winch_.GetServo()->DisableVoltage(); // disable drive completely
-
+  TRACE_SCOPE("guard", "Actuator::GuardIdle");
+  // Completes immediately if drive was already disabled, e.g. by CableRobot
+  StartDisableSequence(prev_state_ == ST_FAULT);
   clock_.Reset();
-  timespec t0 = clock_.GetCurrentTime();
   while (1)
   {
-    if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_SWITCH_ON_DISABLED)
-      return true; // drive is disabled
-    if (clock_.Elapsed(t0) > kMaxTransitionTimeSec_)
+    switch (AdvanceDisableSequence())
     {
-      emit printToQConsole(
-        QString("WARNING: Actuator state transition FAILED. Taking too long to disable "
-                "drive %1.")
-          .arg(id_));
-      return false;
+      case SEQ_DONE:
+        return true; // drive is disabled
+      case SEQ_FAILED:
+        emit printToQConsole(
+          QString("WARNING: Actuator state transition FAILED. Taking too long to disable "
+                  "drive %1.")
+            .arg(id_));
+        return false;
+      case SEQ_IN_PROGRESS:
+        break;
     }
     clock_.WaitUntilNext();
   }
@@ -210,54 +279,20 @@ STATE_DEFINE(Actuator, Idle, NoEventData)
 // Guard condition to detemine whether Enable state is executed.
 GUARD_DEFINE(Actuator, GuardEnabled, NoEventData)
 {
-  winch_.GetServo()->Shutdown(); // prepare to switch on
-  clock_.Reset();
-  timespec t0 = clock_.GetCurrentTime();
-  while (1)
-  {
-    if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_READY_TO_SWITCH_ON)
-      break;
-    if (clock_.Elapsed(t0) > kMaxTransitionTimeSec_)
-    {
-      emit printToQConsole(QString("WARNING: Actuator state transition FAILED. Taking "
-                                   "too long to prepare to switch on drive %1.")
-                             .arg(id_));
-      return false;
-    }
-    clock_.WaitUntilNext();
-  }
-
-  winch_.GetServo()->SwitchOn(); // switch on voltage
+  TRACE_SCOPE("guard", "Actuator::GuardEnabled");
+  // Completes immediately if drive was already enabled, e.g. by CableRobot::EnableMotors
+  StartEnableSequence();
   clock_.Reset();
-  t0 = clock_.GetCurrentTime();
   while (1)
   {
-    if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_SWITCHED_ON)
-      break;
-    if (clock_.Elapsed(t0) > kMaxTransitionTimeSec_)
+    switch (AdvanceEnableSequence())
     {
-      emit printToQConsole(QString("WARNING: Actuator state transition FAILED. Taking "
-                                   "too long to switch on voltage of drive %1.")
-                             .arg(id_));
-      return false;
-    }
-    clock_.WaitUntilNext();
-  }
-
-  winch_.GetServo()->EnableOperation(); // enable drive
-  clock_.Reset();
-  t0 = clock_.GetCurrentTime();
-  while (1)
-  {
-    if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_OPERATION_ENABLED)
-      return true; // drive is enabled
-    if (clock_.Elapsed(t0) > kMaxTransitionTimeSec_)
-    {
-      emit printToQConsole(
-        QString("WARNING: Actuator state transition FAILED. Taking too long to enable "
-                "drive %1.")
-          .arg(id_));
-      return false;
+      case SEQ_DONE:
+        return true;
+      case SEQ_FAILED:
+        return false;
+      case SEQ_IN_PROGRESS:
+        break;
     }
     clock_.WaitUntilNext();
   }
@@ -272,23 +307,24 @@ STATE_DEFINE(Actuator, Enabled, NoEventData)
 // Guard condition to detemine whether Fault state is executed.
 GUARD_DEFINE(Actuator, GuardFault, NoEventData)
 {
-  winch_.GetServo()->FaultReset(); // clear fault and disable drive completely
+  TRACE_SCOPE("guard", "Actuator::GuardFault");
+  // Try to clear faults automatically
+  StartDisableSequence(true);
   clock_.Reset();
-  timespec t0 = clock_.GetCurrentTime();
   while (1)
   {
-    // Try to clear faults automatically
-    if (winch_.GetServo()->GetCurrentState() == GSWDStates::ST_SWITCH_ON_DISABLED)
-    {
-      InternalEvent(ST_IDLE);
-      return false;
-    }
-    if (clock_.Elapsed(t0) > kMaxTransitionTimeSec_)
+    switch (AdvanceDisableSequence())
     {
-      emit printToQConsole(
-        QString("WARNING: Attempt to automatically reset fault FAILED on drive %1.")
-          .arg(id_));
-      return true; // taking too long to disable drive. Something's wrong.
+      case SEQ_DONE:
+        InternalEvent(ST_IDLE);
+        return false;
+      case SEQ_FAILED:
+        emit printToQConsole(
+          QString("WARNING: Attempt to automatically reset fault FAILED on drive %1.")
+            .arg(id_));
+        return true; // taking too long to disable drive. Something's wrong.
+      case SEQ_IN_PROGRESS:
+        break;
     }
     clock_.WaitUntilNext();
   }
@@ -306,6 +342,7 @@ void Actuator::PrintStateTransition(const States current_state) const
 {
   if (current_state == prev_state_)
     return;
+  TRACE_STATE(trace_track_, kStatesStr_[current_state]);
   QString msg;
   msg = QString("Actuator %1 state transition: %2 --> %3")
           .arg(id_)
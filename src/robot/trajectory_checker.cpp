@@ -0,0 +1,621 @@
+/**
+ * @file trajectory_checker.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing definitions of functions and class declared in
+ * trajectory_checker.h.
+ */
+
+#include "robot/trajectory_checker.h"
+
+#include <QCryptographicHash>
+#include <QStringList>
+
+#include <array>
+
+#include "utils/linear_system.h"
+
+namespace {
+
+using Point3 = std::array<double, 3>;
+
+Point3 Sub(const Point3& a, const Point3& b)
+{
+  return {{a[0] - b[0], a[1] - b[1], a[2] - b[2]}};
+}
+
+double Dot(const Point3& a, const Point3& b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+Point3 Cross(const Point3& a, const Point3& b)
+{
+  return {{a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+           a[0] * b[1] - a[1] * b[0]}};
+}
+
+double Clamp01(const double value) { return std::min(std::max(value, 0.0), 1.0); }
+
+/**
+ * @brief Compute the minimum distance between two segments.
+ * @param[in] p1 Start of first segment.
+ * @param[in] q1 End of first segment.
+ * @param[in] p2 Start of second segment.
+ * @param[in] q2 End of second segment.
+ * @return The minimum distance between the two segments.
+ */
+double SegmentsDistance(const Point3& p1, const Point3& q1, const Point3& p2,
+                        const Point3& q2)
+{
+  static constexpr double kEps = 1e-12;
+
+  const Point3 d1 = Sub(q1, p1);
+  const Point3 d2 = Sub(q2, p2);
+  const Point3 r  = Sub(p1, p2);
+  const double a  = Dot(d1, d1);
+  const double e  = Dot(d2, d2);
+  const double f  = Dot(d2, r);
+  double s = 0.0;
+  double t = 0.0;
+  if (a > kEps && e <= kEps)
+    s = Clamp01(-Dot(d1, r) / a);
+  else if (a <= kEps && e > kEps)
+    t = Clamp01(f / e);
+  else if (a > kEps && e > kEps)
+  {
+    const double b     = Dot(d1, d2);
+    const double c     = Dot(d1, r);
+    const double denom = a * e - b * b;
+    // Closest points of the two lines, clamped onto the segments
+    s = denom > kEps ? Clamp01((b * f - c * e) / denom) : 0.0;
+    t = (b * s + f) / e;
+    if (t < 0.0)
+    {
+      t = 0.0;
+      s = Clamp01(-c / a);
+    }
+    else if (t > 1.0)
+    {
+      t = 1.0;
+      s = Clamp01((b - c) / a);
+    }
+  }
+  Point3 diff;
+  for (uint8_t i = 0; i < 3; i++)
+    diff[i] = (p1[i] + s * d1[i]) - (p2[i] + t * d2[i]);
+  return std::sqrt(Dot(diff, diff));
+}
+
+/**
+ * @brief Check if a segment crosses a triangle, with Moller-Trumbore algorithm.
+ * @param[in] p Start of the segment.
+ * @param[in] q End of the segment.
+ * @param[in] v0 First vertex of the triangle.
+ * @param[in] v1 Second vertex of the triangle.
+ * @param[in] v2 Third vertex of the triangle.
+ * @return _True_ if segment crosses the triangle, _false_ otherwise or if they are
+ * parallel.
+ */
+bool SegmentCrossesTriangle(const Point3& p, const Point3& q, const Point3& v0,
+                            const Point3& v1, const Point3& v2)
+{
+  static constexpr double kEps = 1e-12;
+
+  const Point3 dir = Sub(q, p);
+  const Point3 e1  = Sub(v1, v0);
+  const Point3 e2  = Sub(v2, v0);
+  const Point3 h   = Cross(dir, e2);
+  const double det = Dot(e1, h);
+  if (std::abs(det) < kEps)
+    return false;
+  const Point3 s = Sub(p, v0);
+  const double u = Dot(s, h) / det;
+  if (u < 0.0 || u > 1.0)
+    return false;
+  const Point3 k = Cross(s, e1);
+  const double v = Dot(dir, k) / det;
+  if (v < 0.0 || u + v > 1.0)
+    return false;
+  const double t = Dot(e2, k) / det;
+  return t >= 0.0 && t <= 1.0;
+}
+
+void AtomicMin(std::atomic<size_t>& value, const size_t candidate)
+{
+  size_t current = value.load();
+  while (candidate < current && !value.compare_exchange_weak(current, candidate)) {}
+}
+
+void HashVector(const vectD& values, QCryptographicHash& hash)
+{
+  const quint64 size = values.size();
+  hash.addData(reinterpret_cast<const char*>(&size), sizeof(size));
+  hash.addData(reinterpret_cast<const char*>(values.data()),
+               static_cast<int>(values.size() * sizeof(double)));
+}
+
+} // end namespace
+
+//------------------------------------------------------------------------------------//
+//--------- TrajectoryCheckReport struct ---------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+bool TrajectoryCheckReport::IsSafe() const
+{
+  for (uint8_t i = 0; i < CHECKS_NUM; i++)
+    if (violations[i].found)
+      return false;
+  return true;
+}
+
+QString TrajectoryCheckReport::Summary() const
+{
+  QStringList lines;
+  for (uint8_t i = 0; i < CHECKS_NUM; i++)
+  {
+    const CheckViolation& violation = violations[i];
+    if (!violation.found)
+      continue;
+    const QString at = QString("at sample %1 (t = %2 s)")
+                         .arg(violation.sample)
+                         .arg(violation.time);
+    switch (i)
+    {
+      case TENSION_CHECK:
+        lines.append("cable tensions out of bounds " + at);
+        break;
+      case CABLE_CABLE_CHECK:
+        lines.append(QString("cables %1 and %2 interfere ")
+                       .arg(violation.cable_a)
+                       .arg(violation.cable_b) +
+                     at);
+        break;
+      case CABLE_PLATFORM_CHECK:
+        lines.append(QString("cable %1 interferes with platform next to cable %2 ")
+                       .arg(violation.cable_a)
+                       .arg(violation.cable_b) +
+                     at);
+        break;
+      case KINEMATICS_CHECK:
+        lines.append("platform pose not found from cable lengths " + at);
+        break;
+    }
+  }
+  return lines.join("\n");
+}
+
+//------------------------------------------------------------------------------------//
+//--------- TrajectoryChecker class --------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+constexpr int TrajectoryChecker::kMaxCachedReports_;
+constexpr size_t TrajectoryChecker::kChunkSize_;
+
+TrajectoryChecker::TrajectoryChecker(const grabcdpr::RobotParams& robot_params,
+                                     const TrajectoryCheckParams& params
+                                     /*= TrajectoryCheckParams()*/)
+  : robot_params_(robot_params), params_(params),
+    active_ids_(robot_params.activeActuatorsId()),
+    fingerprint_(WorkspaceGrid::Fingerprint(robot_params, params.wrench))
+{}
+
+//--------- Public functions ---------------------------------------------------------//
+
+bool TrajectoryChecker::CheckPlatform(const vect<TrajectoryD>& traj_platform,
+                                      TrajectoryCheckReport& report,
+                                      const uint threads_num /*= 0*/,
+                                      const std::atomic<bool>* abort_flag /*= nullptr*/)
+{
+  report = TrajectoryCheckReport();
+  if (traj_platform.size() != 3 && traj_platform.size() != 6)
+    return false;
+  vect<const TrajectoryD*> trajectories;
+  for (const TrajectoryD& traj : traj_platform)
+    trajectories.push_back(&traj);
+  return Check(PLATFORM_POSE, trajectories, report, threads_num, abort_flag);
+}
+
+bool TrajectoryChecker::CheckCablesLength(
+  const vect<TrajectoryD>& traj_cables_len, TrajectoryCheckReport& report,
+  const uint threads_num /*= 0*/, const std::atomic<bool>* abort_flag /*= nullptr*/)
+{
+  report = TrajectoryCheckReport();
+  if (active_ids_.size() < 3)
+    return false;
+  // Match robot model cables order
+  vect<const TrajectoryD*> trajectories;
+  for (const id_t id : active_ids_)
+  {
+    const TrajectoryD* match = nullptr;
+    for (const TrajectoryD& traj : traj_cables_len)
+      if (traj.id == id)
+        match = &traj;
+    if (match == nullptr)
+      return false;
+    trajectories.push_back(match);
+  }
+  return Check(CABLES_LENGTH, trajectories, report, threads_num, abort_flag);
+}
+
+void TrajectoryChecker::ClearCache()
+{
+  cache_mutex_.lock();
+  cache_.clear();
+  cache_mutex_.unlock();
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+bool TrajectoryChecker::Check(const InputType input_type,
+                              const vect<const TrajectoryD*>& trajectories,
+                              TrajectoryCheckReport& report, const uint threads_num,
+                              const std::atomic<bool>* abort_flag)
+{
+  for (const TrajectoryD* traj : trajectories)
+    if (traj->timestamps.empty() || traj->timestamps.size() != traj->values.size() ||
+        traj->timestamps.front() < 0.0)
+      return false;
+
+  const QByteArray key = CacheKey(input_type, trajectories);
+  cache_mutex_.lock();
+  const bool cached = cache_.contains(key);
+  if (cached)
+    report = cache_.value(key);
+  cache_mutex_.unlock();
+  if (cached)
+  {
+    report.from_cache = true;
+    return true;
+  }
+
+  // Samples are trajectory ones, unless these are Hermite knots, which are too sparse
+  vectD times;
+  const TrajectoryD& reference = *trajectories.front();
+  bool hermite                 = false;
+  for (const TrajectoryD* traj : trajectories)
+    hermite = hermite || traj->hasVelocities();
+  if (hermite)
+  {
+    const double duration = reference.timestamps.back() - reference.timestamps.front();
+    const size_t steps =
+      std::max(static_cast<size_t>(std::ceil(duration / params_.sample_period)), 1UL);
+    for (size_t i = 0; i <= steps; i++)
+      times.push_back(reference.timestamps.front() + duration * i / steps);
+  }
+  else
+    times = reference.timestamps;
+  const size_t samples_num = times.size();
+  const size_t chunks_num  = (samples_num + kChunkSize_ - 1) / kChunkSize_;
+  const size_t cables_num  = active_ids_.size();
+
+  auto sample_values = [&](const size_t sample, vectD& values) {
+    for (size_t j = 0; j < trajectories.size(); j++)
+      values[j] = trajectories[j]->waypointFromAbsTime(times[sample]).value;
+  };
+  auto init_vars = [&](grabcdpr::RobotVars& vars) {
+    vars.platform = grabcdpr::PlatformVars(grabcdpr::TILT_TORSION);
+    vars.cables.resize(robot_params_.actuators.size());
+  };
+
+  // Initial guesses of forward kinematics at the first sample of each chunk, found in
+  // sequence starting from the center of the workspace box, so that each one is close to
+  // the next one. Then each worker goes on from there within its chunk.
+  vect<grabnum::Vector6d> seeds(chunks_num);
+  const WorkspaceGridParams box = WorkspaceGridParams::FromRobotParams(robot_params_);
+  grabnum::Vector6d seed;
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    seed(i)     = 0.5 * (box.min_pos(i) + box.max_pos(i));
+    seed(i + 3) = params_.wrench.orientation(i);
+  }
+  grabcdpr::RobotVars seed_vars;
+  init_vars(seed_vars);
+  vectD lengths(cables_num);
+  for (size_t chunk = 0; chunk < chunks_num; chunk++)
+  {
+    if (input_type == CABLES_LENGTH)
+    {
+      grabnum::Vector6d pose = seed;
+      sample_values(chunk * kChunkSize_, lengths);
+      if (SolveForwardKinematics(lengths, pose, seed_vars))
+        seed = pose;
+    }
+    seeds[chunk] = seed;
+  }
+
+  // Each worker sweeps whole chunks at a time, skipping checks which already failed on
+  // an earlier sample. Failures are stored per chunk and merged afterwards in order.
+  vect<CheckViolation> chunk_violations(chunks_num * CHECKS_NUM);
+  std::atomic<size_t> first_failure[CHECKS_NUM];
+  for (uint8_t c = 0; c < CHECKS_NUM; c++)
+    first_failure[c] = samples_num;
+  std::atomic<size_t> next_chunk(0);
+  auto worker = [&]() {
+    grabcdpr::RobotVars vars;
+    init_vars(vars);
+    vectD values(trajectories.size());
+    grabnum::Vector6d pose;
+    size_t chunk;
+    while ((chunk = next_chunk++) < chunks_num)
+    {
+      if (abort_flag != nullptr && *abort_flag)
+        return;
+      CheckViolation* violations = &chunk_violations[chunk * CHECKS_NUM];
+      const size_t begin         = chunk * kChunkSize_;
+      const size_t end           = std::min(begin + kChunkSize_, samples_num);
+      pose                       = seeds[chunk];
+      for (size_t i = begin; i < end; i++)
+      {
+        bool pending[CHECKS_NUM];
+        bool any_pending = false;
+        for (uint8_t c = 0; c < CHECKS_NUM; c++)
+        {
+          pending[c]  = !violations[c].found && i < first_failure[c];
+          any_pending = any_pending || pending[c];
+        }
+        if (!any_pending)
+          break;
+
+        CheckViolation failures[CHECKS_NUM];
+        sample_values(i, values);
+        if (input_type == PLATFORM_POSE)
+          for (uint8_t j = 1; j <= 6; j++)
+            pose(j) =
+              j <= values.size() ? values[j - 1] : params_.wrench.orientation(j - 3);
+        else if (!SolveForwardKinematics(values, pose, vars))
+        {
+          failures[KINEMATICS_CHECK].found = true;
+          pose                             = seeds[chunk];
+        }
+        if (!failures[KINEMATICS_CHECK].found)
+        {
+          if (pending[TENSION_CHECK])
+            failures[TENSION_CHECK].found =
+              !WorkspaceGrid::IsPoseFeasible(pose, robot_params_, params_.wrench, vars);
+          else
+            grabcdpr::updateIK0(pose, robot_params_, vars);
+          if (pending[CABLE_CABLE_CHECK] || pending[CABLE_PLATFORM_CHECK])
+            CheckInterference(pose, vars, failures[CABLE_CABLE_CHECK],
+                              failures[CABLE_PLATFORM_CHECK]);
+        }
+        for (uint8_t c = 0; c < CHECKS_NUM; c++)
+        {
+          if (!pending[c] || !failures[c].found)
+            continue;
+          violations[c]        = failures[c];
+          violations[c].sample = i;
+          violations[c].time   = times[i];
+          AtomicMin(first_failure[c], i);
+        }
+      }
+    }
+  };
+
+  RunBackgroundWorkers(BackgroundWorkersNum(threads_num, chunks_num), worker);
+  if (abort_flag != nullptr && *abort_flag)
+    return false;
+
+  report.samples_num = samples_num;
+  for (uint8_t c = 0; c < CHECKS_NUM; c++)
+    for (size_t chunk = 0; chunk < chunks_num; chunk++)
+      if (chunk_violations[chunk * CHECKS_NUM + c].found)
+      {
+        report.violations[c] = chunk_violations[chunk * CHECKS_NUM + c];
+        break;
+      }
+
+  cache_mutex_.lock();
+  if (cache_.size() >= kMaxCachedReports_)
+    cache_.clear();
+  cache_.insert(key, report);
+  cache_mutex_.unlock();
+  return true;
+}
+
+QByteArray TrajectoryChecker::CacheKey(const InputType input_type,
+                                       const vect<const TrajectoryD*>& trajectories) const
+{
+  // Everything a report depends on: robot model, check parameters and trajectory
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  const double params[] = {params_.min_clearance, params_.sample_period,
+                           params_.fk_tolerance};
+  hash.addData(reinterpret_cast<const char*>(&fingerprint_), sizeof(fingerprint_));
+  hash.addData(reinterpret_cast<const char*>(params), sizeof(params));
+  hash.addData(reinterpret_cast<const char*>(&input_type), sizeof(input_type));
+  for (const TrajectoryD* traj : trajectories)
+  {
+    const quint64 id = traj->id;
+    hash.addData(reinterpret_cast<const char*>(&id), sizeof(id));
+    HashVector(traj->timestamps, hash);
+    HashVector(traj->values, hash);
+    HashVector(traj->velocities, hash);
+  }
+  return hash.result();
+}
+
+bool TrajectoryChecker::SolveForwardKinematics(const vectD& lengths,
+                                               grabnum::Vector6d& pose,
+                                               grabcdpr::RobotVars& vars) const
+{
+  static constexpr size_t kMaxIterations = 50;
+  static constexpr double kStep          = 1e-7;
+  static constexpr double kMaxDamping    = 1e10;
+
+  // Underactuated robots are solved for position only, at fixed orientation
+  const size_t n    = lengths.size();
+  const size_t dofs = n < 6 ? 3 : 6;
+  auto residuals    = [&](const grabnum::Vector6d& p, vectD& r) {
+    grabcdpr::updateIK0(p, robot_params_, vars);
+    double cost = 0.0;
+    for (size_t k = 0; k < n; k++)
+    {
+      r[k] = vars.cables[k].length - lengths[k];
+      cost += r[k] * r[k];
+    }
+    return cost;
+  };
+  auto converged = [&](const vectD& r) {
+    for (const double& value : r)
+      if (std::abs(value) > params_.fk_tolerance)
+        return false;
+    return true;
+  };
+
+  // Damped Gauss-Newton (Levenberg-Marquardt) with finite-differences Jacobian
+  vectD r(n), trial_r(n), J(dofs * n), M(dofs * dofs), v(dofs);
+  double cost    = residuals(pose, r);
+  double damping = 1e-3;
+  for (size_t iter = 0; iter < kMaxIterations && !converged(r); iter++)
+  {
+    for (size_t j = 0; j < dofs; j++)
+    {
+      grabnum::Vector6d probe = pose;
+      probe(j + 1) += kStep;
+      grabcdpr::updateIK0(probe, robot_params_, vars);
+      for (size_t k = 0; k < n; k++)
+        J[j * n + k] = (vars.cables[k].length - lengths[k] - r[k]) / kStep;
+    }
+    while (true)
+    {
+      for (size_t a = 0; a < dofs; a++)
+      {
+        v[a] = 0.0;
+        for (size_t k = 0; k < n; k++)
+          v[a] -= J[a * n + k] * r[k];
+        for (size_t b = 0; b < dofs; b++)
+        {
+          M[a * dofs + b] = 0.0;
+          for (size_t k = 0; k < n; k++)
+            M[a * dofs + b] += J[a * n + k] * J[b * n + k];
+        }
+        M[a * dofs + a] *= 1.0 + damping;
+      }
+      grabnum::Vector6d trial = pose;
+      if (SolveLinearSystem(M, v, dofs))
+      {
+        for (size_t j = 0; j < dofs; j++)
+          trial(j + 1) += v[j];
+        const double trial_cost = residuals(trial, trial_r);
+        if (trial_cost < cost)
+        {
+          pose = trial;
+          cost = trial_cost;
+          r.swap(trial_r);
+          damping = std::max(0.1 * damping, 1e-12);
+          break;
+        }
+      }
+      damping *= 10.0;
+      if (damping > kMaxDamping)
+        return converged(r);
+    }
+  }
+  return converged(r);
+}
+
+void TrajectoryChecker::CheckInterference(const grabnum::Vector6d& pose,
+                                          const grabcdpr::RobotVars& vars,
+                                          CheckViolation& cable_cable,
+                                          CheckViolation& cable_platform) const
+{
+  const double clearance = params_.min_clearance;
+  const size_t n         = active_ids_.size();
+  // Each cable is a segment from platform attachment point A to pulley exit point B
+  vect<Point3> A(n), B(n), U(n);
+  for (size_t k = 0; k < n; k++)
+  {
+    const grabnum::Vector3d& pa = vars.cables[k].pos_PA_glob;
+    const grabnum::Vector3d& ba = vars.cables[k].pos_BA_glob;
+    const double len = std::sqrt(ba(1) * ba(1) + ba(2) * ba(2) + ba(3) * ba(3));
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      A[k][i] = pose(i + 1) + pa(i + 1);
+      B[k][i] = A[k][i] - ba(i + 1);
+      U[k][i] = len > 0.0 ? -ba(i + 1) / len : 0.0;
+    }
+  }
+  auto coincident = [&](const Point3& a, const Point3& b) {
+    const Point3 diff = Sub(a, b);
+    return Dot(diff, diff) < clearance * clearance;
+  };
+
+  // Cables sharing an attachment point or a pulley only meet there
+  for (size_t i = 0; i < n && !cable_cable.found; i++)
+    for (size_t j = i + 1; j < n && !cable_cable.found; j++)
+      if (!coincident(A[i], A[j]) && !coincident(B[i], B[j]) &&
+          SegmentsDistance(A[i], B[i], A[j], B[j]) < clearance)
+      {
+        cable_cable.found   = true;
+        cable_cable.cable_a = active_ids_[i];
+        cable_cable.cable_b = active_ids_[j];
+      }
+
+  // Platform is the convex hull of the attachment points: a cable interferes if it comes
+  // too close to one of its edges, or crosses any triangle spanned by them. Each cable
+  // is trimmed at its own attachment point, which is a vertex of the hull.
+  for (size_t k = 0; k < n && !cable_platform.found; k++)
+  {
+    Point3 start;
+    for (uint8_t i = 0; i < 3; i++)
+      start[i] = A[k][i] + clearance * U[k][i];
+    vect<size_t> others;
+    for (size_t i = 0; i < n; i++)
+      if (!coincident(A[i], A[k]))
+        others.push_back(i);
+    const size_t m = others.size();
+    for (size_t a = 0; a < m && !cable_platform.found; a++)
+      for (size_t b = a + 1; b < m && !cable_platform.found; b++)
+      {
+        bool interferes =
+          SegmentsDistance(start, B[k], A[others[a]], A[others[b]]) < clearance;
+        for (size_t c = b + 1; c < m && !interferes; c++)
+          interferes = SegmentCrossesTriangle(start, B[k], A[others[a]], A[others[b]],
+                                              A[others[c]]);
+        if (interferes)
+        {
+          cable_platform.found   = true;
+          cable_platform.cable_a = active_ids_[k];
+          cable_platform.cable_b = active_ids_[others[a]];
+        }
+      }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+//--------- TrajectoryCheckAnalyzer class --------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+TrajectoryCheckAnalyzer::TrajectoryCheckAnalyzer(QObject* parent,
+                                                 TrajectoryChecker* checker,
+                                                 const vect<TrajectoryCheckJob>& jobs)
+  : QThread(parent), checker_(checker), jobs_(jobs), abort_(false)
+{}
+
+TrajectoryCheckAnalyzer::~TrajectoryCheckAnalyzer()
+{
+  Abort();
+  wait();
+}
+
+void TrajectoryCheckAnalyzer::run()
+{
+  grabrt::Clock clock;
+  reports_.assign(jobs_.size(), TrajectoryCheckReport());
+  for (size_t i = 0; i < jobs_.size(); i++)
+  {
+    const bool completed =
+      jobs_[i].traj_platform.empty()
+        ? checker_->CheckCablesLength(jobs_[i].traj_cables_len, reports_[i], 0, &abort_)
+        : checker_->CheckPlatform(jobs_[i].traj_platform, reports_[i], 0, &abort_);
+    if (abort_)
+    {
+      CLOG(INFO, "event") << "Trajectory check aborted";
+      return;
+    }
+    if (!completed)
+      CLOG(WARNING, "event") << "Trajectory #" << i << " cannot be checked";
+  }
+  CLOG(INFO, "event") << "Trajectory check completed in " << clock.Elapsed() << " sec";
+  emit resultsReady();
+}
@@ -0,0 +1,578 @@
+/**
+ * @file workspace_grid.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief File containing definitions of functions and class declared in workspace_grid.h.
+ */
+
+#include "robot/workspace_grid.h"
+
+#include <cmath>
+
+#include "utils/linear_system.h"
+
+namespace {
+
+/**
+ * @brief Solve a least-squares problem restricted to a subset of columns.
+ * @param[in] A Column-major matrix of size _m_ x _n_.
+ * @param[in] b Right-hand side of size _m_.
+ * @param[in] m Number of rows.
+ * @param[in] n Number of columns.
+ * @param[in] passive Flags of the columns to be used.
+ * @param[out] z Solution of size _n_, null on unused columns.
+ * @return _True_ if problem is well-posed, _false_ otherwise.
+ */
+bool SolvePassiveLeastSquares(const vectD& A, const vectD& b, const size_t m,
+                              const size_t n, const vect<bool>& passive, vectD& z)
+{
+  vect<size_t> cols;
+  for (size_t j = 0; j < n; j++)
+    if (passive[j])
+      cols.push_back(j);
+  const size_t k = cols.size();
+  // Normal equations
+  vectD M(k * k, 0.0);
+  vectD v(k, 0.0);
+  for (size_t r = 0; r < k; r++)
+  {
+    for (size_t c = 0; c < k; c++)
+      for (size_t i = 0; i < m; i++)
+        M[r * k + c] += A[cols[r] * m + i] * A[cols[c] * m + i];
+    for (size_t i = 0; i < m; i++)
+      v[r] += A[cols[r] * m + i] * b[i];
+  }
+  if (!SolveLinearSystem(M, v, k))
+    return false;
+  std::fill(z.begin(), z.end(), 0.0);
+  for (size_t r = 0; r < k; r++)
+    z[cols[r]] = v[r];
+  return true;
+}
+
+/**
+ * @brief Solve a non-negative least-squares problem with Lawson-Hanson active set method.
+ *
+ * Finds _x_ minimizing ||A x - b|| subject to _x_ >= 0.
+ * @param[in] A Column-major matrix of size _m_ x _n_.
+ * @param[in] b Right-hand side of size _m_.
+ * @param[in] m Number of rows.
+ * @param[in] n Number of columns.
+ * @param[out] x Solution of size _n_.
+ * @return The residual norm at the solution.
+ */
+double SolveNNLS(const vectD& A, const vectD& b, const size_t m, const size_t n, vectD& x)
+{
+  static constexpr double kTol = 1e-10;
+
+  x.assign(n, 0.0);
+  vect<bool> passive(n, false);
+  vectD residual(b);
+  vectD w(n);
+  vectD z(n);
+  for (size_t iter = 0; iter < 3 * n; iter++)
+  {
+    // Gradient of the objective on current solution
+    for (size_t j = 0; j < n; j++)
+    {
+      w[j] = 0.0;
+      for (size_t i = 0; i < m; i++)
+        w[j] += A[j * m + i] * residual[i];
+    }
+    size_t best = n;
+    for (size_t j = 0; j < n; j++)
+      if (!passive[j] && w[j] > kTol && (best == n || w[j] > w[best]))
+        best = j;
+    if (best == n)
+      break; // KKT conditions satisfied
+    passive[best] = true;
+
+    while (true)
+    {
+      if (!SolvePassiveLeastSquares(A, b, m, n, passive, z))
+      {
+        passive[best] = false;
+        break;
+      }
+      bool all_positive = true;
+      for (size_t j = 0; j < n; j++)
+        if (passive[j] && z[j] <= kTol)
+          all_positive = false;
+      if (all_positive)
+      {
+        x = z;
+        break;
+      }
+      // Step back inside feasible region and drop vanishing variables
+      double alpha = 1.0;
+      for (size_t j = 0; j < n; j++)
+        if (passive[j] && z[j] <= kTol)
+          alpha = std::min(alpha, x[j] / (x[j] - z[j]));
+      for (size_t j = 0; j < n; j++)
+      {
+        x[j] += alpha * (z[j] - x[j]);
+        if (passive[j] && x[j] <= kTol)
+        {
+          passive[j] = false;
+          x[j]       = 0.0;
+        }
+      }
+    }
+    for (size_t i = 0; i < m; i++)
+    {
+      residual[i] = b[i];
+      for (size_t j = 0; j < n; j++)
+        residual[i] -= A[j * m + i] * x[j];
+    }
+  }
+
+  double norm = 0.0;
+  for (size_t i = 0; i < m; i++)
+    norm += residual[i] * residual[i];
+  return std::sqrt(norm);
+}
+
+/**
+ * @brief Accumulate raw bytes into a FNV-1a hash.
+ * @param[in] data Pointer to raw bytes.
+ * @param[in] size Number of bytes.
+ * @param[in,out] hash Running hash value.
+ */
+void HashBytes(const void* data, const size_t size, quint64& hash)
+{
+  static constexpr quint64 kFnvPrime = 1099511628211ULL;
+
+  const uchar* bytes = static_cast<const uchar*>(data);
+  for (size_t i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+}
+
+void HashDouble(const double value, quint64& hash)
+{
+  HashBytes(&value, sizeof(value), hash);
+}
+
+/**
+ * @brief Compute the number of grid nodes along an axis.
+ * @param[in] min_pos [m] Lower bound of the axis.
+ * @param[in] max_pos [m] Upper bound of the axis.
+ * @param[in] resolution [m] Grid spacing.
+ * @return The number of nodes, or 0 if bounds or resolution are not valid.
+ */
+size_t AxisNodesNum(const double min_pos, const double max_pos, const double resolution)
+{
+  static constexpr double kMaxAxisNodes = 1e5;
+
+  if (!std::isfinite(min_pos) || !std::isfinite(max_pos) || max_pos < min_pos ||
+      !(resolution > 0.0))
+    return 0;
+  const double intervals = std::floor((max_pos - min_pos) / resolution);
+  if (!(intervals < kMaxAxisNodes))
+    return 0;
+  return static_cast<size_t>(intervals) + 1;
+}
+
+} // end namespace
+
+//------------------------------------------------------------------------------------//
+//--------- WorkspaceGridParams struct -----------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+WorkspaceGridParams::WorkspaceGridParams()
+{
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    min_pos(i)     = 0.0;
+    max_pos(i)     = 0.0;
+    orientation(i) = 0.0;
+    gravity(i)     = 0.0;
+  }
+  gravity(3) = -9.81;
+}
+
+WorkspaceGridParams WorkspaceGridParams::FromRobotParams(
+  const grabcdpr::RobotParams& params, const double resolution /*= 0.05*/)
+{
+  WorkspaceGridParams grid_params;
+  grid_params.resolution = resolution;
+  bool first             = true;
+  for (const grabcdpr::ActuatorParams& actuator : params.actuators)
+  {
+    if (!actuator.active)
+      continue;
+    for (uint8_t i = 1; i <= 3; i++)
+    {
+      const double coord = actuator.pulley.pos_OD_glob(i);
+      grid_params.min_pos(i) = first ? coord : std::min(grid_params.min_pos(i), coord);
+      grid_params.max_pos(i) = first ? coord : std::max(grid_params.max_pos(i), coord);
+    }
+    first = false;
+  }
+  // Platform hangs below pulleys: extend box downwards by its largest horizontal extent.
+  const double extent = std::max(grid_params.max_pos(1) - grid_params.min_pos(1),
+                                 grid_params.max_pos(2) - grid_params.min_pos(2));
+  grid_params.min_pos(3) -= extent;
+  return grid_params;
+}
+
+//------------------------------------------------------------------------------------//
+//--------- WorkspaceGrid class ------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+constexpr quint32 WorkspaceGrid::kMagicNumber_;
+constexpr quint32 WorkspaceGrid::kVersion_;
+
+//--------- Public functions ---------------------------------------------------------//
+
+size_t WorkspaceGrid::FeasibleNodesNum() const
+{
+  size_t count = 0;
+  for (const quint64& word : bits_)
+    count += static_cast<size_t>(__builtin_popcountll(word));
+  return count;
+}
+
+bool WorkspaceGrid::IsFeasible(const grabnum::Vector3d& pos) const
+{
+  size_t index;
+  if (!NodeIndex(pos, index))
+    return false;
+  return (bits_[index >> 6] >> (index & 63)) & 1ULL;
+}
+
+grabnum::Vector3d WorkspaceGrid::Clamp(const grabnum::Vector3d& from,
+                                       const grabnum::Vector3d& to) const
+{
+  double dist = 0.0;
+  for (uint8_t i = 1; i <= 3; i++)
+    dist += (to(i) - from(i)) * (to(i) - from(i));
+  dist = std::sqrt(dist);
+  // Sample the segment at half grid resolution so that no node is skipped.
+  const size_t steps =
+    std::max(static_cast<size_t>(std::ceil(2.0 * dist / params_.resolution)), 1UL);
+  grabnum::Vector3d last_feasible = from;
+  grabnum::Vector3d sample;
+  for (size_t k = 1; k <= steps; k++)
+  {
+    const double t = static_cast<double>(k) / steps;
+    for (uint8_t i = 1; i <= 3; i++)
+      sample(i) = from(i) + t * (to(i) - from(i));
+    if (!IsFeasible(sample))
+      break;
+    last_feasible = sample;
+  }
+  return last_feasible;
+}
+
+bool WorkspaceGrid::Compute(const grabcdpr::RobotParams& robot_params,
+                            const WorkspaceGridParams& grid_params,
+                            const uint threads_num /*= 0*/,
+                            const std::atomic<bool>* abort_flag /*= nullptr*/)
+{
+  params_      = grid_params;
+  fingerprint_ = Fingerprint(robot_params, grid_params);
+
+  const double resolution = grid_params.resolution;
+  nx_ = AxisNodesNum(grid_params.min_pos(1), grid_params.max_pos(1), resolution);
+  ny_ = AxisNodesNum(grid_params.min_pos(2), grid_params.max_pos(2), resolution);
+  nz_ = AxisNodesNum(grid_params.min_pos(3), grid_params.max_pos(3), resolution);
+  if (NodesNum() == 0)
+  {
+    bits_.clear();
+    return false;
+  }
+
+  // Each worker evaluates whole Z-slices at a time, writing on separate bytes to avoid
+  // sharing bitmap words. Bits are packed afterwards.
+  vect<uint8_t> nodes(NodesNum(), 0);
+  std::atomic<size_t> next_slice(0);
+  auto worker = [&]() {
+    grabcdpr::RobotVars vars;
+    vars.platform = grabcdpr::PlatformVars(grabcdpr::TILT_TORSION);
+    vars.cables.resize(robot_params.actuators.size());
+    grabnum::Vector6d pose;
+    for (uint8_t i = 1; i <= 3; i++)
+      pose(i + 3) = grid_params.orientation(i);
+    size_t iz;
+    while ((iz = next_slice++) < nz_)
+    {
+      if (abort_flag != nullptr && *abort_flag)
+        return;
+      pose(3) = grid_params.min_pos(3) + iz * grid_params.resolution;
+      for (size_t iy = 0; iy < ny_; iy++)
+      {
+        pose(2) = grid_params.min_pos(2) + iy * grid_params.resolution;
+        for (size_t ix = 0; ix < nx_; ix++)
+        {
+          pose(1) = grid_params.min_pos(1) + ix * grid_params.resolution;
+          nodes[ix + nx_ * (iy + ny_ * iz)] =
+            IsPoseFeasible(pose, robot_params, grid_params, vars);
+        }
+      }
+    }
+  };
+
+  RunBackgroundWorkers(BackgroundWorkersNum(threads_num), worker);
+
+  if (abort_flag != nullptr && *abort_flag)
+  {
+    bits_.clear();
+    return false;
+  }
+  bits_.assign((nodes.size() + 63) / 64, 0ULL);
+  for (size_t i = 0; i < nodes.size(); i++)
+    if (nodes[i])
+      bits_[i >> 6] |= 1ULL << (i & 63);
+  return true;
+}
+
+bool WorkspaceGrid::Save(const QString& filepath) const
+{
+  if (!IsValid())
+    return false;
+  QDir().mkpath(QFileInfo(filepath).absolutePath());
+  QFile file(filepath);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_5);
+  stream << kMagicNumber_ << kVersion_ << fingerprint_;
+  for (uint8_t i = 1; i <= 3; i++)
+    stream << params_.min_pos(i) << params_.max_pos(i) << params_.orientation(i)
+           << params_.gravity(i);
+  stream << params_.resolution << params_.min_tension << params_.max_tension;
+  stream << static_cast<quint64>(nx_) << static_cast<quint64>(ny_)
+         << static_cast<quint64>(nz_);
+  for (const quint64& word : bits_)
+    stream << word;
+  return stream.status() == QDataStream::Ok;
+}
+
+bool WorkspaceGrid::Load(const QString& filepath, const quint64 fingerprint /*= 0*/)
+{
+  QFile file(filepath);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_5);
+  quint32 magic_number;
+  quint32 version;
+  quint64 file_fingerprint;
+  stream >> magic_number >> version >> file_fingerprint;
+  if (magic_number != kMagicNumber_ || version != kVersion_)
+    return false;
+  if (fingerprint != 0 && file_fingerprint != fingerprint)
+    return false;
+
+  WorkspaceGridParams params;
+  for (uint8_t i = 1; i <= 3; i++)
+    stream >> params.min_pos(i) >> params.max_pos(i) >> params.orientation(i) >>
+      params.gravity(i);
+  stream >> params.resolution >> params.min_tension >> params.max_tension;
+  quint64 nx, ny, nz;
+  stream >> nx >> ny >> nz;
+  if (stream.status() != QDataStream::Ok || nx == 0 || ny == 0 || nz == 0)
+    return false;
+  // Grid size must be consistent with its parameters and fit in the file
+  if (nx != AxisNodesNum(params.min_pos(1), params.max_pos(1), params.resolution) ||
+      ny != AxisNodesNum(params.min_pos(2), params.max_pos(2), params.resolution) ||
+      nz != AxisNodesNum(params.min_pos(3), params.max_pos(3), params.resolution))
+    return false;
+  const quint64 words_num = (nx * ny * nz + 63) / 64;
+  if (words_num * sizeof(quint64) > static_cast<quint64>(file.bytesAvailable()))
+    return false;
+  vect<quint64> bits(words_num);
+  for (quint64& word : bits)
+    stream >> word;
+  if (stream.status() != QDataStream::Ok)
+    return false;
+
+  params_      = params;
+  fingerprint_ = file_fingerprint;
+  nx_          = nx;
+  ny_          = ny;
+  nz_          = nz;
+  bits_        = std::move(bits);
+  return true;
+}
+
+quint64 WorkspaceGrid::Fingerprint(const grabcdpr::RobotParams& robot_params,
+                                   const WorkspaceGridParams& grid_params)
+{
+  static constexpr quint64 kFnvOffset = 14695981039346656037ULL;
+
+  quint64 hash = kFnvOffset;
+  // Robot topology and parameters which do not show up in cables lengths
+  for (const grabcdpr::ActuatorParams& actuator : robot_params.actuators)
+  {
+    const uint8_t active = actuator.active;
+    HashBytes(&active, sizeof(active), hash);
+    HashDouble(actuator.winch.transmission_ratio, hash);
+  }
+  HashDouble(robot_params.platform.mass, hash);
+  // Grid parameters
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    HashDouble(grid_params.min_pos(i), hash);
+    HashDouble(grid_params.max_pos(i), hash);
+    HashDouble(grid_params.orientation(i), hash);
+    HashDouble(grid_params.gravity(i), hash);
+  }
+  HashDouble(grid_params.resolution, hash);
+  HashDouble(grid_params.min_tension, hash);
+  HashDouble(grid_params.max_tension, hash);
+  // Robot geometry, probed through inverse kinematics at grid box corners
+  grabcdpr::RobotVars vars;
+  vars.platform = grabcdpr::PlatformVars(grabcdpr::TILT_TORSION);
+  vars.cables.resize(robot_params.actuators.size());
+  const size_t active_num = robot_params.activeActuatorsId().size();
+  grabnum::Vector6d pose;
+  for (uint8_t i = 1; i <= 3; i++)
+    pose(i + 3) = grid_params.orientation(i);
+  for (uint8_t corner = 0; corner < 8; corner++)
+  {
+    for (uint8_t i = 1; i <= 3; i++)
+      pose(i) = (corner >> (i - 1)) & 1 ? grid_params.max_pos(i) : grid_params.min_pos(i);
+    grabcdpr::updateIK0(pose, robot_params, vars);
+    for (size_t k = 0; k < active_num; k++)
+    {
+      HashDouble(vars.cables[k].length, hash);
+      HashDouble(vars.cables[k].swivel_ang, hash);
+    }
+  }
+  return hash;
+}
+
+QString WorkspaceGrid::DefaultCacheFilepath(const quint64 fingerprint)
+{
+  return QString("%1/.cache/cable_robot/workspace/%2.bin")
+    .arg(QDir::homePath())
+    .arg(fingerprint, 16, 16, QChar('0'));
+}
+
+bool WorkspaceGrid::IsPoseFeasible(const grabnum::Vector6d& pose,
+                                   const grabcdpr::RobotParams& robot_params,
+                                   const WorkspaceGridParams& grid_params,
+                                   grabcdpr::RobotVars& vars)
+{
+  grabcdpr::updateIK0(pose, robot_params, vars);
+
+  const size_t n = robot_params.activeActuatorsId().size();
+  const size_t m = n < 6 ? 3 : 6; // point-mass approximation for underactuated robots
+  const double mass = robot_params.platform.mass;
+
+  // Structure matrix: each column is the unit wrench applied by a cable on the platform.
+  vectD A(m * n);
+  for (size_t k = 0; k < n; k++)
+  {
+    const grabnum::Vector3d& ba = vars.cables[k].pos_BA_glob;
+    const double len = std::sqrt(ba(1) * ba(1) + ba(2) * ba(2) + ba(3) * ba(3));
+    if (len < 1e-9)
+      return false;
+    double u[3] = {-ba(1) / len, -ba(2) / len, -ba(3) / len}; // from A towards pulley
+    for (uint8_t i = 0; i < 3; i++)
+      A[k * m + i] = u[i];
+    if (m == 6)
+    {
+      const grabnum::Vector3d& pa = vars.cables[k].pos_PA_glob;
+      A[k * m + 3] = pa(2) * u[2] - pa(3) * u[1];
+      A[k * m + 4] = pa(3) * u[0] - pa(1) * u[2];
+      A[k * m + 5] = pa(1) * u[1] - pa(2) * u[0];
+    }
+  }
+  // External wrench to be balanced, i.e. platform weight.
+  vectD b(m);
+  for (uint8_t i = 0; i < 3; i++)
+    b[i] = -mass * grid_params.gravity(i + 1);
+  if (m == 6)
+  {
+    const grabnum::Vector3d& pg = vars.platform.pos_PG_glob;
+    const grabnum::Vector3d& g  = grid_params.gravity;
+    b[3] = -mass * (pg(2) * g(3) - pg(3) * g(2));
+    b[4] = -mass * (pg(3) * g(1) - pg(1) * g(3));
+    b[5] = -mass * (pg(1) * g(2) - pg(2) * g(1));
+  }
+  // Shift unknowns by minimum tension so that bounds become non-negativity constraints.
+  for (size_t i = 0; i < m; i++)
+    for (size_t k = 0; k < n; k++)
+      b[i] -= A[k * m + i] * grid_params.min_tension;
+
+  vectD x;
+  double b_norm = 0.0;
+  for (const double& value : b)
+    b_norm += value * value;
+  if (SolveNNLS(A, b, m, n, x) > 1e-6 * (1.0 + std::sqrt(b_norm)))
+    return false;
+  for (const double& value : x)
+    if (value + grid_params.min_tension > grid_params.max_tension)
+      return false;
+  return true;
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+bool WorkspaceGrid::NodeIndex(const grabnum::Vector3d& pos, size_t& index) const
+{
+  if (bits_.empty())
+    return false;
+  const size_t dims[3] = {nx_, ny_, nz_};
+  size_t idx[3];
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    const double rel = (pos(i + 1) - params_.min_pos(i + 1)) / params_.resolution;
+    if (rel < -0.5 || rel >= dims[i] - 0.5)
+      return false;
+    idx[i] = static_cast<size_t>(rel + 0.5);
+  }
+  index = idx[0] + nx_ * (idx[1] + ny_ * idx[2]);
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+//--------- WorkspaceAnalyzer class --------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+WorkspaceAnalyzer::WorkspaceAnalyzer(QObject* parent,
+                                     const grabcdpr::RobotParams& robot_params,
+                                     const WorkspaceGridParams& grid_params)
+  : QThread(parent), robot_params_(robot_params), grid_params_(grid_params),
+    abort_(false)
+{}
+
+WorkspaceAnalyzer::~WorkspaceAnalyzer()
+{
+  Abort();
+  wait();
+}
+
+void WorkspaceAnalyzer::run()
+{
+  const quint64 fingerprint = WorkspaceGrid::Fingerprint(robot_params_, grid_params_);
+  const QString cache_filepath = WorkspaceGrid::DefaultCacheFilepath(fingerprint);
+  if (grid_.Load(cache_filepath, fingerprint))
+  {
+    CLOG(INFO, "event") << "Workspace grid loaded from " << cache_filepath;
+    emit resultsReady();
+    return;
+  }
+
+  emit printToQConsole("Computing wrench-feasible workspace, this may take a while...");
+  grabrt::Clock clock;
+  if (!grid_.Compute(robot_params_, grid_params_, 0, &abort_))
+  {
+    CLOG(INFO, "event") << "Workspace analysis aborted";
+    return;
+  }
+  emit printToQConsole(QString("Workspace analysis completed in %1 sec: %2/%3 feasible "
+                               "nodes")
+                         .arg(clock.Elapsed())
+                         .arg(grid_.FeasibleNodesNum())
+                         .arg(grid_.NodesNum()));
+  if (!grid_.Save(cache_filepath))
+    emit printToQConsole(
+      QString("WARNING: Could not save workspace cache onto %1").arg(cache_filepath));
+  emit resultsReady();
+}
@@ -0,0 +1,43 @@
+/**
+ * @file background_workers.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of functions declared in background_workers.h.
+ */
+
+#include "utils/background_workers.h"
+
+#include <algorithm>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr unsigned int kCoresPerWorker = 4;
+constexpr int kWorkersNiceness         = 19; // highest niceness, i.e. lowest priority
+
+} // end namespace
+
+unsigned int BackgroundWorkersNum(const unsigned int threads_num,
+                                  const size_t max_useful /*= static_cast<size_t>(-1)*/)
+{
+  const unsigned int workers_num =
+    threads_num > 0 ? threads_num : std::thread::hardware_concurrency() / kCoresPerWorker;
+  return static_cast<unsigned int>(
+    std::max<size_t>(std::min<size_t>(workers_num, max_useful), 1));
+}
+
+void RunBackgroundWorkers(const unsigned int workers_num,
+                          const std::function<void()>& worker)
+{
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < workers_num; i++)
+    workers.push_back(std::thread([&worker]() {
+      // On Linux, niceness is a per-thread attribute and 0 stands for the calling one
+      setpriority(PRIO_PROCESS, 0, kWorkersNiceness);
+      worker();
+    }));
+  for (std::thread& t : workers)
+    t.join();
+}
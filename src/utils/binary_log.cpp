@@ -0,0 +1,541 @@
+/**
+ * @file binary_log.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of classes and functions declared in
+ * binary_log.h.
+ */
+
+#include "utils/binary_log.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+namespace {
+
+// Record header: message type (uint32) + timestamp (float64).
+constexpr size_t kRecordHeaderSize = sizeof(quint32) + sizeof(double);
+
+// Copy a scalar of given size from host to little-endian byte order.
+inline void EncodeScalar(const uchar* src, const size_t size, uchar* dst)
+{
+  switch (size)
+  {
+    case 1:
+      *dst = *src;
+      break;
+    case 2:
+    {
+      quint16 raw;
+      memcpy(&raw, src, size);
+      qToLittleEndian<quint16>(raw, dst);
+      break;
+    }
+    case 4:
+    {
+      quint32 raw;
+      memcpy(&raw, src, size);
+      qToLittleEndian<quint32>(raw, dst);
+      break;
+    }
+    case 8:
+    {
+      quint64 raw;
+      memcpy(&raw, src, size);
+      qToLittleEndian<quint64>(raw, dst);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+BinLogValue DecodeScalar(const uchar* src, const BinLogFieldType type)
+{
+  BinLogValue value;
+  value.type = type;
+  switch (type)
+  {
+    case FIELD_INT8:
+      value.i = static_cast<qint8>(*src);
+      break;
+    case FIELD_UINT8:
+      value.u = *src;
+      break;
+    case FIELD_INT16:
+      value.i = qFromLittleEndian<qint16>(src);
+      break;
+    case FIELD_UINT16:
+      value.u = qFromLittleEndian<quint16>(src);
+      break;
+    case FIELD_INT32:
+      value.i = qFromLittleEndian<qint32>(src);
+      break;
+    case FIELD_UINT32:
+      value.u = qFromLittleEndian<quint32>(src);
+      break;
+    case FIELD_INT64:
+      value.i = qFromLittleEndian<qint64>(src);
+      break;
+    case FIELD_UINT64:
+      value.u = qFromLittleEndian<quint64>(src);
+      break;
+    case FIELD_FLOAT32:
+    {
+      const quint32 raw = qFromLittleEndian<quint32>(src);
+      float f;
+      memcpy(&f, &raw, sizeof(f));
+      value.f = static_cast<double>(f);
+      break;
+    }
+    case FIELD_FLOAT64:
+    {
+      const quint64 raw = qFromLittleEndian<quint64>(src);
+      memcpy(&value.f, &raw, sizeof(value.f));
+      break;
+    }
+    default:
+      break;
+  }
+  return value;
+}
+
+void AppendString(QByteArray& buffer, const QString& str)
+{
+  const QByteArray utf8 = str.toUtf8();
+  uchar len[sizeof(quint16)];
+  qToLittleEndian<quint16>(static_cast<quint16>(utf8.size()), len);
+  buffer.append(reinterpret_cast<const char*>(len), sizeof(len));
+  buffer.append(utf8);
+}
+
+template <typename T> void AppendScalar(QByteArray& buffer, const T value)
+{
+  uchar bytes[sizeof(T)];
+  qToLittleEndian<T>(value, bytes);
+  buffer.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+template <typename T> bool ReadScalar(QFile& file, T& value)
+{
+  uchar bytes[sizeof(T)];
+  if (file.read(reinterpret_cast<char*>(bytes), sizeof(T)) != sizeof(T))
+    return false;
+  value = qFromLittleEndian<T>(bytes);
+  return true;
+}
+
+bool ReadString(QFile& file, QString& str)
+{
+  quint16 len;
+  if (!ReadScalar(file, len))
+    return false;
+  const QByteArray utf8 = file.read(len);
+  if (utf8.size() != len)
+    return false;
+  str = QString::fromUtf8(utf8);
+  return true;
+}
+
+void AppendFields(QByteArray& buffer, const std::vector<BinLogField>& fields)
+{
+  AppendScalar<quint16>(buffer, static_cast<quint16>(fields.size()));
+  for (const BinLogField& field : fields)
+  {
+    AppendScalar<quint8>(buffer, field.type);
+    AppendString(buffer, field.name);
+  }
+}
+
+// Encode packed fields in place, returning the position past the last one.
+inline uchar* EncodeFields(const uchar* src, const std::vector<BinLogField>& fields,
+                           uchar* dst)
+{
+  for (const BinLogField& field : fields)
+  {
+    const size_t size = BinLogFieldSize(field.type);
+    EncodeScalar(src + field.offset, size, dst);
+    dst += size;
+  }
+  return dst;
+}
+
+// Decode packed fields, returning the position past the last one.
+const uchar* DecodeFields(const uchar* src, const std::vector<BinLogField>& fields,
+                          BinLogValue* values)
+{
+  for (size_t i = 0; i < fields.size(); i++)
+  {
+    values[i] = DecodeScalar(src, fields[i].type);
+    src += BinLogFieldSize(fields[i].type);
+  }
+  return src;
+}
+
+} // end namespace
+
+size_t BinLogFieldSize(const BinLogFieldType type)
+{
+  switch (type)
+  {
+    case FIELD_INT8:
+    case FIELD_UINT8:
+      return 1;
+    case FIELD_INT16:
+    case FIELD_UINT16:
+      return 2;
+    case FIELD_INT32:
+    case FIELD_UINT32:
+    case FIELD_FLOAT32:
+      return 4;
+    case FIELD_INT64:
+    case FIELD_UINT64:
+    case FIELD_FLOAT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+//------------------------------------------------------------------------------------//
+//--------- BinLogGroup struct -------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+size_t BinLogGroup::itemSize() const
+{
+  size_t size = 0;
+  for (const BinLogField& field : fields)
+    size += BinLogFieldSize(field.type);
+  return size;
+}
+
+//------------------------------------------------------------------------------------//
+//--------- BinLogSchema struct ------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+size_t BinLogSchema::bodySize() const
+{
+  size_t size = 0;
+  for (const BinLogField& field : fields)
+    size += BinLogFieldSize(field.type);
+  return size;
+}
+
+size_t BinLogSchema::recordSize() const { return kRecordHeaderSize + bodySize(); }
+
+//------------------------------------------------------------------------------------//
+//--------- BinLogValue struct -------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+double BinLogValue::toDouble() const
+{
+  switch (type)
+  {
+    case FIELD_INT8:
+    case FIELD_INT16:
+    case FIELD_INT32:
+    case FIELD_INT64:
+      return static_cast<double>(i);
+    case FIELD_UINT8:
+    case FIELD_UINT16:
+    case FIELD_UINT32:
+    case FIELD_UINT64:
+      return static_cast<double>(u);
+    default:
+      return f;
+  }
+}
+
+QString BinLogValue::toString() const
+{
+  switch (type)
+  {
+    case FIELD_INT8:
+    case FIELD_INT16:
+    case FIELD_INT32:
+    case FIELD_INT64:
+      return QString::number(i);
+    case FIELD_UINT8:
+    case FIELD_UINT16:
+    case FIELD_UINT32:
+    case FIELD_UINT64:
+      return QString::number(u);
+    case FIELD_FLOAT32:
+      return QString::number(f, 'g', 9);
+    default:
+      return QString::number(f, 'g', 17);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+//--------- BinaryLogWriter class ----------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+constexpr int BinaryLogWriter::kFlushThresholdBytes_;
+
+BinaryLogWriter::BinaryLogWriter(const QString& filepath,
+                                 const std::vector<BinLogSchema>& schemas)
+  : file_(filepath), schemas_(schemas)
+{
+  for (size_t i = 0; i < schemas_.size(); i++)
+    schema_index_.insert(schemas_[i].msg_type, i);
+  buffer_.reserve(2 * kFlushThresholdBytes_);
+}
+
+BinaryLogWriter::~BinaryLogWriter() { close(); }
+
+//--------- Public functions ---------------------------------------------------------//
+
+bool BinaryLogWriter::open()
+{
+  close();
+  QFileInfo(file_).absoluteDir().mkpath(".");
+  if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  return writeHeader() && flush();
+}
+
+void BinaryLogWriter::close()
+{
+  if (!file_.isOpen())
+    return;
+  flush();
+  file_.close();
+}
+
+bool BinaryLogWriter::write(const quint32 msg_type, const double timestamp,
+                            const void* body)
+{
+  if (!file_.isOpen())
+    return false;
+  QHash<quint32, size_t>::const_iterator it = schema_index_.constFind(msg_type);
+  if (it == schema_index_.constEnd())
+    return false;
+  const BinLogSchema& schema = schemas_[it.value()];
+
+  const uchar* src  = static_cast<const uchar*>(body);
+  size_t record_size = schema.recordSize();
+  quint8 items_num   = 0;
+  if (!schema.group.isEmpty())
+  {
+    items_num = src[schema.group.count_offset];
+    record_size += sizeof(items_num) + items_num * schema.group.itemSize();
+  }
+
+  // Encode record in place at the end of the buffer
+  const int pos = buffer_.size();
+  buffer_.resize(pos + static_cast<int>(record_size));
+  uchar* dst = reinterpret_cast<uchar*>(buffer_.data()) + pos;
+  qToLittleEndian<quint32>(msg_type, dst);
+  dst += sizeof(quint32);
+  EncodeScalar(reinterpret_cast<const uchar*>(&timestamp), sizeof(timestamp), dst);
+  dst += sizeof(double);
+  dst = EncodeFields(src, schema.fields, dst);
+  if (!schema.group.isEmpty())
+  {
+    *dst++ = items_num;
+    for (quint8 i = 0; i < items_num; i++)
+      dst = EncodeFields(src + schema.group.items_offset + i * schema.group.item_stride,
+                         schema.group.fields, dst);
+  }
+
+  if (buffer_.size() >= kFlushThresholdBytes_)
+    return flush();
+  return true;
+}
+
+bool BinaryLogWriter::flush()
+{
+  if (!file_.isOpen())
+    return false;
+  bool ret = true;
+  if (!buffer_.isEmpty())
+  {
+    ret = file_.write(buffer_) == buffer_.size();
+    buffer_.resize(0); // keeps reserved capacity
+  }
+  return file_.flush() && ret;
+}
+
+bool BinaryLogWriter::reset()
+{
+  buffer_.resize(0);
+  if (!file_.isOpen())
+    return false;
+  return file_.resize(0) && file_.seek(0) && writeHeader() && flush();
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+bool BinaryLogWriter::writeHeader()
+{
+  QByteArray header(kBinLogMagic, kBinLogMagicSize);
+  AppendScalar<quint16>(header, kBinLogFormatVersion);
+  AppendScalar<quint16>(header, static_cast<quint16>(schemas_.size()));
+  for (const BinLogSchema& schema : schemas_)
+  {
+    AppendScalar<quint32>(header, schema.msg_type);
+    AppendString(header, schema.name);
+    AppendFields(header, schema.fields);
+    AppendString(header, schema.group.name);
+    AppendFields(header, schema.group.fields);
+  }
+  return file_.write(header) == header.size();
+}
+
+//------------------------------------------------------------------------------------//
+//--------- BinaryLogReader class ----------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+//--------- Public functions ---------------------------------------------------------//
+
+bool BinaryLogReader::open(const QString& filepath)
+{
+  close();
+  error_str_.clear();
+  schemas_.clear();
+  schema_index_.clear();
+  file_.setFileName(filepath);
+  if (!file_.open(QIODevice::ReadOnly))
+  {
+    error_str_ = file_.errorString();
+    return false;
+  }
+  if (readHeader())
+    return true;
+  close();
+  return false;
+}
+
+bool BinaryLogReader::readNext(BinLogRecord& record)
+{
+  quint32 msg_type;
+  if (!ReadScalar(file_, msg_type))
+    return false; // end of file
+  QHash<quint32, size_t>::const_iterator it = schema_index_.constFind(msg_type);
+  if (it == schema_index_.constEnd())
+  {
+    error_str_ = QString("Unknown message type %1 at offset %2")
+                   .arg(msg_type)
+                   .arg(file_.pos() - sizeof(msg_type));
+    return false;
+  }
+  record.schema_index        = it.value();
+  const BinLogSchema& schema = schemas_[record.schema_index];
+
+  // Fixed part, including items counter if any
+  const bool has_group = !schema.group.isEmpty();
+  qint64 size = static_cast<qint64>(schema.recordSize() - sizeof(msg_type));
+  if (has_group)
+    size += sizeof(quint8);
+  record_.resize(static_cast<int>(size));
+  if (file_.read(record_.data(), size) != size)
+  {
+    error_str_ = "Truncated record at end of file";
+    return false;
+  }
+  const uchar* src = reinterpret_cast<const uchar*>(record_.constData());
+  record.timestamp = DecodeScalar(src, FIELD_FLOAT64).f;
+  src += sizeof(double);
+  record.values.resize(schema.fields.size());
+  src              = DecodeFields(src, schema.fields, record.values.data());
+  record.items_num = has_group ? *src : 0;
+  if (record.items_num == 0)
+    return true;
+
+  // Group items
+  const size_t item_fields_num = schema.group.fields.size();
+  const qint64 items_size =
+    static_cast<qint64>(record.items_num * schema.group.itemSize());
+  record_.resize(static_cast<int>(items_size));
+  if (file_.read(record_.data(), items_size) != items_size)
+  {
+    error_str_ = "Truncated record at end of file";
+    return false;
+  }
+  src = reinterpret_cast<const uchar*>(record_.constData());
+  record.items_values.resize(record.items_num * item_fields_num);
+  for (size_t i = 0; i < record.items_num; i++)
+    src = DecodeFields(src, schema.group.fields,
+                       record.items_values.data() + i * item_fields_num);
+  return true;
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+bool BinaryLogReader::readHeader()
+{
+  if (file_.read(kBinLogMagicSize) != QByteArray(kBinLogMagic, kBinLogMagicSize))
+  {
+    error_str_ = "Not a binary log file";
+    return false;
+  }
+  quint16 schemas_num;
+  if (!ReadScalar(file_, file_version_) || !ReadScalar(file_, schemas_num))
+  {
+    error_str_ = "Truncated file header";
+    return false;
+  }
+  if (file_version_ > kBinLogFormatVersion)
+  {
+    error_str_ = QString("Unsupported format version %1 (latest supported is %2)")
+                   .arg(file_version_)
+                   .arg(kBinLogFormatVersion);
+    return false;
+  }
+
+  for (quint16 i = 0; i < schemas_num; i++)
+  {
+    BinLogSchema schema;
+    if (!ReadScalar(file_, schema.msg_type) || !ReadString(file_, schema.name))
+    {
+      error_str_ = "Truncated file header";
+      return false;
+    }
+    if (!readFields(schema.name, schema.fields))
+      return false;
+    // Groups were introduced with version 2
+    if (file_version_ >= 2)
+    {
+      if (!ReadString(file_, schema.group.name))
+      {
+        error_str_ = "Truncated file header";
+        return false;
+      }
+      if (!readFields(schema.name, schema.group.fields))
+        return false;
+    }
+    schema_index_.insert(schema.msg_type, schemas_.size());
+    schemas_.push_back(schema);
+  }
+  return true;
+}
+
+bool BinaryLogReader::readFields(const QString& schema_name,
+                                 std::vector<BinLogField>& fields)
+{
+  quint16 fields_num;
+  if (!ReadScalar(file_, fields_num))
+  {
+    error_str_ = "Truncated file header";
+    return false;
+  }
+  for (quint16 i = 0; i < fields_num; i++)
+  {
+    quint8 type;
+    BinLogField field;
+    if (!ReadScalar(file_, type) || !ReadString(file_, field.name))
+    {
+      error_str_ = "Truncated file header";
+      return false;
+    }
+    if (type >= FIELD_TYPES_NUM)
+    {
+      error_str_ = QString("Invalid type of field %1.%2").arg(schema_name, field.name);
+      return false;
+    }
+    field.type = static_cast<BinLogFieldType>(type);
+    fields.push_back(field);
+  }
+  return true;
+}
@@ -8,160 +8,70 @@
 
 #include "utils/easylog_wrapper.h"
 
-void LogMotorStatusMsg(el::Logger* data_logger, const MotorStatusMsg& msg)
-{
-  // clang-format off
-  data_logger->info("%v,%v,%v,%v,%v,%v,%v",
-                                                      msg.header.msg_type,
-                                                      msg.header.timestamp,
-                                     static_cast<int>(msg.body.id),
-                                     static_cast<int>(msg.body.op_mode),
-                                                      msg.body.motor_position,
-                                                      msg.body.motor_speed,
-                                                      msg.body.motor_torque);
-  // clang-format on
-}
-
-void LogWinchStatusMsg(el::Logger* data_logger, const WinchStatusMsg& msg)
-{
-  // clang-format off
-  data_logger->info("%v,%v,%v,%v,%v,%v,%v,%v,%v",
-                                                      msg.header.msg_type,
-                                                      msg.header.timestamp,
-                                     static_cast<int>(msg.body.id),
-                                     static_cast<int>(msg.body.op_mode),
-                                                      msg.body.motor_position,
-                                                      msg.body.motor_speed,
-                                                      msg.body.motor_torque,
-                                                      msg.body.cable_length,
-                                                      msg.body.aux_position);
-  // clang-format on
-}
-
-void LogActuatorStatusMsg(el::Logger* data_logger, const ActuatorStatusMsg& msg)
-{
-  // clang-format off
-  data_logger->info("%v,%v,%v,%v,%v,%v,%v,%v,%v,%v,%v",
-                                                      msg.header.msg_type,
-                                                      msg.header.timestamp,
-                                     static_cast<int>(msg.body.id),
-                                     static_cast<int>(msg.body.op_mode),
-                                                      msg.body.motor_position,
-                                                      msg.body.motor_speed,
-                                                      msg.body.motor_torque,
-                                                      msg.body.cable_length,
-                                                      msg.body.aux_position,
-                                     static_cast<int>(msg.body.state),
-                                                      msg.body.pulley_angle);
-  // clang-format on
-}
-
-// ... add new message log function definition here
-
 //------------------------------------------------------------------------------------//
 //--------- LogBuffer class ----------------------------------------------------------//
 //------------------------------------------------------------------------------------//
 
+constexpr size_t LogBuffer::kBatchSize_;
+constexpr unsigned long LogBuffer::kIdleSleepUsec_;
+
 //--------- Public functions ---------------------------------------------------------//
 
 void LogBuffer::flush()
 {
-  std::string path = "/tmp/cable-robot-logs/" + logger_->id() + ".log";
-  QFile::resize(path.c_str(), 0);
+  // Truncation is served by the logging thread, which is the only one owning the file.
+  flush_requested_ = true;
+  while (flush_requested_ && isRunning())
+    usleep(kIdleSleepUsec_);
 }
 
 void LogBuffer::stop()
 {
-  mutex_.lock();
   stop_requested_ = true;
-  buffer_not_empty.wakeAll();
-  mutex_.unlock();
   wait();
 }
 
-//--------- Public slot --------------------------------------------------------------//
-
-void LogBuffer::collectMsg(QByteArray msg)
-{
-  static quint64 linear_cnt = 0;
-
-  // Wait until buffer is no longer full
-  mutex_.lock();
-  if (circular_cnt_ == buffer_.size())
-    buffer_not_full.wait(&mutex_);
-  mutex_.unlock();
-
-  // Add cast data to buffer
-  quint16 index = static_cast<quint16>(linear_cnt % buffer_.size());
-  buffer_[index].replace(0, msg.size(), msg);
-  linear_cnt++;
-
-  // Update circular counter and notify buffer is no longer empty
-  mutex_.lock();
-  ++circular_cnt_;
-  buffer_not_empty.wakeAll();
-  mutex_.unlock();
-}
-
 //--------- Private functions --------------------------------------------------------//
 
 void LogBuffer::run()
 {
-  quint64 linear_cnt = 0;
+  TRACE_THREAD_NAME("log_buffer");
+  if (!writer_.open())
+    CLOG(ERROR, "event") << "Could not open data log file "
+                         << writer_.filepath().toStdString();
   while (1)
   {
-    // If buffer is empty, wait until new data is available or user stop request
-    mutex_.lock();
-    if (circular_cnt_ == 0)
+    // Check stop request before draining, so that nothing queued before it is lost
+    const bool stop_requested = stop_requested_;
+
+    if (flush_requested_)
     {
-      if (!stop_requested_) // need this is case buffer empties out after a stop request
-        buffer_not_empty.wait(&mutex_);
-      if (stop_requested_)
-      {
-        mutex_.unlock();
-        break;
-      }
+      ring_.Clear();
+      writer_.reset();
+      flush_requested_ = false;
     }
-    mutex_.unlock();
 
-    QCoreApplication::processEvents();
+    // Actual logging step, in batches
+    const size_t count = ring_.PopBatch(batch_.data(), batch_.size());
+    for (size_t i = 0; i < count; i++)
+      writer_.write(batch_[i].header.msg_type, batch_[i].header.timestamp,
+                    batch_[i].body);
 
-    // Actual logging step
-    quint16 index = static_cast<quint16>(linear_cnt % buffer_.size());
-    logData(index);
-    linear_cnt++;
-
-    // Update circular counter and notify buffer is no longer full
-    mutex_.lock();
-    --circular_cnt_;
-    buffer_not_full.wakeAll();
-    mutex_.unlock();
-
-    QCoreApplication::processEvents();
-  }
-}
+    const size_t drops_num = ring_.DroppedNum();
+    if (drops_num != reported_drops_num_)
+    {
+      CLOG(WARNING, "event") << "Data log buffer full: " << drops_num - reported_drops_num_
+                             << " messages dropped";
+      reported_drops_num_ = drops_num;
+    }
 
-void LogBuffer::logData(const quint16 index)
-{
-  QDataStream stream(buffer_[index]);
-  stream.setVersion(QDataStream::Qt_4_5);
-  stream >> header_;
-  switch (header_.msg_type)
-  {
-    case NULL_MSG:
-      break;
-    case MOTOR_STATUS:
-      motor_status_.deserialize(buffer_[index]);
-      LogMotorStatusMsg(logger_, motor_status_);
-      break;
-    case WINCH_STATUS:
-      winch_status_.deserialize(buffer_[index]);
-      LogWinchStatusMsg(logger_, winch_status_);
-      break;
-    case ACTUATOR_STATUS:
-      actuator_status_.deserialize(buffer_[index]);
-      LogActuatorStatusMsg(logger_, actuator_status_);
-      break;
-      // ... add new case here
+    if (count == 0)
+    {
+      writer_.flush(); // write buffered records onto file while idle
+      if (stop_requested)
+        break;
+      usleep(kIdleSleepUsec_); // nothing to log, poll again later
+    }
   }
+  writer_.close();
 }
@@ -0,0 +1,138 @@
+/**
+ * @file flight_recorder.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of class declared in flight_recorder.h.
+ */
+
+#include "utils/flight_recorder.h"
+
+#include <QDateTime>
+#include <QDir>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------------//
+//--------- FlightRecorder class -----------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+constexpr int FlightRecorder::kNoRequest_;
+constexpr unsigned long FlightRecorder::kIdleSleepUsec_;
+constexpr char* FlightRecorder::kReasonsStr_[];
+
+FlightRecorder::FlightRecorder(const QString& dir, const size_t pre_cycles,
+                               const size_t post_cycles)
+  : dir_(dir), post_cycles_(post_cycles),
+    entries_(std::max<size_t>(pre_cycles + post_cycles, 1)), state_(RECORDING),
+    requested_reason_(kNoRequest_), stop_requested_(false)
+{}
+
+//--------- Public functions ---------------------------------------------------------//
+
+void FlightRecorder::Record(const double timestamp, const ActuatorsFrame& actuators,
+                            const ControlActionsFrame& ctrl_actions)
+{
+  const int state = state_.load(std::memory_order_acquire);
+  if (state == FROZEN)
+    return; // window is being dumped
+
+  FlightRecorderEntry& entry = entries_[head_];
+  entry.timestamp            = timestamp;
+  MsgTraits<ActuatorsFrame>::Encode(actuators, entry.actuators);
+  MsgTraits<ControlActionsFrame>::Encode(ctrl_actions, entry.ctrl_actions);
+  if (++head_ == entries_.size())
+    head_ = 0;
+  if (recorded_num_ < entries_.size())
+    recorded_num_++;
+
+  if (state == RECORDING)
+  {
+    if (requested_reason_.load(std::memory_order_relaxed) == kNoRequest_)
+      return;
+    reason_         = static_cast<TriggerReason>(requested_reason_.exchange(kNoRequest_));
+    post_countdown_ = post_cycles_;
+  }
+  else
+  {
+    // Event already covered by the window being captured
+    requested_reason_.store(kNoRequest_, std::memory_order_relaxed);
+    post_countdown_--;
+  }
+  // Hand the buffer over to dumping thread once post-trigger cycles are recorded
+  if (post_countdown_ == 0)
+    state_.store(FROZEN, std::memory_order_release);
+  else
+    state_.store(TRIGGERED, std::memory_order_relaxed);
+}
+
+void FlightRecorder::Trigger(const TriggerReason reason)
+{
+  if (state_.load(std::memory_order_relaxed) != RECORDING)
+    return;
+  int expected = kNoRequest_;
+  requested_reason_.compare_exchange_strong(expected, reason);
+}
+
+void FlightRecorder::stop()
+{
+  stop_requested_ = true;
+  wait();
+}
+
+//--------- Private functions --------------------------------------------------------//
+
+void FlightRecorder::run()
+{
+  TRACE_THREAD_NAME("flight_recorder");
+  while (1)
+  {
+    // Check stop request before dumping, so that a frozen window is not lost
+    const bool stop_requested = stop_requested_;
+
+    if (state_.load(std::memory_order_acquire) == FROZEN)
+    {
+      Dump();
+      recorded_num_ = 0;
+      state_.store(RECORDING, std::memory_order_release);
+    }
+
+    if (stop_requested)
+      break;
+    usleep(kIdleSleepUsec_);
+  }
+}
+
+void FlightRecorder::Dump()
+{
+  TRACE_SCOPE("log", "FlightRecorder::Dump");
+  const QString datetime = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+  const QString filepath =
+    QDir(dir_).filePath(QString("flight_%1_%2.bin").arg(datetime, kReasonsStr_[reason_]));
+  BinaryLogWriter writer(filepath, MsgSchemas());
+  if (!writer.open())
+  {
+    CLOG(ERROR, "event") << "Could not open flight recorder dump file "
+                         << filepath.toStdString();
+    return;
+  }
+
+  // Write entries in chronological order, starting from the oldest one
+  const size_t size  = entries_.size();
+  const size_t first = (head_ + size - recorded_num_) % size;
+  for (size_t i = 0; i < recorded_num_; i++)
+  {
+    const FlightRecorderEntry& entry = entries_[(first + i) % size];
+    writer.write(MsgTraits<ActuatorsFrame>::Type(), entry.timestamp, &entry.actuators);
+    writer.write(MsgTraits<ControlActionsFrame>::Type(), entry.timestamp,
+                 &entry.ctrl_actions);
+  }
+  writer.close();
+
+  CLOG(INFO, "event") << "Flight recorder dumped " << recorded_num_ << " cycles to "
+                      << filepath.toStdString();
+  emit printToQConsole(QString("Flight recorder (%1) dumped %2 cycles to %3")
+                         .arg(kReasonsStr_[reason_])
+                         .arg(recorded_num_)
+                         .arg(filepath));
+  emit dumpReady(filepath);
+}
@@ -0,0 +1,46 @@
+/**
+ * @file linear_system.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of functions declared in linear_system.h.
+ */
+
+#include "utils/linear_system.h"
+
+#include <cmath>
+#include <utility>
+
+bool SolveLinearSystem(vectD& M, vectD& v, const size_t k)
+{
+  static constexpr double kPivotTol = 1e-12;
+
+  for (size_t c = 0; c < k; c++)
+  {
+    size_t pivot = c;
+    for (size_t r = c + 1; r < k; r++)
+      if (std::abs(M[r * k + c]) > std::abs(M[pivot * k + c]))
+        pivot = r;
+    if (std::abs(M[pivot * k + c]) < kPivotTol)
+      return false;
+    if (pivot != c)
+    {
+      for (size_t j = 0; j < k; j++)
+        std::swap(M[c * k + j], M[pivot * k + j]);
+      std::swap(v[c], v[pivot]);
+    }
+    for (size_t r = c + 1; r < k; r++)
+    {
+      const double factor = M[r * k + c] / M[c * k + c];
+      for (size_t j = c; j < k; j++)
+        M[r * k + j] -= factor * M[c * k + j];
+      v[r] -= factor * v[c];
+    }
+  }
+  for (size_t c = k; c-- > 0;)
+  {
+    for (size_t j = c + 1; j < k; j++)
+      v[c] -= M[c * k + j] * v[j];
+    v[c] /= M[c * k + c];
+  }
+  return true;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file tracer.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of classes declared in tracer.h.
+ */
+
+#include "utils/tracer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Spans kept per thread, i.e. about 15 seconds of real-time cycles at 1kHz.
+static constexpr size_t kBufferCapacity = 1 << 16;
+static constexpr size_t kBufferMask     = kBufferCapacity - 1;
+// Track IDs start far from any thread ID.
+static constexpr uint32_t kFirstTrackId = 1u << 30;
+
+struct ThreadBuffer
+{
+  explicit ThreadBuffer(const uint32_t _tid)
+    : tid(_tid), name(nullptr), session(0), events(kBufferCapacity), count(0)
+  {}
+
+  uint32_t tid;
+  std::atomic<const char*> name;
+  std::atomic<uint32_t> session;
+  std::vector<TraceEvent> events;
+  std::atomic<size_t> count; // written by owner thread only
+};
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  std::vector<std::string> tracks_names;
+};
+
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+thread_local ThreadBuffer* local_buffer = nullptr;
+
+ThreadBuffer* LocalBuffer()
+{
+  if (local_buffer == nullptr)
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.buffers.push_back(std::unique_ptr<ThreadBuffer>(
+      new ThreadBuffer(static_cast<uint32_t>(syscall(SYS_gettid)))));
+    local_buffer = registry.buffers.back().get();
+  }
+  return local_buffer;
+}
+
+QString JsonEscaped(const char* str)
+{
+  QString escaped(str);
+  escaped.replace('\\', "\\\\").replace('"', "\\\"");
+  return escaped;
+}
+
+} // end namespace
+
+//------------------------------------------------------------------------------------//
+//--------- Tracer class -------------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+std::atomic<bool> Tracer::active_(false);
+std::atomic<uint32_t> Tracer::session_(0);
+std::atomic<uint64_t> Tracer::session_start_nsec_(0);
+
+//--------- Public functions ---------------------------------------------------------//
+
+void Tracer::Start()
+{
+  session_start_nsec_ = NowNsec();
+  session_++; // buffers are cleared by their owners at their next span
+  active_ = true;
+}
+
+void Tracer::Stop() { active_ = false; }
+
+uint64_t Tracer::NowNsec()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL +
+         static_cast<uint64_t>(now.tv_nsec);
+}
+
+void Tracer::SetThreadName(const char* name)
+{
+  LocalBuffer()->name.store(name, std::memory_order_relaxed);
+}
+
+uint32_t Tracer::RegisterTrack(const std::string& name)
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.tracks_names.push_back(name);
+  return kFirstTrackId + static_cast<uint32_t>(registry.tracks_names.size() - 1);
+}
+
+void Tracer::Record(const char* category, const char* name, const uint64_t start_nsec,
+                    const uint64_t end_nsec, const uint32_t track_id /*= 0*/)
+{
+  ThreadBuffer* buffer   = LocalBuffer();
+  const uint32_t session = session_.load(std::memory_order_relaxed);
+  if (buffer->session.load(std::memory_order_relaxed) != session)
+  {
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->session.store(session, std::memory_order_relaxed);
+  }
+  const size_t count = buffer->count.load(std::memory_order_relaxed);
+  TraceEvent& event  = buffer->events[count & kBufferMask];
+  event.category     = category;
+  event.name         = name;
+  event.start_nsec   = start_nsec;
+  event.dur_nsec     = end_nsec > start_nsec ? end_nsec - start_nsec : 0;
+  event.track_id     = track_id == 0 ? buffer->tid : track_id;
+  buffer->count.store(count + 1, std::memory_order_release);
+}
+
+bool Tracer::Export(const QString& filepath)
+{
+  QDir().mkpath(QFileInfo(filepath).absolutePath());
+  QFile file(filepath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    return false;
+  QTextStream stream(&file);
+
+  const uint32_t session    = session_.load(std::memory_order_relaxed);
+  const uint64_t start_nsec = session_start_nsec_.load(std::memory_order_relaxed);
+  const qint64 pid          = getpid();
+  bool first                = true;
+  // Timestamps are in microseconds from session start, as by Chrome trace format.
+  auto write_event = [&](const TraceEvent& event) {
+    if (event.start_nsec < start_nsec)
+      return;
+    const double ts_usec = (event.start_nsec - start_nsec) * 1e-3;
+    stream << (first ? "\n" : ",\n") << "{\"name\":\"" << JsonEscaped(event.name)
+           << "\",\"cat\":\"" << JsonEscaped(event.category)
+           << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << event.track_id
+           << ",\"ts\":" << QString::number(ts_usec, 'f', 3)
+           << ",\"dur\":" << QString::number(event.dur_nsec * 1e-3, 'f', 3) << "}";
+    first = false;
+  };
+  auto write_name = [&](const uint32_t tid, const QString& name) {
+    stream << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+           << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":\"" << name << "\"}}";
+    first = false;
+  };
+
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+  {
+    const char* name = buffer->name.load(std::memory_order_relaxed);
+    write_name(buffer->tid, name != nullptr ? JsonEscaped(name)
+                                            : QString("thread %1").arg(buffer->tid));
+    if (buffer->session.load(std::memory_order_relaxed) != session)
+      continue; // nothing recorded in current session
+    const size_t count     = buffer->count.load(std::memory_order_acquire);
+    const size_t first_idx = count > kBufferCapacity ? count - kBufferCapacity : 0;
+    for (size_t i = first_idx; i < count; i++)
+      write_event(buffer->events[i & kBufferMask]);
+  }
+  for (size_t i = 0; i < registry.tracks_names.size(); i++)
+    write_name(kFirstTrackId + static_cast<uint32_t>(i),
+               JsonEscaped(registry.tracks_names[i].c_str()));
+  stream << "\n]}\n";
+  stream.flush();
+  return file.error() == QFile::NoError;
+}
+
+//------------------------------------------------------------------------------------//
+//--------- TraceTrack class ---------------------------------------------------------//
+//------------------------------------------------------------------------------------//
+
+void TraceTrack::Enter(const char* state) const
+{
+  const uint64_t now_nsec = Tracer::NowNsec();
+  if (state_ != nullptr && Tracer::IsActive())
+    Tracer::Record("state", state_, state_enter_nsec_, now_nsec, id_);
+  state_            = state;
+  state_enter_nsec_ = now_nsec;
+}
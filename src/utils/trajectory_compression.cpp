@@ -0,0 +1,131 @@
+/**
+ * @file trajectory_compression.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of functions declared in
+ * trajectory_compression.h.
+ */
+
+#include "utils/trajectory_compression.h"
+
+#include <cmath>
+
+namespace {
+
+vectD EstimateVelocities(const vectD& times, const vectD& values)
+{
+  const size_t size = values.size();
+  vectD velocities(size, 0.0);
+  for (size_t i = 1; i + 1 < size; i++)
+  {
+    // Second order finite differences on non-uniform timestamps
+    const double h0 = times[i] - times[i - 1];
+    const double h1 = times[i + 1] - times[i];
+    velocities[i]   = (-h1 / (h0 * (h0 + h1))) * values[i - 1] +
+                    ((h1 - h0) / (h0 * h1)) * values[i] +
+                    (h0 / (h1 * (h0 + h1))) * values[i + 1];
+  }
+  velocities.front() = (values[1] - values[0]) / (times[1] - times[0]);
+  velocities.back() =
+    (values[size - 1] - values[size - 2]) / (times[size - 1] - times[size - 2]);
+  return velocities;
+}
+
+// Largest error of Hermite interpolation between samples first and last, or a negative
+// value as soon as tolerance is exceeded.
+double SegmentError(const vectD& times, const vectD& values, const vectD& velocities,
+                    const size_t first, const size_t last, const double tolerance,
+                    const bool integral)
+{
+  const double h  = times[last] - times[first];
+  const double y0 = values[first], y1 = values[last];
+  const double m0 = velocities[first] * h, m1 = velocities[last] * h;
+  double max_error = 0.0;
+  for (size_t k = first + 1; k < last; k++)
+  {
+    const double s  = (times[k] - times[first]) / h;
+    const double s2 = s * s;
+    const double s3 = s2 * s;
+    double value    = (2. * s3 - 3. * s2 + 1.) * y0 + (s3 - 2. * s2 + s) * m0 +
+                   (-2. * s3 + 3. * s2) * y1 + (s3 - s2) * m1;
+    if (integral)
+      value = std::trunc(value);
+    const double error = std::abs(value - values[k]);
+    if (error > tolerance)
+      return -1.0;
+    if (error > max_error)
+      max_error = error;
+  }
+  return max_error;
+}
+
+} // end namespace
+
+double SelectHermiteKnots(const vectD& times, const vectD& values, const double tolerance,
+                          const bool integral, vect<size_t>& knots, vectD& velocities)
+{
+  const size_t size      = values.size();
+  const vectD dense_vels = EstimateVelocities(times, values);
+  double max_error       = 0.0;
+  knots.clear();
+  velocities.clear();
+  knots.push_back(0);
+
+  size_t first = 0;
+  while (first + 1 < size)
+  {
+    // Bracket farthest feasible end by doubling segment length...
+    size_t good       = first + 1; // adjacent samples are always exact
+    double good_error = 0.0;
+    size_t bad        = size;
+    size_t step       = 2;
+    while (first + step < size)
+    {
+      const double error = SegmentError(times, values, dense_vels, first, first + step,
+                                        tolerance, integral);
+      if (error < 0.0)
+      {
+        bad = first + step;
+        break;
+      }
+      good       = first + step;
+      good_error = error;
+      step *= 2;
+    }
+    if (bad == size && good != size - 1)
+    {
+      const double error =
+        SegmentError(times, values, dense_vels, first, size - 1, tolerance, integral);
+      if (error < 0.0)
+        bad = size - 1;
+      else
+      {
+        good       = size - 1;
+        good_error = error;
+      }
+    }
+    // ... and refine it by bisection
+    while (bad != size && bad - good > 1)
+    {
+      const size_t mid = good + (bad - good) / 2;
+      const double error =
+        SegmentError(times, values, dense_vels, first, mid, tolerance, integral);
+      if (error < 0.0)
+        bad = mid;
+      else
+      {
+        good       = mid;
+        good_error = error;
+      }
+    }
+    knots.push_back(good);
+    if (good_error > max_error)
+      max_error = good_error;
+    first = good;
+  }
+
+  velocities.reserve(knots.size());
+  for (const size_t knot : knots)
+    velocities.push_back(dense_vels[knot]);
+  return max_error;
+}
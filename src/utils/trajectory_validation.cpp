@@ -0,0 +1,297 @@
+/**
+ * @file trajectory_validation.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief This file includes definitions of functions declared in
+ * trajectory_validation.h.
+ */
+
+#include "utils/trajectory_validation.h"
+
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+constexpr TrajectoryFault kFaults[] = {NOT_FINITE, TIME_STALLED, BELOW_MIN,
+                                       ABOVE_MAX,  OVER_SPEED,   OVER_ACC};
+constexpr size_t kFaultsNum = sizeof(kFaults) / sizeof(kFaults[0]);
+
+// Vectorization and non-trapping math are enabled only for the fast pass loops and the
+// helpers they inline, which must share the same options to be inlined, to leave
+// floating-point semantics of the rest of the project untouched.
+#define VECTORIZED __attribute__((optimize("tree-vectorize", "no-trapping-math")))
+
+VECTORIZED inline bool IsFinite(const double x) { return fabs(x) <= DBL_MAX; }
+
+// Largest error of finite difference acceleration due to values rounding.
+VECTORIZED inline double AccMargin(const double resolution, const double h0,
+                                   const double h1)
+{
+  return resolution * (1. / h0 + 1. / h1) / (0.5 * (h0 + h1));
+}
+
+// Largest absolute speed along a cubic Hermite segment, at its ends or at the vertex of
+// its quadratic speed profile.
+VECTORIZED inline double HermitePeakSpeed(const double h, const double dy,
+                                          const double v0, const double v1)
+{
+  const double slope = dy / h;
+  const double a     = 3. * (v0 + v1) - 6. * slope;
+  const double b     = 6. * slope - 4. * v0 - 2. * v1;
+  const double s_vtx = a != 0.0 ? -b / (2. * a) : 0.0;
+  const double s     = s_vtx < 0.0 ? 0.0 : (s_vtx > 1.0 ? 1.0 : s_vtx);
+  const double v_vtx = fabs((a * s + b) * s + v0);
+  const double v_end = fabs(v0) > fabs(v1) ? fabs(v0) : fabs(v1);
+  return v_vtx > v_end ? v_vtx : v_end;
+}
+
+// Largest absolute acceleration along a cubic Hermite segment, which is linear in time
+// and therefore peaks at one of its ends.
+VECTORIZED inline double HermitePeakAcc(const double h, const double dy,
+                                        const double v0, const double v1)
+{
+  const double slope     = dy / h;
+  const double acc_start = (6. * slope - 4. * v0 - 2. * v1) / h;
+  const double acc_end   = (-6. * slope + 2. * v0 + 4. * v1) / h;
+  return fabs(acc_start) > fabs(acc_end) ? fabs(acc_start) : fabs(acc_end);
+}
+
+struct FaultCounters
+{
+  size_t not_finite = 0;
+  size_t stalled    = 0;
+  size_t below      = 0;
+  size_t above      = 0;
+  size_t over_speed = 0;
+  size_t over_acc   = 0;
+};
+
+// Checks of a single sample, shared by fast pass boundaries and diagnostics.
+struct SampleCheck
+{
+  bool not_finite = false;
+  bool stalled    = false;
+  bool below      = false;
+  bool above      = false;
+  bool over_speed = false;
+  bool over_acc   = false;
+  double speed    = 0.0;
+  double acc      = 0.0;
+};
+
+SampleCheck CheckSample(const double* times, const double* values,
+                        const double* velocities, const size_t size, const size_t i,
+                        const TrajectoryLimits& limits)
+{
+  SampleCheck check;
+  double speed_margin = 0.0;
+  double acc_margin   = 0.0;
+  check.not_finite = !IsFinite(times[i]) || !IsFinite(values[i]) ||
+                     (velocities != nullptr && !IsFinite(velocities[i]));
+  check.below = values[i] < limits.min_value;
+  check.above = values[i] > limits.max_value;
+  if (velocities != nullptr)
+  {
+    check.speed = std::abs(velocities[i]);
+    if (i + 1 < size)
+    {
+      const double h  = times[i + 1] - times[i];
+      const double dy = values[i + 1] - values[i];
+      check.stalled   = !(h > 0.0);
+      check.speed = std::max(check.speed, HermitePeakSpeed(h, dy, velocities[i],
+                                                           velocities[i + 1]));
+      check.acc = HermitePeakAcc(h, dy, velocities[i], velocities[i + 1]);
+    }
+  }
+  else if (i + 1 < size)
+  {
+    // Speed along next segment, acceleration at this sample
+    const double h1 = times[i + 1] - times[i];
+    check.stalled   = !(h1 > 0.0);
+    check.speed     = std::abs((values[i + 1] - values[i]) / h1);
+    speed_margin    = limits.resolution / h1;
+    if (i > 0)
+    {
+      const double h0 = times[i] - times[i - 1];
+      const double s0 = (values[i] - values[i - 1]) / h0;
+      const double s1 = (values[i + 1] - values[i]) / h1;
+      check.acc       = std::abs((s1 - s0) / (0.5 * (h0 + h1)));
+      acc_margin      = AccMargin(limits.resolution, h0, h1);
+    }
+  }
+  // Comparisons are false with NaN, which are reported as not finite or stalled anyway
+  check.over_speed = check.speed > limits.max_speed + speed_margin;
+  check.over_acc   = check.acc > limits.max_acc + acc_margin;
+  return check;
+}
+
+void Accumulate(const SampleCheck& check, FaultCounters& counters)
+{
+  counters.not_finite += check.not_finite;
+  counters.stalled += check.stalled;
+  counters.below += check.below;
+  counters.above += check.above;
+  counters.over_speed += check.over_speed;
+  counters.over_acc += check.over_acc;
+}
+
+// Branchless bodies let the compiler vectorize these loops over inner samples, i.e. all
+// but the first and last ones. Faults are counted as doubles, which are exact up to 2^53,
+// since baseline SSE2 has no vector conversion from comparison masks to 64-bit integers.
+VECTORIZED
+void CountDenseFaults(const double* __restrict__ t, const double* __restrict__ y,
+                      const size_t size, const TrajectoryLimits& limits,
+                      FaultCounters& counters)
+{
+  const double min_value = limits.min_value, max_value = limits.max_value;
+  const double max_speed = limits.max_speed, max_acc = limits.max_acc;
+  const double resolution = limits.resolution;
+  double not_finite = 0., stalled = 0., below = 0., above = 0., over_speed = 0.,
+         over_acc = 0.;
+  for (size_t i = 1; i + 1 < size; i++)
+  {
+    const double h0  = t[i] - t[i - 1];
+    const double h1  = t[i + 1] - t[i];
+    const double s0  = (y[i] - y[i - 1]) / h0;
+    const double s1  = (y[i + 1] - y[i]) / h1;
+    const double acc = (s1 - s0) / (0.5 * (h0 + h1));
+    not_finite += (!(fabs(t[i]) <= DBL_MAX) | !(fabs(y[i]) <= DBL_MAX)) ? 1. : 0.;
+    stalled += !(h1 > 0.0) ? 1. : 0.;
+    below += y[i] < min_value ? 1. : 0.;
+    above += y[i] > max_value ? 1. : 0.;
+    over_speed += fabs(s1) > max_speed + resolution / h1 ? 1. : 0.;
+    over_acc += fabs(acc) > max_acc + AccMargin(resolution, h0, h1) ? 1. : 0.;
+  }
+  counters.not_finite += static_cast<size_t>(not_finite);
+  counters.stalled += static_cast<size_t>(stalled);
+  counters.below += static_cast<size_t>(below);
+  counters.above += static_cast<size_t>(above);
+  counters.over_speed += static_cast<size_t>(over_speed);
+  counters.over_acc += static_cast<size_t>(over_acc);
+}
+
+VECTORIZED
+void CountHermiteFaults(const double* __restrict__ t, const double* __restrict__ y,
+                        const double* __restrict__ v, const size_t size,
+                        const TrajectoryLimits& limits, FaultCounters& counters)
+{
+  const double min_value = limits.min_value, max_value = limits.max_value;
+  const double max_speed = limits.max_speed, max_acc = limits.max_acc;
+  double not_finite = 0., stalled = 0., below = 0., above = 0., over_speed = 0.,
+         over_acc = 0.;
+  for (size_t i = 1; i + 1 < size; i++)
+  {
+    const double h  = t[i + 1] - t[i];
+    const double dy = y[i + 1] - y[i];
+    not_finite += (!(fabs(t[i]) <= DBL_MAX) | !(fabs(y[i]) <= DBL_MAX) |
+                   !(fabs(v[i]) <= DBL_MAX))
+                    ? 1.
+                    : 0.;
+    stalled += !(h > 0.0) ? 1. : 0.;
+    below += y[i] < min_value ? 1. : 0.;
+    above += y[i] > max_value ? 1. : 0.;
+    over_speed += HermitePeakSpeed(h, dy, v[i], v[i + 1]) > max_speed ? 1. : 0.;
+    over_acc += HermitePeakAcc(h, dy, v[i], v[i + 1]) > max_acc ? 1. : 0.;
+  }
+  counters.not_finite += static_cast<size_t>(not_finite);
+  counters.stalled += static_cast<size_t>(stalled);
+  counters.below += static_cast<size_t>(below);
+  counters.above += static_cast<size_t>(above);
+  counters.over_speed += static_cast<size_t>(over_speed);
+  counters.over_acc += static_cast<size_t>(over_acc);
+}
+
+void CollectIssues(const double* times, const double* values, const double* velocities,
+                   const size_t size, const TrajectoryLimits& limits,
+                   const size_t max_issues, vect<TrajectoryIssue>& issues)
+{
+  for (size_t i = 0; i < size && issues.size() < max_issues; i++)
+  {
+    const SampleCheck check = CheckSample(times, values, velocities, size, i, limits);
+    const bool flags[kFaultsNum] = {check.not_finite, check.stalled,    check.below,
+                                    check.above,      check.over_speed, check.over_acc};
+    const double quantities[kFaultsNum] = {
+      values[i], i + 1 < size ? times[i + 1] - times[i] : 0.0,
+      values[i], values[i],
+      check.speed, check.acc};
+    for (size_t k = 0; k < kFaultsNum && issues.size() < max_issues; k++)
+      if (flags[k])
+        issues.push_back({i, kFaults[k], times[i], quantities[k]});
+  }
+}
+
+} // end namespace
+
+//--------- Public functions ---------------------------------------------------------//
+
+std::string ValidationReport::Summary() const
+{
+  if (IsValid())
+    return std::string();
+  std::ostringstream summary;
+  summary << "trajectory #" << static_cast<int>(id) << " has " << faults_num
+          << " faults out of " << samples_num << " samples";
+  for (const TrajectoryIssue& issue : issues)
+    summary << "\n  sample " << issue.sample << " (t = " << issue.time
+            << " s): " << TrajectoryFaultName(issue.type) << " (" << issue.value << ")";
+  if (faults_num > issues.size())
+    summary << "\n  ...";
+  return summary.str();
+}
+
+const char* TrajectoryFaultName(const TrajectoryFault fault)
+{
+  switch (fault)
+  {
+    case NOT_FINITE:
+      return "not finite";
+    case TIME_STALLED:
+      return "time not increasing";
+    case BELOW_MIN:
+      return "below minimum";
+    case ABOVE_MAX:
+      return "above maximum";
+    case OVER_SPEED:
+      return "over speed";
+    case OVER_ACC:
+      return "over acceleration";
+  }
+  return "unknown";
+}
+
+ValidationReport ValidateSamples(const double* times, const double* values,
+                                 const double* velocities, const size_t size,
+                                 const TrajectoryLimits& limits,
+                                 const size_t max_issues /*= 10*/)
+{
+  ValidationReport report;
+  report.samples_num = size;
+  if (size == 0)
+    return report;
+
+  // Fast pass, with first and last samples checked apart
+  FaultCounters counters;
+  if (velocities != nullptr)
+    CountHermiteFaults(times, values, velocities, size, limits, counters);
+  else
+    CountDenseFaults(times, values, size, limits, counters);
+  Accumulate(CheckSample(times, values, velocities, size, 0, limits), counters);
+  if (size > 1)
+    Accumulate(CheckSample(times, values, velocities, size, size - 1, limits),
+               counters);
+
+  const size_t counts[kFaultsNum] = {counters.not_finite, counters.stalled,
+                                     counters.below,      counters.above,
+                                     counters.over_speed, counters.over_acc};
+  for (size_t k = 0; k < kFaultsNum; k++)
+  {
+    report.faults_num += counts[k];
+    if (counts[k] > 0)
+      report.faults |= kFaults[k];
+  }
+  if (!report.IsValid())
+    CollectIssues(times, values, velocities, size, limits, max_issues, report.issues);
+  return report;
+}
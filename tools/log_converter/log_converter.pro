@@ -0,0 +1,19 @@
+SOURCES = \
+    $$PWD/main.cpp \
+    $$PWD/../../src/utils/binary_log.cpp
+
+HEADERS = \
+    $$PWD/../../inc/utils/binary_log.h
+
+INCLUDEPATH += \
+    $$PWD/../../inc
+
+QT += core
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+TARGET = log_converter
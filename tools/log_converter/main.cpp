@@ -0,0 +1,186 @@
+/**
+ * @file main.cpp
+ * @author Simone Comari
+ * @date 19 Oct 2020
+ * @brief Standalone tool converting cable robot binary data logs into CSV files.
+ *
+ * By default, one CSV file per message type is generated, each with a header row and one
+ * column per field, so that every file can be loaded as a plain table by any analysis
+ * tool. Optionally, all records can be merged into a single file instead, in the same
+ * layout of the legacy text data log, i.e. message type, timestamp and fields.
+ *
+ * Frames, i.e. records with a group of repeated fields, are expanded into one row per
+ * item, each one repeating timestamp and common fields, so that for instance all
+ * actuators status of the same real-time cycle share the same timestamp and cycle
+ * counter.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include "utils/binary_log.h"
+
+namespace {
+
+struct CsvOutput
+{
+  QFile file;
+  QTextStream stream;
+  quint64 records_num = 0;
+};
+
+bool OpenCsv(CsvOutput& output, const QString& filepath, const QStringList& columns)
+{
+  output.file.setFileName(filepath);
+  if (!output.file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+  {
+    std::cerr << "Could not open " << filepath.toStdString() << ": "
+              << output.file.errorString().toStdString() << std::endl;
+    return false;
+  }
+  output.stream.setDevice(&output.file);
+  output.stream << columns.join(',') << '\n';
+  return true;
+}
+
+QStringList FieldNames(const BinLogSchema& schema)
+{
+  QStringList names;
+  for (const BinLogField& field : schema.fields)
+    names << field.name;
+  for (const BinLogField& field : schema.group.fields)
+    names << field.name;
+  return names;
+}
+
+void WriteRow(QTextStream& stream, const BinLogRecord& record, const size_t item_index,
+              const size_t item_fields_num)
+{
+  stream << QString::number(record.timestamp, 'g', 17);
+  for (const BinLogValue& value : record.values)
+    stream << ',' << value.toString();
+  const BinLogValue* item_values =
+    record.items_values.data() + item_index * item_fields_num;
+  for (size_t i = 0; i < item_fields_num && item_index < record.items_num; i++)
+    stream << ',' << item_values[i].toString();
+  stream << '\n';
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("log_converter");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Convert cable robot binary data logs to CSV files.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("input", "Binary data log file, e.g. data.bin.");
+  parser.addPositionalArgument(
+    "output", "Output directory. Defaults to the directory of the input file.");
+  QCommandLineOption merged_option(
+    QStringList() << "m"
+                  << "merged",
+    "Write all records into a single CSV file, prepending message type to each row.");
+  parser.addOption(merged_option);
+  parser.process(app);
+
+  const QStringList args = parser.positionalArguments();
+  if (args.isEmpty() || args.size() > 2)
+    parser.showHelp(1);
+
+  BinaryLogReader reader;
+  if (!reader.open(args[0]))
+  {
+    std::cerr << "Could not read " << args[0].toStdString() << ": "
+              << reader.errorString().toStdString() << std::endl;
+    return 1;
+  }
+  std::cout << "Reading " << args[0].toStdString() << " (format version "
+            << reader.fileFormatVersion() << ")" << std::endl;
+
+  const QFileInfo input_info(args[0]);
+  const QDir output_dir(args.size() > 1 ? args[1] : input_info.absolutePath());
+  if (!output_dir.mkpath("."))
+  {
+    std::cerr << "Could not create " << output_dir.path().toStdString() << std::endl;
+    return 1;
+  }
+  const QString prefix = output_dir.filePath(input_info.completeBaseName());
+
+  // Open output files
+  const std::vector<BinLogSchema>& schemas = reader.schemas();
+  const bool merged                        = parser.isSet(merged_option);
+  std::vector<std::unique_ptr<CsvOutput>> outputs;
+  if (merged)
+  {
+    // Columns are those of the widest message, unused trailing ones are left empty.
+    QStringList columns;
+    size_t max_fields_num = 0;
+    for (const BinLogSchema& schema : schemas)
+      max_fields_num =
+        std::max(max_fields_num, schema.fields.size() + schema.group.fields.size());
+    columns << "msg_type"
+            << "timestamp";
+    for (size_t i = 0; i < max_fields_num; i++)
+      columns << QString("field%1").arg(i + 1);
+    outputs.push_back(std::unique_ptr<CsvOutput>(new CsvOutput));
+    if (!OpenCsv(*outputs.back(), prefix + ".csv", columns))
+      return 1;
+  }
+  else
+  {
+    for (const BinLogSchema& schema : schemas)
+    {
+      outputs.push_back(std::unique_ptr<CsvOutput>(new CsvOutput));
+      if (!OpenCsv(*outputs.back(), prefix + "_" + schema.name + ".csv",
+                   QStringList("timestamp") + FieldNames(schema)))
+        return 1;
+    }
+  }
+
+  // Convert records
+  BinLogRecord record;
+  quint64 records_num = 0;
+  while (reader.readNext(record))
+  {
+    const BinLogSchema& schema   = schemas[record.schema_index];
+    const size_t item_fields_num = schema.group.fields.size();
+    CsvOutput& output            = *outputs[merged ? 0 : record.schema_index];
+    // Expand frames into one row per item, keeping at least one row per record
+    const size_t rows_num = std::max<size_t>(record.items_num, 1);
+    for (size_t i = 0; i < rows_num; i++)
+    {
+      if (merged)
+        output.stream << schema.msg_type << ',';
+      WriteRow(output.stream, record, i, item_fields_num);
+    }
+    output.records_num++;
+    records_num++;
+  }
+  if (!reader.errorString().isEmpty())
+    std::cerr << "WARNING: " << reader.errorString().toStdString()
+              << ", conversion stopped early" << std::endl;
+
+  // Close output files, removing empty ones
+  for (size_t i = 0; i < outputs.size(); i++)
+  {
+    outputs[i]->stream.flush();
+    outputs[i]->file.close();
+    if (outputs[i]->records_num == 0 && !merged)
+      outputs[i]->file.remove();
+    else
+      std::cout << "Written " << outputs[i]->records_num << " records to "
+                << outputs[i]->file.fileName().toStdString() << std::endl;
+  }
+  std::cout << "Converted " << records_num << " records" << std::endl;
+  return reader.errorString().isEmpty() ? 0 : 1;
+}